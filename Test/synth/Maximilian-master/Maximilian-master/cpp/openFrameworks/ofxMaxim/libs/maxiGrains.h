@@ -11,6 +11,7 @@
 #endif
 
 #include <list>
+#include <stdint.h>
 
 typedef unsigned long ulong;
 
@@ -86,43 +87,51 @@ struct gaussianWinFunctor {
 };
 
 
+// One window table per window shape (F), shared by all grains whatever their length.
+// Grains step through it with a 32 bit fixed-point phase and interpolate linearly, so
+// starting a grain costs nothing. begin() allocates the table: the players call it from
+// their constructors, never from play(); grains are silent until it has been called.
+#define MAXI_GRAIN_WINDOW_BITS 10
+#define MAXI_GRAIN_WINDOW_SIZE (1 << MAXI_GRAIN_WINDOW_BITS)
+#define MAXI_GRAIN_WINDOW_FRAC_BITS (32 - MAXI_GRAIN_WINDOW_BITS)
+
 template<typename F>
 class maxiGrainWindowCache {
 public:
-    unsigned int cacheSize;
-    
-    maxiGrainWindowCache() {
-        cacheSize = maxiSettings::sampleRate / 2.0; //allocate mem for up to 500ms grains
-        cache = (double**)malloc(cacheSize * sizeof(double*));
-        for(int i=0; i < cacheSize; i++) {
-            cache[i] = NULL;
+    static bool begin() {
+        if (table != NULL) return true;
+        double* newTable = (double*)malloc((MAXI_GRAIN_WINDOW_SIZE + 1) * sizeof(double));
+        if (newTable == NULL) return false;
+        // the last entry is the window end point and the interpolation guard
+        for(int i=0; i <= MAXI_GRAIN_WINDOW_SIZE; i++) {
+            newTable[i] = F()(MAXI_GRAIN_WINDOW_SIZE + 1, i);
         }
+        table = newTable;
+        return true;
     }
-    
-    ~maxiGrainWindowCache() {
-        for(int i=0; i < cacheSize; i++) {
-            if(NULL != cache[i]) {
-                free(cache[i]);
-            }
-        }
-        free(cache);
+
+    static bool isReady() {
+        return table != NULL;
     }
-    
-    double* getWindow(const unsigned int length) {
-        if (NULL == cache[length]) {
-            cache[length] = (double*)malloc(length * sizeof(double));
-            for(int i=0; i < length; i++) {
-                cache[length][i] = F()(length, i);
-            }
-        }
-        return cache[length];
+
+    // phase increment per sample for a grain of length samples
+    static uint32_t phaseIncrement(unsigned long length) {
+        if (length < 2) return 0;
+        return (uint32_t)(4294967296.0 / length);
     }
-    
+
+    static inline double value(uint32_t phase) {
+        uint32_t idx = phase >> MAXI_GRAIN_WINDOW_FRAC_BITS;
+        double frac = (phase & ((1u << MAXI_GRAIN_WINDOW_FRAC_BITS) - 1)) * (1.0 / (1u << MAXI_GRAIN_WINDOW_FRAC_BITS));
+        return table[idx] + frac * (table[idx + 1] - table[idx]);
+    }
+
 private:
-    double** cache;
-    
+    static double* table;
 };
 
+template<typename F> double* maxiGrainWindowCache<F>::table = NULL;
+
 class maxiGrainBase {
 public:
   virtual double play() = 0;
@@ -144,7 +153,8 @@ public:
     double speed;
     double inc;
     double frequency;
-    double* window;
+    uint32_t windowPhase;
+    uint32_t windowInc;
     //    short* buffer;
 #if defined(__APPLE_CC__) && defined(MAXIGRAINFAST)
     //	double* grainSamples;
@@ -153,7 +163,7 @@ public:
      position between 0.0 and 1.0
      duration in seconds
      */
-    maxiGrain(maxiSample *_sample, const double position, const double duration, const double speed, maxiGrainWindowCache<F> *windowCache) :sample(_sample), pos(position), dur(duration), speed(speed)
+    maxiGrain(maxiSample *_sample, const double position, const double duration, const double speed) :sample(_sample), pos(position), dur(duration), speed(speed)
     {
         //        buffer = sample->temp;
         sampleStartPos = (sample->length) * pos;
@@ -173,7 +183,9 @@ public:
             inc = sampleDur/(maxiSettings::sampleRate/frequency);
         }else
             inc = 0;
-        window = windowCache->getWindow(sampleDur);
+        windowPhase = 0;
+        windowInc = maxiGrainWindowCache<F>::phaseIncrement(sampleDur);
+        if (!maxiGrainWindowCache<F>::isReady()) finished = true;
         
     }
     
@@ -189,7 +201,8 @@ public:
 #if defined(__APPLE_CC__) && defined(MAXIGRAINFAST)
             //			output = grainSamples[sampleIdx];
 #else
-            envValue = window[sampleIdx];
+            envValue = maxiGrainWindowCache<F>::value(windowPhase);
+            windowPhase += windowInc;
             double remainder;
             pos += inc;
             if (pos >= sample->length)
@@ -266,13 +279,13 @@ public:
     double position;
     maxiSample *sample;
     maxiGrainPlayer *grainPlayer;
-    maxiGrainWindowCache<F> windowCache;
     double randomOffset;
     long loopStart, loopEnd, loopLength;
     double looper;
     
     maxiTimePitchStretch(maxiSample *_sample) : sample(_sample) {
         grainPlayer = new maxiGrainPlayer();
+        maxiGrainWindowCache<F>::begin();
         randomOffset=0;
         loopStart = 0.0;
         sample->getLength();
@@ -340,7 +353,7 @@ protected:
             double pos = max(min(static_cast<double>(1.0), (position / sample->length) + posMod),static_cast<double>(0.0));
             maxiGrain<F, maxiSample> *g = new maxiGrain<F, maxiSample>(sample,
                                                                        pos,
-                                                                       grainLength, speed, &windowCache);
+                                                                       grainLength, speed);
             grainPlayer->addGrain(g);
             randomOffset = rand() % 10;
         }
@@ -513,7 +526,7 @@ protected:
 //	 position between 0.0 and 1.0
 //	 duration in seconds
 //	 */
-//	maxiGrain(maxiSample *sample, const double position, const double duration, const double speed, maxiGrainWindowCache<F> *windowCache) :sample(sample), pos(position), dur(duration), speed(speed)
+//	maxiGrain(maxiSample *sample, const double position, const double duration, const double speed) :sample(sample), pos(position), dur(duration), speed(speed)
 //	{
 //        buffer = sample->temp;
 //		sampleStartPos = sample->length * pos;
@@ -684,7 +697,7 @@ protected:
 //        if (looper > cycleLength + randomOffset) {
 //            looper -= (cycleLength + randomOffset);
 //			speed = (speed > 0 ? 1 : -1);
-//			maxiGrain<F> *g = new maxiGrain<F>(sample, max(min(1.0,(position / sample->length) + posMod),0.0), grainLength, speed, &windowCache);
+//			maxiGrain<F> *g = new maxiGrain<F>(sample, max(min(1.0,(position / sample->length) + posMod),0.0), grainLength, speed);
 //			grainPlayer->addGrain(g);
 //			randomOffset = rand() % 10;
 //		}
@@ -697,7 +710,7 @@ protected:
 //		looper++;
 //		pos *= sample->length;
 //		if (0 == floor(fmod(looper, grainLength * maxiSettings::sampleRate / overlaps))) {
-//			maxiGrain<F> *g = new maxiGrain<F>(sample, max(min(1.0,(pos / sample->length)),0.0), grainLength, 1, &windowCache);
+//			maxiGrain<F> *g = new maxiGrain<F>(sample, max(min(1.0,(pos / sample->length)),0.0), grainLength, 1);
 //			grainPlayer->addGrain(g);
 //		}
 //		return grainPlayer->play();
@@ -740,7 +753,7 @@ protected:
 //			//			cout << cycleMod << endl;
 //			//speed = (speed > 0 ? 1 : -1);
 //			speed = speed - ((cycleMod / cycleLength) * 0.1);
-//			maxiGrain<F> *g = new maxiGrain<F>(sample, max(min(1.0,(position / sample->length) + posMod),0.0), grainLength, speed, &windowCache);
+//			maxiGrain<F> *g = new maxiGrain<F>(sample, max(min(1.0,(position / sample->length) + posMod),0.0), grainLength, speed);
 //			grainPlayer->addGrain(g);
 //			//			cout << grainPlayer->grains.size() << endl;
 //			//			randomOffset = rand() % 10;
@@ -810,7 +823,7 @@ protected:
 //		double cycleLength = grainLength * maxiSettings::sampleRate  / overlaps;
 //        if (looper > cycleLength + randomOffset) {
 //            looper -= (cycleLength + randomOffset);
-//			maxiGrain<F> *g = new maxiGrain<F>(sample, max(min(1.0,(position / sample->length) + posMod),0.0), grainLength, speed, &windowCache);
+//			maxiGrain<F> *g = new maxiGrain<F>(sample, max(min(1.0,(position / sample->length) + posMod),0.0), grainLength, speed);
 //			grainPlayer->addGrain(g);
 //            randomOffset = rand() % 10;
 //		}
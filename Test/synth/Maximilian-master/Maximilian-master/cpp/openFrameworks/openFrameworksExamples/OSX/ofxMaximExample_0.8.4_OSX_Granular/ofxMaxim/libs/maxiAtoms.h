@@ -41,7 +41,8 @@ class maxiCollider {
 public:
 	static inline void createGabor(flArr &atom, const float freq, const float sampleRate, const unsigned int length, 
                                 float phase, const float kurtotis, const float amp);
-    static maxiGrainWindowCache<gaussianWinFunctor> envCache;
+    // allocates the shared gaussian window table: call before createGabor()
+    static bool setup() { return maxiGrainWindowCache<gaussianWinFunctor>::begin(); }
 };
 
 
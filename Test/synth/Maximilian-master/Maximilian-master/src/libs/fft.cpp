@@ -435,6 +435,23 @@ void fft::setup(int fftSize) {
     }
     polar.resize(n,0);
 #endif
+
+	// tables for realFFT(): complex transform of half points plus the real split
+	int bits = NumberOfBitsNeeded(half);
+	twiddleReal.resize(half);
+	twiddleImag.resize(half);
+	bitReverse.resize(half);
+	for (int i = 0; i < half; i++) {
+		twiddleReal[i] = cos(2.0 * M_PI * i / half);
+		twiddleImag[i] = sin(2.0 * M_PI * i / half);
+		bitReverse[i] = ReverseBits(i, bits);
+	}
+	splitReal.resize(half / 2 + 1);
+	splitImag.resize(half / 2 + 1);
+	for (int i = 0; i <= half / 2; i++) {
+		splitReal[i] = cos(M_PI * i / half);
+		splitImag[i] = sin(M_PI * i / half);
+	}
 }
 
 //fft::fft(fft const &other) {
@@ -494,11 +511,137 @@ float * fft::getImg() {
 }
 
 void fft::calcFFT(int start, float *data, float *window) {
-    //windowing
-    for (int i = 0; i < n; i++) {
-        in_real[i] = data[start + i] * window[i];
-    }
-    RealFFT(n, &in_real[0], &out_real[0], &out_img[0]);
+    realFFT(data + start, window);
+}
+
+/*
+ * In place complex transform of half points (input in bit reversed order), same sign
+ * convention as FFT(). Pairs of radix-2 stages are merged into one radix-4 pass, so the
+ * data is walked log4 times, and every twiddle comes from the table.
+ */
+void fft::complexFFT(float *re, float *im) {
+	const int N = half;
+	const float *wr = &twiddleReal[0];
+	const float *wi = &twiddleImag[0];
+	int L = 2;
+
+	// odd number of stages: one plain radix-2 pass (twiddle 1)
+	if (NumberOfBitsNeeded(N) & 1) {
+		for (int k = 0; k < N; k += 2) {
+			float tr = re[k + 1], ti = im[k + 1];
+			re[k + 1] = re[k] - tr;
+			im[k + 1] = im[k] - ti;
+			re[k] += tr;
+			im[k] += ti;
+		}
+		L = 4;
+	}
+
+	// stages L and 2L in one pass: x0..x3 at j, j+L/2, j+L, j+3L/2 of each 2L block
+	for (; L <= N / 2; L <<= 2) {
+		const int q = L / 2;
+		const int stride = N / (2 * L);	// table step for t = exp(2*pi*i*j/(2L))
+		for (int b = 0; b < N; b += 2 * L) {
+			for (int j = 0; j < q; j++) {
+				int i0 = b + j, i1 = i0 + q, i2 = i1 + q, i3 = i2 + q;
+				int k1 = j * stride;
+				float t1r = wr[k1], t1i = wi[k1];
+				float t2r = wr[2 * k1], t2i = wi[2 * k1];
+				float t3r = wr[3 * k1], t3i = wi[3 * k1];
+
+				float pr = t2r * re[i1] - t2i * im[i1];
+				float pi = t2r * im[i1] + t2i * re[i1];
+				float qr = t1r * re[i2] - t1i * im[i2];
+				float qi = t1r * im[i2] + t1i * re[i2];
+				float rr = t3r * re[i3] - t3i * im[i3];
+				float ri = t3r * im[i3] + t3i * re[i3];
+
+				float y0r = re[i0] + pr, y0i = im[i0] + pi;
+				float y1r = re[i0] - pr, y1i = im[i0] - pi;
+				float sr = qr + rr, si = qi + ri;
+				float dr = qr - rr, di = qi - ri;
+
+				re[i0] = y0r + sr;
+				im[i0] = y0i + si;
+				re[i2] = y0r - sr;
+				im[i2] = y0i - si;
+				// + i * d
+				re[i1] = y1r - di;
+				im[i1] = y1i + dr;
+				re[i3] = y1r + di;
+				im[i3] = y1i - dr;
+			}
+		}
+	}
+}
+
+/* windowed real FFT of n points via a half size complex FFT (see RealFFT) */
+void fft::realFFT(const float *data, const float *window) {
+	float *re = &out_real[0];
+	float *im = &out_img[0];
+	const int *rev = &bitReverse[0];
+
+	// window, pack even/odd samples as complex and bit reverse in one pass
+	for (int i = 0; i < half; i++) {
+		int j = rev[i];
+		re[j] = data[2 * i] * window[2 * i];
+		im[j] = data[2 * i + 1] * window[2 * i + 1];
+	}
+
+	complexFFT(re, im);
+
+	float h1r, h1i, h2r, h2i;
+	for (int i = 1; i < half / 2; i++) {
+		int i3 = half - i;
+		float wr = splitReal[i];
+		float wi = splitImag[i];
+		h1r = 0.5f * (re[i] + re[i3]);
+		h1i = 0.5f * (im[i] - im[i3]);
+		h2r = 0.5f * (im[i] + im[i3]);
+		h2i = -0.5f * (re[i] - re[i3]);
+		re[i] = h1r + wr * h2r - wi * h2i;
+		im[i] = h1i + wr * h2i + wi * h2r;
+		re[i3] = h1r - wr * h2r + wi * h2i;
+		im[i3] = -h1i + wr * h2i + wi * h2r;
+	}
+	h1r = re[0];
+	re[0] = h1r + im[0];
+	im[0] = h1r - im[0];
+}
+
+void fft::realIFFT(const float *real, const float *imag, float *out) {
+	float *re = &in_real[0];
+	float *im = &in_img[0];
+	const int *rev = &bitReverse[0];
+	const float scale = 1.0f / half;
+
+	// undo the real split: Z(k) = F + iG with F = (X(k) + X*(half-k)) / 2, G = (X(k) - X*(half-k)) / (2 W^k)
+	// Z is conjugated on the way in and out, so the forward kernel does the inverse transform
+	for (int k = 0; k <= half / 2; k++) {
+		int k2 = half - k;
+		float ar = k == 0 ? real[0] : real[k];
+		float ai = k == 0 ? 0.0f : imag[k];
+		float br = k == 0 ? imag[0] : real[k2];	// Nyquist for k == 0
+		float bi = k == 0 ? 0.0f : -imag[k2];
+		float fr = 0.5f * (ar + br), fi = 0.5f * (ai + bi);
+		float dr = 0.5f * (ar - br), di = 0.5f * (ai - bi);
+		float wr = splitReal[k], wi = splitImag[k];
+		float gr = dr * wr + di * wi;
+		float gi = di * wr - dr * wi;
+		re[rev[k]] = fr - gi;
+		im[rev[k]] = -(fi + gr);
+		if (k != 0 && k != k2) {
+			re[rev[k2]] = fr + gi;
+			im[rev[k2]] = -(-fi + gr);
+		}
+	}
+
+	complexFFT(re, im);
+
+	for (int m = 0; m < half; m++) {
+		out[2 * m] = re[m] * scale;
+		out[2 * m + 1] = -im[m] * scale;
+	}
 }
 
 void fft::cartToPol(float *magnitude,float *phase) {
@@ -517,7 +660,18 @@ void fft::powerSpectrum(int start, float *data, float *window, float *magnitude,
 	
     calcFFT(start, data, window);
     cartToPol(magnitude, phase);
-	
+
+}
+
+void fft::cartToMag(float *magnitude) {
+    for (int i = 0; i < half; i++) {
+        magnitude[i] = sqrtf(out_real[i]*out_real[i] + out_img[i]*out_img[i]);
+    }
+}
+
+void fft::magnitudeSpectrum(int start, float *data, float *window, float *magnitude) {
+    calcFFT(start, data, window);
+    cartToMag(magnitude);
 }
 
 void fft::convToDB(float *in, float *out) {
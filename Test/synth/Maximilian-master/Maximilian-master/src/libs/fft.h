@@ -87,9 +87,22 @@ public:
 	void convToDB_vdsp(float *in, float *out);
 #endif
 	
+	/* Portable real FFT: all tables are built by setup(), nothing is allocated per transform.
+	   Same output as RealFFT(): out_real/out_img[0..half-1], Nyquist packed into out_img[0] */
+	std::vector<float> twiddleReal, twiddleImag;	// exp(2*pi*i*k/half), k < half
+	std::vector<float> splitReal, splitImag;		// exp(pi*i*k/half), k < half/2
+	std::vector<int> bitReverse;					// index permutation of the half size transform
+	void realFFT(const float *data, const float *window);
+	/* inverse of realFFT() for a spectrum in the same packed layout: writes n samples */
+	void realIFFT(const float *real, const float *imag, float *out);
+	void complexFFT(float *re, float *im);
+
 	/* Calculate the power spectrum */
     void calcFFT(int start, float *data, float *window);
     void cartToPol(float *magnitude,float *phase);
+	/* magnitudes only: skips atan2 */
+    void cartToMag(float *magnitude);
+	void magnitudeSpectrum(int start, float *data, float *window, float *magnitude);
 	void powerSpectrum(int start, float *data, float *window, float *magnitude, float *phase);
 	/* ... the inverse */
     void polToCart(float *magnitude,float *phase);
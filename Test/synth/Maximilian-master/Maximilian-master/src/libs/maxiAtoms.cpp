@@ -22,8 +22,6 @@ float sineBuffer2[514]={0,0.012268,0.024536,0.036804,0.049042,0.06131,0.073547,0
 };
 
 
-maxiGrainWindowCache<gaussianWinFunctor> maxiCollider::envCache = maxiGrainWindowCache<gaussianWinFunctor>();
-
 inline void maxiCollider::createGabor(flArr &atom, const float freq, const float sampleRate, const unsigned length, 
 						 float startPhase, const float kurtotis, const float amp) {
 	atom.resize(length);
@@ -33,14 +31,18 @@ inline void maxiCollider::createGabor(flArr &atom, const float freq, const float
 //	float gausDivisor = (-2.0f * kurtotis * kurtotis);
 //    float phase =-1.0;
     
-    maxi_float_t *env = maxiCollider::envCache.getWindow(length);
-#ifdef __APPLE_CC__	    
-    vDSP_vdpsp(env, 1, &atom[0], 1, length);
-#else    
+    //gaussian envelope from the shared window table (silent without setup())
+    typedef maxiGrainWindowCache<gaussianWinFunctor> envCache;
+    if (!envCache::isReady()) {
+        atom.assign(length, 0.0f);
+        return;
+    }
+    uint32_t envPhase = 0;
+    uint32_t envInc = envCache::phaseIncrement(length);
 	for(unsigned i=0; i < length; i++) {
-        atom[i] = env[i];
+        atom[i] = envCache::value(envPhase);
+        envPhase += envInc;
     }
-#endif
     
 //#ifdef __APPLE_CC__	    
 //    vDSP_vramp(&phase, &inc, &atom[0], 1, length);
@@ -193,6 +195,7 @@ maxiAtomBook::~maxiAtomBook() {
 
 maxiAtomBookPlayer::maxiAtomBookPlayer() {
 	atomIdx = 0;
+	maxiCollider::setup();
 }
 
 void maxiAtomBookPlayer::play(maxiAtomBook &book, maxiAccelerator &atomStream, float *output, int bufferSize) {
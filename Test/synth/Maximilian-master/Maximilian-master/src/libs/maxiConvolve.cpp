@@ -7,101 +7,140 @@
 //
 
 #include "maxiConvolve.h"
+#include <algorithm>
+#include <iostream>
+#include <math.h>
 
 using namespace std;
 
 void maxiConvolve::setup(std::string impulseFile, int fftsize, int hopsize) {
-    auto  analyseImpulse = [fftsize, hopsize](maxiSample &impulse, floatVV &impulseReal, floatVV &impulseImag) {
+    maxiSample impulseSample;
+    impulseSample.load(impulseFile);
+    int length = impulseSample.getLength();
+    vector<float> impulse(length);
+    // one gain for the whole response, so its shape is not changed
+    float energy = 0;
+    for (int i = 0; i < length; i++) {
+        impulse[i] = impulseSample.amplitudes[i];
+        energy += impulse[i] * impulse[i];
+    }
+    float gain = energy > 0 ? 1.0f / sqrtf(energy) : 1.0f;
+    for (int i = 0; i < length; i++) {
+        impulse[i] *= gain;
+    }
+    setup(impulse.data(), length, fftsize / 2);
+    cout << "Impulse loaded, " << partitions << " partitions\n";
+}
+
+bool maxiConvolve::setup(const float *impulse, int length, int _blockSize) {
+    if (_blockSize < 2 || (_blockSize & (_blockSize - 1)) || length < 1) return false;
 
-        float maxReal=0;
-        float maxImag=0;
+    int fade = 0;
+    if (length > MAXI_CONVOLVE_MAX_IR) {
+        length = MAXI_CONVOLVE_MAX_IR;
+        fade = min(64, length);
+    }
 
-        auto pushFFTFrame = [&impulseReal, &impulseImag](maxiFFT &fft, float &maxReal, float &maxImag) {
-            vector<float> realVector;
-            realVector.assign(fft.getReal(), fft.getReal() + fft.getNumBins());
-            impulseReal.push_back(realVector);
-            for(int i=0; i < realVector.size(); i++) {
-                if (realVector[i] > maxReal) maxReal = realVector[i];
-            }
-            vector<float> imagVector;
-            imagVector.assign(fft.getImag(), fft.getImag() + fft.getNumBins());
-            impulseImag.push_back(imagVector);
-            for(int i=0; i < imagVector.size(); i++) {
-                if (imagVector[i] > maxImag) maxImag = imagVector[i];
-            }
-        };
+    blockSize = _blockSize;
+    partitions = (length + blockSize - 1) / blockSize;
+    int fftSize = 2 * blockSize;
+    _fft.setup(fftSize);
+    ones.assign(fftSize, 1.0f);
 
-        maxiFFT fft;
-        fft.setup(fftsize,fftsize,hopsize);
-        for(int i=0; i < impulse.getLength(); i++) {
-            if (fft.process(impulse.play(), maxiFFT::NO_POLAR_CONVERSION)) {
-                pushFFTFrame(fft, maxReal, maxImag);
-            };
-        }
-        for(int i=0; i < fft.getNumBins() - (impulse.getLength() % fft.getNumBins()); i++) {
-            if (fft.process(0, maxiFFT::NO_POLAR_CONVERSION)) {
-                pushFFTFrame(fft, maxReal, maxImag);
-            };
-        }
+    irReal.assign(partitions * blockSize, 0);
+    irImag.assign(partitions * blockSize, 0);
+    fdlReal.assign(partitions * blockSize, 0);
+    fdlImag.assign(partitions * blockSize, 0);
+    sumReal.assign(blockSize, 0);
+    sumImag.assign(blockSize, 0);
+    input.assign(fftSize, 0);
+    output.assign(fftSize, 0);
 
-        for (int i=0; i < impulseReal.size(); i++) {
-            for(int j=0; j < impulseReal[i].size(); j++) {
-                impulseReal[i][j] /= maxReal;
-                impulseImag[i][j] /= maxImag;
-            }
+    // partition p: blockSize impulse samples followed by blockSize zeros
+    vector<float> frame(fftSize);
+    for (int p = 0; p < partitions; p++) {
+        std::fill(frame.begin(), frame.end(), 0);
+        for (int i = 0; i < blockSize; i++) {
+            int idx = p * blockSize + i;
+            if (idx >= length) break;
+            float value = impulse[idx];
+            if (idx >= length - fade) value *= (float)(length - idx) / fade;
+            frame[i] = value;
         }
-    };
-
+        _fft.realFFT(frame.data(), ones.data());
+        std::copy(_fft.out_real.begin(), _fft.out_real.begin() + blockSize, irReal.begin() + p * blockSize);
+        std::copy(_fft.out_img.begin(), _fft.out_img.begin() + blockSize, irImag.begin() + p * blockSize);
+    }
+    reset();
+    return true;
+}
 
-    maxiSample impulseSample;
-    impulseSample.load(impulseFile);
-    analyseImpulse(impulseSample, impulseReal, impulseImag);
-    cout << "Impulse loaded, " << impulseReal.size() << " frames\n";
+void maxiConvolve::reset() {
+    std::fill(fdlReal.begin(), fdlReal.end(), 0);
+    std::fill(fdlImag.begin(), fdlImag.end(), 0);
+    std::fill(input.begin(), input.end(), 0);
+    std::fill(output.begin(), output.end(), 0);
+    fdlPos = 0;
+    pos = 0;
+}
 
-    inFFT.setup(fftsize,fftsize,hopsize);
-    ifft.setup(fftsize,fftsize,hopsize);
+void maxiConvolve::processBlock() {
+    // spectrum of the last two blocks goes into the delay line
+    fdlPos = fdlPos == 0 ? partitions - 1 : fdlPos - 1;
+    _fft.realFFT(&input[0], &ones[0]);
+    std::copy(_fft.out_real.begin(), _fft.out_real.begin() + blockSize, fdlReal.begin() + fdlPos * blockSize);
+    std::copy(_fft.out_img.begin(), _fft.out_img.begin() + blockSize, fdlImag.begin() + fdlPos * blockSize);
 
-    for(int i=0; i < impulseReal.size(); i++) {
-        vector<float> blank;
-        blank.resize(inFFT.getNumBins(), 0);
-        FDLReal.push_front(blank);
-        FDLImag.push_front(blank);
+    // sum of partition p times the input spectrum p blocks ago
+    std::fill(sumReal.begin(), sumReal.end(), 0);
+    std::fill(sumImag.begin(), sumImag.end(), 0);
+    float *sr = &sumReal[0];
+    float *si = &sumImag[0];
+    int slot = fdlPos;
+    for (int p = 0; p < partitions; p++) {
+        const float *hr = &irReal[p * blockSize];
+        const float *hi = &irImag[p * blockSize];
+        const float *xr = &fdlReal[slot * blockSize];
+        const float *xi = &fdlImag[slot * blockSize];
+        // bin 0 holds DC and Nyquist, both real
+        sr[0] += hr[0] * xr[0];
+        si[0] += hi[0] * xi[0];
+        for (int i = 1; i < blockSize; i++) {
+            sr[i] += hr[i] * xr[i] - hi[i] * xi[i];
+            si[i] += hr[i] * xi[i] + hi[i] * xr[i];
+        }
+        if (++slot == partitions) slot = 0;
     }
-    sumReal.resize(inFFT.bins, 0);
-    sumImag.resize(inFFT.bins, 0);
-}
-
-float maxiConvolve::play(float w) {
-    if (inFFT.process(w, maxiFFT::NO_POLAR_CONVERSION)) {
-        vector<float> realFrame;
-        realFrame.assign(inFFT.getReal(), inFFT.getReal() + inFFT.bins);
-        FDLReal.push_front(realFrame);
-        FDLReal.pop_back();
 
-        vector<float> imagFrame;
-        imagFrame.assign(inFFT.getImag(), inFFT.getImag() + inFFT.getNumBins());
-        FDLImag.push_front(imagFrame);
-        FDLImag.pop_back();
+    // overlap-save: only the second half is free of circular wrap
+    _fft.realIFFT(sr, si, &output[0]);
 
-        std::fill(sumReal.begin(), sumReal.end(), 0);
-        std::fill(sumImag.begin(), sumImag.end(), 0);
+    // keep the current block as the first half of the next FFT frame
+    std::copy(input.begin() + blockSize, input.end(), input.begin());
+}
 
-        auto impRealIt = impulseReal.begin();
-        auto impImagIt = impulseImag.begin();
-        auto fdlRealIt = FDLReal.begin();
-        for(auto fdlImagIt = FDLImag.begin(); fdlImagIt != FDLImag.end(); ++fdlRealIt, ++fdlImagIt, ++impRealIt, ++impImagIt) {
-            sumReal[0] += ((*impRealIt)[0] * (*fdlRealIt)[0]);
-            sumImag[0] += ((*impImagIt)[0] * (*fdlImagIt)[0]);
-            for(int i=1; i < sumReal.size(); i++) {
-                sumReal[i] += ((*impRealIt)[i] * (*fdlRealIt)[i]) - ((*impImagIt)[i] * (*fdlImagIt)[i]);
-                sumImag[i] += ((*impRealIt)[i] * (*fdlImagIt)[i]) + ((*impImagIt)[i] * (*fdlRealIt)[i]);
-            }
+void maxiConvolve::process(const float *in, float *out, int n) {
+    if (partitions == 0) {
+        std::fill(out, out + n, 0);
+        return;
+    }
+    while (n > 0) {
+        int count = min(n, blockSize - pos);
+        std::copy(in, in + count, input.begin() + blockSize + pos);
+        std::copy(output.begin() + blockSize + pos, output.begin() + blockSize + pos + count, out);
+        pos += count;
+        in += count;
+        out += count;
+        n -= count;
+        if (pos == blockSize) {
+            processBlock();
+            pos = 0;
         }
-//        float scale = sqrt((float)FDLReal.size());
-//        for(int i=0; i < sumReal.size(); i++) {
-//            sumReal[i] /= scale;
-//            sumImag[i] /= scale;
-//        }
     }
-    return ifft.process(sumReal, sumImag, maxiIFFT::COMPLEX);
+}
+
+float maxiConvolve::play(float w) {
+    float result;
+    process(&w, &result, 1);
+    return result;
 }
@@ -4,31 +4,64 @@
 //
 //  Created by Chris Kiefer on 03/03/2017.
 //
-//  Partitioned Convolution
+//  Uniformly partitioned overlap-save convolution
+//
+//  The impulse response is cut into partitions of blockSize samples. Each
+//  partition and each input block is transformed once (FFT size 2 * blockSize);
+//  the input spectra are kept in a frequency-domain delay line and every block
+//  costs one FFT, one inverse FFT and one complex multiply-add per partition.
+//  All spectra live in contiguous arrays (partition-major, blockSize bins each,
+//  DC/Nyquist packed in bin 0 like fft::realFFT()). Latency is blockSize samples.
+//
 
 #ifndef maxiConvolve_h
 #define maxiConvolve_h
 
 #include "../maximilian.h"
-#include "maxiFFT.h"
-#include <iostream>
-#include <deque>
+#include "fft.h"
+#include <vector>
 
-typedef vector< vector<float> > floatVV;
+// Longest impulse response (in samples) accepted by setup(); longer ones are
+// truncated with a short fade out. The ESP32 tier keeps the per-block work and
+// memory small enough for cabinet-style responses.
+#ifndef MAXI_CONVOLVE_MAX_IR
+#if defined(ESP32)
+#define MAXI_CONVOLVE_MAX_IR 4096
+#else
+#define MAXI_CONVOLVE_MAX_IR (48000 * 2)
+#endif
+#endif
 
 class maxiConvolve {
 public:
+    // impulse file is loaded with maxiSample and normalised to unit energy;
+    // the partition size is fftsize / 2 (hopsize is not used any more)
     void setup(std::string impulseFile, int fftsize = 1024, int hopsize = 256);
+    // impulse samples are used as they are; blockSize must be a power of two
+    bool setup(const float *impulse, int length, int blockSize = 256);
+    void reset();
+
+    // block i/o: any n, output is delayed by getLatency() samples
+    void process(const float *in, float *out, int n);
     float play(float w);
+
+    int getLatency() {return blockSize;}
+    int getNumPartitions() {return partitions;}
+
 private:
-    maxiFFT inFFT;
-    maxiIFFT ifft;
-    std::deque< vector<float> > FDLReal; //frequency delay line
-    std::deque< vector<float> > FDLImag; //frequency delay line
-    floatVV impulseReal;
-    floatVV impulseImag;
-    vector<float> sumReal;
-    vector<float> sumImag;
+    void processBlock();
+
+    fft _fft;
+    int blockSize = 0;
+    int partitions = 0;
+    std::vector<float> irReal, irImag;      // partitions * blockSize
+    std::vector<float> fdlReal, fdlImag;    // frequency delay line, same layout
+    int fdlPos = 0;                         // slot of the newest input spectrum
+    std::vector<float> sumReal, sumImag;    // blockSize
+    std::vector<float> input;               // last 2 * blockSize input samples
+    std::vector<float> output;              // 2 * blockSize, valid output in the second half
+    std::vector<float> ones;                // rectangular window for realFFT()
+    int pos = 0;                            // samples of the current block
 };
 
 #endif /* maxiConvolve_h */
@@ -68,26 +68,51 @@ bool maxiFFT::process(float value, fftModes mode) {
 	//if buffer full, run fft
 	newFFT = pos == windowSize;
 	if (newFFT) {
+		transform(mode);
+	}
+	return newFFT;
+}
+
+bool maxiFFT::process(const float *values, int n, fftModes mode) {
+	bool result = false;
+	while (n > 0) {
+		//copy up to the end of the window
+		int count = windowSize - pos;
+		if (count > n) count = n;
+		memcpy(&buffer[0] + pos, values, count * sizeof(float));
+		pos += count;
+		values += count;
+		n -= count;
+		if (pos == windowSize) {
+			transform(mode);
+			result = true;
+		}
+	}
+	newFFT = result;
+	return result;
+}
+
+void maxiFFT::transform(fftModes mode) {
 #if defined(__APPLE_CC__) && !defined(_NO_VDSP)
-        if (mode == maxiFFT::WITH_POLAR_CONVERSION) {
-            _fft.powerSpectrum_vdsp(0, &buffer[0], &window[0], &magnitudes[0], &phases[0]);
-        }else{
-            _fft.calcFFT_vdsp(&buffer[0], &window[0]);
-        }
+	if (mode == maxiFFT::NO_POLAR_CONVERSION) {
+		_fft.calcFFT_vdsp(&buffer[0], &window[0]);
+	}else{
+		_fft.powerSpectrum_vdsp(0, &buffer[0], &window[0], &magnitudes[0], &phases[0]);
+	}
 #else
-        if (mode == maxiFFT::WITH_POLAR_CONVERSION) {
-            _fft.powerSpectrum(0, &buffer[0], &window[0], &magnitudes[0], &phases[0]);
-        }else{
-            _fft.calcFFT(0, &buffer[0], &window[0]);
-        }
-#endif
-		//shift buffer back by one hop size
-		memcpy(&buffer[0], &buffer[0] + hopSize, (windowSize - hopSize) * sizeof(float));
-		//reset pos to start of hop
-		pos= windowSize - hopSize;
-    recalc = true;
+	if (mode == maxiFFT::WITH_POLAR_CONVERSION) {
+		_fft.powerSpectrum(0, &buffer[0], &window[0], &magnitudes[0], &phases[0]);
+	}else if (mode == maxiFFT::MAGNITUDE_ONLY) {
+		_fft.magnitudeSpectrum(0, &buffer[0], &window[0], &magnitudes[0]);
+	}else{
+		_fft.calcFFT(0, &buffer[0], &window[0]);
 	}
-	return newFFT;
+#endif
+	//shift buffer back by one hop size
+	memmove(&buffer[0], &buffer[0] + hopSize, (windowSize - hopSize) * sizeof(float));
+	//reset pos to start of hop
+	pos= windowSize - hopSize;
+	recalc = true;
 }
 
 // bool maxiFFT::process(float value, int mode){
@@ -48,13 +48,15 @@ class maxiFFT {
 
 public:
 
-  enum fftModes {NO_POLAR_CONVERSION = 0, WITH_POLAR_CONVERSION = 1};
+  enum fftModes {NO_POLAR_CONVERSION = 0, WITH_POLAR_CONVERSION = 1, MAGNITUDE_ONLY = 2};
 
   maxiFFT() {};
   ~maxiFFT() {};
   void setup(int fftSize=1024, int hopSize=512, int windowSize=0);
 //  bool process(float value, int fftMode=1);
   bool process(float value, fftModes mode=maxiFFT::WITH_POLAR_CONVERSION);
+  //block version: returns true if at least one new frame was calculated (the results hold the last one)
+  bool process(const float *values, int n, fftModes mode=maxiFFT::WITH_POLAR_CONVERSION);
   inline float *getReal() {return _fft.getReal();};
   inline float *getImag() {return _fft.getImg();};
 
@@ -84,6 +86,7 @@ private:
   int bins;
   float recalc;
   std::vector<float> & magsToDB();
+  void transform(fftModes mode);
 
   friend maxiConvolve; // to avoid compile error for access to bins
 };
@@ -11,6 +11,7 @@
 #endif
 
 #include <list>
+#include <stdint.h>
 
 typedef unsigned long ulong;
 
@@ -90,52 +91,56 @@ struct gaussianWinFunctor {
 	}
 };
 
+// One window table per window shape (TFunc), shared by all grains whatever their length.
+// Grains step through it with a 32 bit fixed-point phase and interpolate linearly, so a
+// grain needs no window of its own and starting one costs nothing. Memory is
+// MAXI_GRAIN_WINDOW_SIZE + 1 values per shape (4 KB for float).
+// begin() allocates the table with maxi_malloc (PSRAM first on ESP32). It is called from
+// the players' sample constructor and setSample(), never from play(); on ESP32 call it
+// (or setSample()) in setup() if the player is a global object. maxiGrain does not
+// allocate it either: call maxiGrainPlayer::setup<F>() before creating grains.
+#define MAXI_GRAIN_WINDOW_BITS 10
+#define MAXI_GRAIN_WINDOW_SIZE (1 << MAXI_GRAIN_WINDOW_BITS)
+#define MAXI_GRAIN_WINDOW_FRAC_BITS (32 - MAXI_GRAIN_WINDOW_BITS)
+
 // Renamend T to TFunc because of compile errors on ESP32
 template<typename TFunc>
 class maxiGrainWindowCache {
 public:
-	unsigned int cacheSize;
-
-	maxiGrainWindowCache() {
-		cacheSize = maxiSettings::sampleRate / 2.0f; //allocate mem for up to 500ms grains
-		// esp32 avoid allocation in constructor because psram is not available yet!
-	}
-
-	~maxiGrainWindowCache() {
-		if (cache == nullptr) return;
-		for(int i=0; i < cacheSize; i++) {
-			if(NULL != cache[i]) {
-				free(cache[i]);
-			}
+	static bool begin() {
+		if (table != nullptr) return true;
+		maxi_float_t* newTable = (maxi_float_t*) maxi_malloc((MAXI_GRAIN_WINDOW_SIZE + 1) * sizeof(maxi_float_t));
+		if (newTable == nullptr) return false;
+		// the last entry is the window end point and the interpolation guard
+		for(int i=0; i <= MAXI_GRAIN_WINDOW_SIZE; i++) {
+			newTable[i] = TFunc()(MAXI_GRAIN_WINDOW_SIZE + 1, i);
 		}
-        free(cache);
+		table = newTable;
+		return true;
 	}
 
-	maxi_float_t* getWindow(const unsigned int length) {
-		alloc();
-		if (NULL == cache[length]) {
-			cache[length] = (maxi_float_t*) maxi_malloc(length * sizeof(maxi_float_t));
-			for(int i=0; i < length; i++) {
-				cache[length][i] = TFunc()(length, i);
-			}
-		}
-		return cache[length];
+	static bool isReady() {
+		return table != nullptr;
 	}
 
-private:
-	maxi_float_t** cache = nullptr;
+	// phase increment per sample for a grain of length samples
+	static uint32_t phaseIncrement(unsigned long length) {
+		if (length < 2) return 0;
+		return (uint32_t)(4294967296.0 / length);
+	}
 
-	void alloc() {
-		if (cache == nullptr) {
-			cache = (maxi_float_t**) maxi_malloc(cacheSize * sizeof(maxi_float_t*));
-			for(int i=0; i < cacheSize; i++) {
-				cache[i] = NULL;
-			}
-		}
+	static inline maxi_float_t value(uint32_t phase) {
+		uint32_t idx = phase >> MAXI_GRAIN_WINDOW_FRAC_BITS;
+		maxi_float_t frac = (phase & ((1u << MAXI_GRAIN_WINDOW_FRAC_BITS) - 1)) * (1.0f / (1u << MAXI_GRAIN_WINDOW_FRAC_BITS));
+		return table[idx] + frac * (table[idx + 1] - table[idx]);
 	}
 
+private:
+	static maxi_float_t* table;
 };
 
+template<typename TFunc> maxi_float_t* maxiGrainWindowCache<TFunc>::table = nullptr;
+
 class maxiGrainBase {
 public:
     virtual maxi_float_t play()=0;
@@ -157,7 +162,8 @@ public:
 	maxi_float_t speed;
 	maxi_float_t inc;
 	maxi_float_t frequency;
-	maxi_float_t* window;
+	uint32_t windowPhase;
+	uint32_t windowInc;
     maxi_float_t* buffer;
 #if defined(__APPLE_CC__) && defined(MAXIGRAINFAST)
 	maxi_float_t* grainSamples;
@@ -165,8 +171,9 @@ public:
 	/*
 	 position between 0.0f and 1.0
 	 duration in seconds
+	 the grain is silent if maxiGrainWindowCache<F>::begin() has not been called
 	 */
-	maxiGrain(maxiSample *sample, const maxi_float_t position, const maxi_float_t duration, const maxi_float_t speed, maxiGrainWindowCache<F> *windowCache) :sample(sample), pos(position), dur(duration), speed(speed)
+	maxiGrain(maxiSample *sample, const maxi_float_t position, const maxi_float_t duration, const maxi_float_t speed) :sample(sample), pos(position), dur(duration), speed(speed)
 	{
         buffer = &sample->amplitudes[0];
 //        buffer = sample->temp;
@@ -187,7 +194,10 @@ public:
             inc = sampleDur/(maxiSettings::sampleRate/frequency);
         }else
             inc = 0;
-		window = windowCache->getWindow(sampleDur);
+		// grains are created on demand on the audio thread: never allocate the table here
+		if (!maxiGrainWindowCache<F>::isReady()) finished = true;
+		windowPhase = 0;
+		windowInc = maxiGrainWindowCache<F>::phaseIncrement(sampleDur);
 
 #if defined(__APPLE_CC__) && defined(MAXIGRAINFAST)
 		//premake the grain using fast vector functions, and quadratic interpolation
@@ -211,7 +221,10 @@ public:
 		}
 		static maxi_float_t divFactor = 32767.0;
 		vDSP_vsdivD(grainSamples, 1, &divFactor, grainSamples, 1, sampleDur);
-		vDSP_vmulD(grainSamples, 1, window, 1, grainSamples, 1, sampleDur);
+		for(int i=0; i < sampleDur && !finished; i++) {
+			grainSamples[i] *= maxiGrainWindowCache<F>::value(windowPhase);
+			windowPhase += windowInc;
+		}
 		delete sourceData, interpIndexes;
 #endif
 	}
@@ -228,7 +241,8 @@ public:
 #if defined(__APPLE_CC__) && defined(MAXIGRAINFAST)
 			output = grainSamples[sampleIdx];
 #else
-			envValue = window[sampleIdx];
+			envValue = maxiGrainWindowCache<F>::value(windowPhase);
+			windowPhase += windowInc;
 			maxi_float_t remainder;
             pos += inc;
             if (pos >= sample->getLength())
@@ -272,6 +286,12 @@ public:
 	maxiGrainPlayer(maxiSample *sample) : sample(sample) {
 	}
 
+	// allocates the window table for grains with window F: call in setup(), not from play()
+	template<typename F>
+	static bool setup() {
+		return maxiGrainWindowCache<F>::begin();
+	}
+
 	void addGrain(maxiGrainBase *g) {
 		grains.push_back(g);
 	}
@@ -292,14 +312,141 @@ public:
 	}
 };
 
-template<typename F>
+// Fixed-capacity grain pool used by maxiTimeStretch, maxiPitchShift and maxiStretch.
+// Grain state lives in parallel arrays (position, increment, window index, gain) inside
+// the object, so starting or finishing a grain never touches the heap. Finished grains
+// are swap-removed to keep the active ones contiguous, and play(out, n) renders each
+// grain for a whole block in one tight loop.
+// MAX_GRAINS is the capacity; setMaxGrains() lowers the density limit to cap the CPU.
+// New grains are dropped while the pool is full.
+template<typename F, int MAX_GRAINS = 16>
+class maxiGrainPool {
+public:
+	maxiGrainPool() : sample(NULL), maxGrains(MAX_GRAINS), active(0) {
+	}
+
+	// allocates the shared window table: not called from play()
+	void setSample(maxiSample *sampleIn) {
+		maxiGrainWindowCache<F>::begin();
+		sample = sampleIn;
+		clear();
+	}
+
+	void clear() {
+		active = 0;
+	}
+
+	void setMaxGrains(int count) {
+		maxGrains = count < 1 ? 1 : (count > MAX_GRAINS ? MAX_GRAINS : count);
+		if (active > maxGrains) active = maxGrains;
+	}
+
+	int getMaxGrains() { return maxGrains; }
+	int getActiveGrains() { return active; }
+
+	/*
+	 position between 0.0f and 1.0
+	 duration in seconds
+	 same start position and increment as maxiGrain
+	 */
+	bool addGrain(const maxi_float_t position, const maxi_float_t duration, const maxi_float_t speed, const maxi_float_t gain=1.0f) {
+		if (sample == NULL || active >= maxGrains || !maxiGrainWindowCache<F>::isReady()) return false;
+		long length = sample->getLength();
+		long sampleDur = duration * (maxi_float_t)sample->mySampleRate;
+		if (length < 2 || sampleDur < 1) return false;
+		long sampleStartPos = length * position;
+		long sampleEndPos = sampleStartPos + sampleDur < length ? sampleStartPos + sampleDur : length;
+
+		int g = active++;
+		grainPos[g] = speed > 0 ? sampleStartPos : sampleEndPos;
+		grainInc[g] = speed * (maxi_float_t)sample->mySampleRate / maxiSettings::sampleRate;
+		grainWin[g] = 0;
+		grainWinInc[g] = maxiGrainWindowCache<F>::phaseIncrement(sampleDur);
+		grainGain[g] = gain;
+		grainLeft[g] = sampleDur;
+		return true;
+	}
+
+	// adds all active grains into out[0..n-1]
+	void play(maxi_float_t *out, int n) {
+		if (sample == NULL || n <= 0) return;
+		const maxi_float_t *buffer = &sample->amplitudes[0];
+		const long length = sample->getLength();
+		const maxi_float_t flength = length;
+
+		int g = 0;
+		while (g < active) {
+			int count = grainLeft[g] < n ? grainLeft[g] : n;
+			maxi_float_t pos = grainPos[g];
+			maxi_float_t inc = grainInc[g];
+			uint32_t win = grainWin[g];
+			uint32_t winInc = grainWinInc[g];
+			maxi_float_t gain = grainGain[g];
+			for (int i = 0; i < count; i++) {
+				pos += inc;
+				if (pos >= flength)
+					pos -= flength;
+				else if (pos < 0)
+					pos += flength;
+				long a = (long)pos;
+				long b = a + 1;
+				if (b >= length) b = 0;
+				maxi_float_t remainder = pos - a;
+				maxi_float_t value = buffer[a] + remainder * (buffer[b] - buffer[a]); //linear interpolation
+				out[i] += value * maxiGrainWindowCache<F>::value(win) * gain;
+				win += winInc;
+			}
+			grainLeft[g] -= count;
+			if (grainLeft[g] == 0) {
+				// swap in the last grain, it gets rendered in the next iteration
+				active--;
+				grainPos[g] = grainPos[active];
+				grainInc[g] = grainInc[active];
+				grainWin[g] = grainWin[active];
+				grainWinInc[g] = grainWinInc[active];
+				grainGain[g] = grainGain[active];
+				grainLeft[g] = grainLeft[active];
+			}else{
+				grainPos[g] = pos;
+				grainWin[g] = win;
+				g++;
+			}
+		}
+	}
+
+	inline maxi_float_t play() {
+		maxi_float_t output = 0.0f;
+		play(&output, 1);
+		return output;
+	}
+
+protected:
+	maxiSample *sample;
+	int maxGrains;
+	int active;
+	maxi_float_t grainPos[MAX_GRAINS];
+	maxi_float_t grainInc[MAX_GRAINS];
+	uint32_t grainWin[MAX_GRAINS];		//fixed-point window phase
+	uint32_t grainWinInc[MAX_GRAINS];
+	maxi_float_t grainGain[MAX_GRAINS];
+	long grainLeft[MAX_GRAINS];			//samples until the grain is finished
+};
+
+static inline maxi_float_t maxiGrainClamp(maxi_float_t value) {
+	return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
+
+static inline void maxiGrainClear(maxi_float_t *out, int n) {
+	for (int i = 0; i < n; i++) out[i] = 0.0f;
+}
+
+template<typename F, int MAX_GRAINS = 16>
 class maxiTimeStretch {
 protected:
     maxi_float_t position;
 public:
 	maxiSample *sample;
-	maxiGrainPlayer *grainPlayer;
-	maxiGrainWindowCache<F> windowCache;
+	maxiGrainPool<F, MAX_GRAINS> grains;
 	maxi_float_t randomOffset;
     maxi_float_t looper;
 
@@ -307,29 +454,19 @@ public:
 		position=0;
 		looper = 0;
 		randomOffset=0;
+		sample = NULL;
 	}
 
 	maxiTimeStretch(maxiSample *sample) : sample(sample) {
 		position=0;
         looper = 0;
-		grainPlayer = new maxiGrainPlayer(sample);
+		grains.setSample(sample);
 		randomOffset=0;
 	}
 
-	~maxiTimeStretch() {
-		delete grainPlayer;
-	}
-
 	void setSample(maxiSample* sampleIn){
-		// could just erase the sample in player
-		// and replace?
-		if(grainPlayer){
-			delete grainPlayer;
-			grainPlayer = NULL;
-		}
-
 		sample = sampleIn;
-		grainPlayer = new maxiGrainPlayer(sample);
+		grains.setSample(sample);
 	}
 
     maxi_float_t getNormalisedPosition() {
@@ -348,31 +485,41 @@ public:
 
 	//play at a speed
     inline maxi_float_t play(maxi_float_t speed=1, maxi_float_t grainLength=0.05, int overlaps=2, maxi_float_t posMod=0) {
-		position = position + speed;
-        looper++;
-		if (position > sample->getLength()) position-= sample->getLength();
-		if (position < 0) position += sample->getLength();
+		maxi_float_t output;
+		play(&output, 1, speed, grainLength, overlaps, posMod);
+		return output;
+	}
+
+	//render a block, grains start at the same sample as with the per sample play()
+	void play(maxi_float_t *out, int n, maxi_float_t speed=1, maxi_float_t grainLength=0.05, int overlaps=2, maxi_float_t posMod=0) {
+		maxiGrainClear(out, n);
 		maxi_float_t cycleLength = grainLength * maxiSettings::sampleRate  / overlaps;
-        if (looper > cycleLength + randomOffset) {
-            looper -= (cycleLength + randomOffset);
-			speed = (speed > 0 ? 1 : -1);
-			maxiGrain<F> *g = new maxiGrain<F>(sample, max(min((maxi_float_t)1.0,(maxi_float_t)(position / sample->getLength()) + posMod),(maxi_float_t)0.0f), grainLength, speed, &windowCache);
-			grainPlayer->addGrain(g);
-			randomOffset = rand() % 10;
+		maxi_float_t grainSpeed = (speed > 0 ? 1 : -1);
+		int rendered = 0;
+		for (int i = 0; i < n; i++) {
+			position = position + speed;
+			looper++;
+			if (position > sample->getLength()) position-= sample->getLength();
+			if (position < 0) position += sample->getLength();
+			if (looper > cycleLength + randomOffset) {
+				looper -= (cycleLength + randomOffset);
+				grains.play(out + rendered, i - rendered);
+				rendered = i;
+				grains.addGrain(maxiGrainClamp(position / sample->getLength() + posMod), grainLength, grainSpeed);
+				randomOffset = rand() % 10;
+			}
 		}
-		return grainPlayer->play();
+		grains.play(out + rendered, n - rendered);
 	}
 
 
     //provide your own position iteration
 	inline maxi_float_t playAtPosition(maxi_float_t pos, maxi_float_t grainLength, int overlaps) {
 		looper++;
-		pos *= sample->getLength();
 		if (0 == floor(fmod(looper, grainLength * maxiSettings::sampleRate / overlaps))) {
-			maxiGrain<F> *g = new maxiGrain<F>(sample, max(min((maxi_float_t)1.0,(pos / sample->getLength())),(maxi_float_t)0.0f), grainLength, 1, &windowCache);
-			grainPlayer->addGrain(g);
+			grains.addGrain(maxiGrainClamp(pos), grainLength, 1);
 		}
-		return grainPlayer->play();
+		return grains.play();
 	}
 };
 
@@ -380,62 +527,59 @@ public:
 //in maxiPitchShift, speed is uncoupled from position and allowed to set it's value incrementally, resulting in pitchshift.
 //with both high speed values and negative speed values there are some terrific artefacts!
 
-template<typename F>
+template<typename F, int MAX_GRAINS = 16>
 class maxiPitchShift {
 public:
 	maxi_float_t position;
 	long cycles;
 	maxiSample *sample;
-	maxiGrainPlayer *grainPlayer;
-	maxiGrainWindowCache<F> windowCache;
+	maxiGrainPool<F, MAX_GRAINS> grains;
 	maxi_float_t randomOffset;
 
 	maxiPitchShift(){
 		position=0;
 		cycles=0;
-//		grainPlayer = new maxiGrainPlayer(sample);
 		randomOffset=0;
+		sample = NULL;
 	}
 
 	maxiPitchShift(maxiSample *sample) : sample(sample) {
 		position=0;
 		cycles=0;
-		grainPlayer = new maxiGrainPlayer(sample);
+		grains.setSample(sample);
 		randomOffset=0;
 	}
 
-	~maxiPitchShift() {
-		delete grainPlayer;
-	}
-
 	void setSample(maxiSample* sampleIn){
-		if(grainPlayer){
-			delete grainPlayer;
-			grainPlayer = NULL;
-		}
-
 		sample = sampleIn;
-		grainPlayer = new maxiGrainPlayer(sample);
+		grains.setSample(sample);
 	}
 
 	maxi_float_t play(maxi_float_t speed, maxi_float_t grainLength, int overlaps, maxi_float_t posMod=0.0f) {
-		position = position + 1;
-		cycles++;
-		if (position > sample->getLength()) position=0;
-		if (position < 0) position = sample->getLength();
+		maxi_float_t output;
+		play(&output, 1, speed, grainLength, overlaps, posMod);
+		return output;
+	}
+
+	//render a block, grains start at the same sample as with the per sample play()
+	void play(maxi_float_t *out, int n, maxi_float_t speed, maxi_float_t grainLength, int overlaps, maxi_float_t posMod=0.0f) {
+		maxiGrainClear(out, n);
 		maxi_float_t cycleLength = grainLength * maxiSettings::sampleRate  / overlaps;
-		maxi_float_t cycleMod = fmod(cycles, cycleLength + randomOffset);
-		if (0 == floor(cycleMod)) {
-			//			cout << cycleMod << endl;
-			//speed = (speed > 0 ? 1 : -1);
-			speed = speed - ((cycleMod / cycleLength) * 0.1f);
-			maxiGrain<F> *g = new maxiGrain<F>(sample, max(min((maxi_float_t)1.0,(position / sample->getLength()) + posMod),(maxi_float_t)0.0f), grainLength, speed, &windowCache);
-			grainPlayer->addGrain(g);
-			//			cout << grainPlayer->grains.size() << endl;
-			//			randomOffset = rand() % 10;
-			//			randomOffset = rand() % 10;
+		int rendered = 0;
+		for (int i = 0; i < n; i++) {
+			position = position + 1;
+			cycles++;
+			if (position > sample->getLength()) position=0;
+			if (position < 0) position = sample->getLength();
+			maxi_float_t cycleMod = fmod(cycles, cycleLength + randomOffset);
+			if (0 == floor(cycleMod)) {
+				maxi_float_t grainSpeed = speed - ((cycleMod / cycleLength) * 0.1f);
+				grains.play(out + rendered, i - rendered);
+				rendered = i;
+				grains.addGrain(maxiGrainClamp(position / sample->getLength() + posMod), grainLength, grainSpeed);
+			}
 		}
-		return grainPlayer->play();
+		grains.play(out + rendered, n - rendered);
 	}
 
 };
@@ -443,13 +587,12 @@ public:
 //and here's maxiStretch. Args to the play function are basically speed for 'pitch' and rate for playback rate.
 //the rest is the same.
 
-template<typename F>
+template<typename F, int MAX_GRAINS = 16>
 class maxiStretch {
 public:
 	maxi_float_t position;
 	maxiSample *sample;
-	maxiGrainPlayer *grainPlayer;
-	maxiGrainWindowCache<F> windowCache;
+	maxiGrainPool<F, MAX_GRAINS> grains;
 	maxi_float_t randomOffset;
     unsigned  long loopStart, loopEnd, loopLength;
     maxi_float_t looper;
@@ -463,7 +606,7 @@ public:
 	}
 
 	maxiStretch(maxiSample *sample) : sample(sample) {
-		grainPlayer = new maxiGrainPlayer(sample);
+		grains.setSample(sample);
 		randomOffset=0;
         loopStart = 0.0f;
         loopEnd = sample->getLength();
@@ -473,12 +616,8 @@ public:
 	}
 
 	void setSample(maxiSample* newSample){
-		if(grainPlayer){
-			delete grainPlayer;
-			grainPlayer = NULL;
-		}
         sample = newSample;
-		grainPlayer = new maxiGrainPlayer(sample);
+		grains.setSample(sample);
         loopStart = 0;
         loopEnd = sample->getLength();
         loopLength = sample->getLength();
@@ -509,42 +648,45 @@ public:
         loopLength = loopEnd - loopStart;
     }
 
-	~maxiStretch() {
-		delete grainPlayer;
-	}
-
     unsigned long getLoopEnd() {
         return loopEnd;
     }
 
 
 	inline maxi_float_t play(maxi_float_t pitchstretch=1, maxi_float_t timestretch=1, maxi_float_t grainLength=0.05, int overlaps=2, maxi_float_t posMod=0.0f) {
-        if (sample != NULL) {
+		maxi_float_t output;
+		play(&output, 1, pitchstretch, timestretch, grainLength, overlaps, posMod);
+		return output;
+	}
+
+	//render a block, grains start at the same sample as with the per sample play()
+	void play(maxi_float_t *out, int n, maxi_float_t pitchstretch=1, maxi_float_t timestretch=1, maxi_float_t grainLength=0.05, int overlaps=2, maxi_float_t posMod=0.0f) {
+		maxiGrainClear(out, n);
+		if (sample == NULL) return;
+		maxi_float_t cycleLength = grainLength * maxiSettings::sampleRate  / overlaps;
+		int rendered = 0;
+		for (int i = 0; i < n; i++) {
             position = position + (1 * timestretch);
             looper++;
             if (position >= loopEnd) position-= loopLength;
             if (position < loopStart) position += loopLength;
-            maxi_float_t cycleLength = grainLength * maxiSettings::sampleRate  / overlaps;
             if (looper > cycleLength + randomOffset) {
                 looper -= (cycleLength + randomOffset);
-                maxiGrain<F> *g = new maxiGrain<F>(sample, max(min((maxi_float_t)1.0,(position / sample->getLength()) + posMod),(maxi_float_t)0.0f), grainLength, pitchstretch, &windowCache);
-                grainPlayer->addGrain(g);
+				grains.play(out + rendered, i - rendered);
+				rendered = i;
+                grains.addGrain(maxiGrainClamp(position / sample->getLength() + posMod), grainLength, pitchstretch);
                 randomOffset = rand() % 10;
             }
-            return grainPlayer->play();
-        }else{
-            return 0;
-        }
+		}
+		grains.play(out + rendered, n - rendered);
 	}
 
     inline maxi_float_t playAtPosition(maxi_float_t pitchstretch=1, maxi_float_t pos=0, maxi_float_t grainLength=0.05, int overlaps=2) {
         looper++;
-        pos *= sample->getLength();
         if (0 == floor(fmod(looper, grainLength * maxiSettings::sampleRate / overlaps))) {
-            maxiGrain<F> *g = new maxiGrain<F>(sample, max(min((maxi_float_t)1.0,(pos / sample->getLength())),(maxi_float_t)0.0f), grainLength, pitchstretch, &windowCache);
-            grainPlayer->addGrain(g);
+            grains.addGrain(maxiGrainClamp(pos), grainLength, pitchstretch);
         }
-        return grainPlayer->play();
+        return grains.play();
     }
 
 
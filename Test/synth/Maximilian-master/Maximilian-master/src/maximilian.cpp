@@ -58,6 +58,11 @@ int maxiSettings::sampleRate = 44100;
 int maxiSettings::channels = 2;
 int maxiSettings::bufferSize = 1024;
 
+maxiContext &maxiContext::global() {
+	static maxiContext context(44100);
+	return context;
+}
+
 
 //this is a 514-point sinewave table that has many uses.
 const maxi_float_t sineBuffer[514]={0,0.012268,0.024536,0.036804,0.049042,0.06131,0.073547,0.085785,0.097992,0.1102,0.12241,0.13455,0.1467,0.15884,0.17093,0.18301,0.19507,0.20709,0.21909,0.23105,0.24295,0.25485,0.26669,0.2785,0.29025,0.30197,0.31366,0.32529,0.33685,0.34839,0.35986,0.37128,0.38266,0.39395,0.40521,0.41641,0.42752,0.4386,0.44958,0.46051,0.47137,0.48215,0.49286,0.50351,0.51407,0.52457,0.53497,0.54529,0.55554,0.5657,0.57578,0.58575,0.59567,0.60547,0.6152,0.62482,0.63437,0.6438,0.65314,0.66238,0.67151,0.68057,0.68951,0.69833,0.70706,0.7157,0.72421,0.7326,0.74091,0.74908,0.75717,0.76514,0.77298,0.7807,0.7883,0.79581,0.80316,0.81042,0.81754,0.82455,0.83142,0.8382,0.84482,0.85132,0.8577,0.86392,0.87006,0.87604,0.88187,0.8876,0.89319,0.89862,0.90396,0.90912,0.91415,0.91907,0.92383,0.92847,0.93295,0.93729,0.9415,0.94556,0.94949,0.95325,0.95691,0.96039,0.96375,0.96692,0.97,0.9729,0.97565,0.97827,0.98074,0.98306,0.98523,0.98724,0.98914,0.99084,0.99243,0.99387,0.99515,0.99628,0.99725,0.99808,0.99875,0.99927,0.99966,0.99988,0.99997,0.99988,0.99966,0.99927,0.99875,0.99808,0.99725,0.99628,0.99515,0.99387,0.99243,0.99084,0.98914,0.98724,0.98523,0.98306,0.98074,0.97827,0.97565,0.9729,0.97,0.96692,0.96375,0.96039,0.95691,0.95325,0.94949,0.94556,0.9415,0.93729,0.93295,0.92847,0.92383,0.91907,0.91415,0.90912,0.90396,0.89862,0.89319,0.8876,0.88187,0.87604,0.87006,0.86392,0.8577,0.85132,0.84482,0.8382,0.83142,0.82455,0.81754,0.81042,0.80316,0.79581,0.7883,0.7807,0.77298,0.76514,0.75717,0.74908,0.74091,0.7326,0.72421,0.7157,0.70706,0.69833,0.68951,0.68057,0.67151,0.66238,0.65314,0.6438,0.63437,0.62482,0.6152,0.60547,0.59567,0.58575,0.57578,0.5657,0.55554,0.54529,0.53497,0.52457,0.51407,0.50351,0.49286,0.48215,0.47137,0.46051,0.44958,0.4386,0.42752,0.41641,0.40521,0.39395,0.38266,0.37128,0.35986,0.34839,0.33685,0.32529,0.31366,0.30197,0.29025,0.2785,0.26669,0.25485,0.24295,0.23105,0.21909,0.20709,0.19507,0.18301,0.17093,0.15884,0.1467,0.13455,0.12241,0.1102,0.097992,0.085785,0.073547,0.06131,0.049042,0.036804,0.024536,0.012268,0,-0.012268,-0.024536,-0.036804,-0.049042,-0.06131,-0.073547,-0.085785,-0.097992,-0.1102,-0.12241,-0.13455,-0.1467,-0.15884,-0.17093,-0.18301,-0.19507,-0.20709,-0.21909,-0.23105,-0.24295,-0.25485,-0.26669,-0.2785,-0.29025,-0.30197,-0.31366,-0.32529,-0.33685,-0.34839,-0.35986,-0.37128,-0.38266,-0.39395,-0.40521,-0.41641,-0.42752,-0.4386,-0.44958,-0.46051,-0.47137,-0.48215,-0.49286,-0.50351,-0.51407,-0.52457,-0.53497,-0.54529,-0.55554,-0.5657,-0.57578,-0.58575,-0.59567,-0.60547,-0.6152,-0.62482,-0.63437,-0.6438,-0.65314,-0.66238,-0.67151,-0.68057,-0.68951,-0.69833,-0.70706,-0.7157,-0.72421,-0.7326,-0.74091,-0.74908,-0.75717,-0.76514,-0.77298,-0.7807,-0.7883,-0.79581,-0.80316,-0.81042,-0.81754,-0.82455,-0.83142,-0.8382,-0.84482,-0.85132,-0.8577,-0.86392,-0.87006,-0.87604,-0.88187,-0.8876,-0.89319,-0.89862,-0.90396,-0.90912,-0.91415,-0.91907,-0.92383,-0.92847,-0.93295,-0.93729,-0.9415,-0.94556,-0.94949,-0.95325,-0.95691,-0.96039,-0.96375,-0.96692,-0.97,-0.9729,-0.97565,-0.97827,-0.98074,-0.98306,-0.98523,-0.98724,-0.98914,-0.99084,-0.99243,-0.99387,-0.99515,-0.99628,-0.99725,-0.99808,-0.99875,-0.99927,-0.99966,-0.99988,-0.99997,-0.99988,-0.99966,-0.99927,-0.99875,-0.99808,-0.99725,-0.99628,-0.99515,-0.99387,-0.99243,-0.99084,-0.98914,-0.98724,-0.98523,-0.98306,-0.98074,-0.97827,-0.97565,-0.9729,-0.97,-0.96692,-0.96375,-0.96039,-0.95691,-0.95325,-0.94949,-0.94556,-0.9415,-0.93729,-0.93295,-0.92847,-0.92383,-0.91907,-0.91415,-0.90912,-0.90396,-0.89862,-0.89319,-0.8876,-0.88187,-0.87604,-0.87006,-0.86392,-0.8577,-0.85132,-0.84482,-0.8382,-0.83142,-0.82455,-0.81754,-0.81042,-0.80316,-0.79581,-0.7883,-0.7807,-0.77298,-0.76514,-0.75717,-0.74908,-0.74091,-0.7326,-0.72421,-0.7157,-0.70706,-0.69833,-0.68951,-0.68057,-0.67151,-0.66238,-0.65314,-0.6438,-0.63437,-0.62482,-0.6152,-0.60547,-0.59567,-0.58575,-0.57578,-0.5657,-0.55554,-0.54529,-0.53497,-0.52457,-0.51407,-0.50351,-0.49286,-0.48215,-0.47137,-0.46051,-0.44958,-0.4386,-0.42752,-0.41641,-0.40521,-0.39395,-0.38266,-0.37128,-0.35986,-0.34839,-0.33685,-0.32529,-0.31366,-0.30197,-0.29025,-0.2785,-0.26669,-0.25485,-0.24295,-0.23105,-0.21909,-0.20709,-0.19507,-0.18301,-0.17093,-0.15884,-0.1467,-0.13455,-0.12241,-0.1102,-0.097992,-0.085785,-0.073547,-0.06131,-0.049042,-0.036804,-0.024536,-0.012268,0,0.012268
@@ -229,7 +234,7 @@ maxi_float_t maxiOsc::sinewave(maxi_float_t frequency) {
 	//This is a sinewave oscillator
 	output=sin (phase*(TWOPI));
 	if ( phase >= 1.0f ) phase -= 1.0;
-	phase += (1.f/(maxiSettings::sampleRate/(frequency)));
+	phase += (frequency * ctx->invSampleRate);
 	return(output);
 
 }
@@ -238,7 +243,7 @@ maxi_float_t maxiOsc::sinebuf4(maxi_float_t frequency) {
 	//This is a sinewave oscillator that uses 4 point interpolation on a 514 point buffer
 	maxi_float_t remainder;
 	maxi_float_t a,b,c,d,a1,a2,a3;
-	phase += 512.f/(maxiSettings::sampleRate/(frequency));
+	phase += 512.f*frequency*ctx->invSampleRate;
 	if ( phase >= 511 ) phase -=512;
 	remainder = phase - floor(phase);
 
@@ -266,7 +271,7 @@ maxi_float_t maxiOsc::sinebuf4(maxi_float_t frequency) {
 maxi_float_t maxiOsc::sinebuf(maxi_float_t frequency) { //specify the frequency of the oscillator in Hz / cps etc.
 											//This is a sinewave oscillator that uses linear interpolation on a 514 point buffer
 	maxi_float_t remainder;
-	phase += 512.f/(maxiSettings::sampleRate/(frequency*chandiv));
+	phase += 512.f*frequency*chandiv*ctx->invSampleRate;
 	if ( phase >= 511 ) phase -=512;
 	remainder = phase - floor(phase);
 	output = (maxi_float_t) ((1-remainder) * sineBuffer[1+ (long) phase] + remainder * sineBuffer[2+(long) phase]);
@@ -277,7 +282,7 @@ maxi_float_t maxiOsc::coswave(maxi_float_t frequency) {
 	//This is a cosine oscillator
 	output=cos (phase*(TWOPI));
 	if ( phase >= 1.0f ) phase -= 1.0;
-	phase += (1.f/(maxiSettings::sampleRate/(frequency)));
+	phase += (frequency * ctx->invSampleRate);
 	return(output);
 
 }
@@ -286,7 +291,7 @@ maxi_float_t maxiOsc::phasor(maxi_float_t frequency) {
 	//This produces a floating point linear ramp between 0 and 1 at the desired frequency
 	output=phase;
 	if ( phase >= 1.0f ) phase -= 1.0;
-	phase += (1.f/(maxiSettings::sampleRate/(frequency)));
+	phase += (frequency * ctx->invSampleRate);
 	return(output);
 }
 
@@ -295,7 +300,7 @@ maxi_float_t maxiOsc::square(maxi_float_t frequency) {
 	if (phase<0.5f) output=-1;
 	if (phase>0.5f) output=1;
 	if ( phase >= 1.0f ) phase -= 1.0;
-	phase += (1.f/(maxiSettings::sampleRate/(frequency)));
+	phase += (frequency * ctx->invSampleRate);
 	return(output);
 }
 
@@ -304,7 +309,7 @@ maxi_float_t maxiOsc::pulse(maxi_float_t frequency, maxi_float_t duty) {
 	if (duty<0.f) duty=0;
 	if (duty>1.f) duty=1;
 	if ( phase >= 1.0f ) phase -= 1.0;
-	phase += (1.f/(maxiSettings::sampleRate/(frequency)));
+	phase += (frequency * ctx->invSampleRate);
 	if (phase<duty) output=-1.;
 	if (phase>duty) output=1.;
 	return(output);
@@ -312,7 +317,7 @@ maxi_float_t maxiOsc::pulse(maxi_float_t frequency, maxi_float_t duty) {
 maxi_float_t maxiOsc::impulse(maxi_float_t frequency) {
     //this is an impulse generator
     if ( phase >= 1.0f ) phase -= 1.0;
-    maxi_float_t phaseInc = (1.f/(maxiSettings::sampleRate/(frequency)));
+    maxi_float_t phaseInc = (frequency * ctx->invSampleRate);
     maxi_float_t output = phase < phaseInc ? 1.0f : 0.0f;
     phase += phaseInc;
     return output;
@@ -325,7 +330,7 @@ maxi_float_t maxiOsc::phasorBetween(maxi_float_t frequency, maxi_float_t startph
 		phase=startphase;
 	}
 	if ( phase >= endphase ) phase = startphase;
-	phase += ((endphase-startphase)/(maxiSettings::sampleRate/(frequency)));
+	phase += ((endphase-startphase)*frequency*ctx->invSampleRate);
 	return(output);
 }
 
@@ -334,7 +339,7 @@ maxi_float_t maxiOsc::saw(maxi_float_t frequency) {
 	//Sawtooth generator. This is like a phasor but goes between -1 and 1
 	output=phase;
 	if ( phase >= 1.0f ) phase -= 2.0f;
-	phase += (1.f/(maxiSettings::sampleRate/(frequency))) * 2.0f;
+	phase += (frequency * ctx->invSampleRate) * 2.0f;
 	return(output);
 
 }
@@ -342,7 +347,7 @@ maxi_float_t maxiOsc::saw(maxi_float_t frequency) {
 maxi_float_t maxiOsc::sawn(maxi_float_t frequency) {
 	//Bandlimited sawtooth generator. Woohoo.
 	if ( phase >= 0.5f ) phase -= 1.0;
-	phase += (1.f/(maxiSettings::sampleRate/(frequency)));
+	phase += (frequency * ctx->invSampleRate);
 	maxi_float_t temp=(8820.22f/frequency)*phase;
 	if (temp<-0.5f) {
 		temp=-0.5f;
@@ -366,7 +371,7 @@ maxi_float_t maxiOsc::rect(maxi_float_t frequency, maxi_float_t duty) {
 maxi_float_t maxiOsc::triangle(maxi_float_t frequency) {
 	//This is a triangle wave.
 	if ( phase >= 1.0f ) phase -= 1.0;
-	phase += (1.f/(maxiSettings::sampleRate/(frequency)));
+	phase += (frequency * ctx->invSampleRate);
 	if (phase <= 0.5f ) {
 		output =(phase - 0.25f) * 4;
 	} else {
@@ -386,9 +391,9 @@ maxi_float_t maxiEnvelope::line(int numberofsegments,std::vector<maxi_float_t>&
 		nextval=segments[valindex+2];
 		currentval=segments[valindex];
 		if (currentval-amplitude > 0.0000001f && valindex < numberofsegments) {
-			amplitude += ((currentval-startval)/(maxiSettings::sampleRate/period));
+			amplitude += ((currentval-startval)*period*ctx->invSampleRate);
 		} else if (currentval-amplitude < -0.0000001f && valindex < numberofsegments) {
-			amplitude -= (((currentval-startval)*(-1))/(maxiSettings::sampleRate/period));
+			amplitude -= (((currentval-startval)*(-1))*period*ctx->invSampleRate);
 		} else if (valindex >numberofsegments-1) {
 			valindex=numberofsegments-2;
 		} else {
@@ -469,9 +474,9 @@ maxi_float_t maxiFilter::hipass(maxi_float_t input, maxi_float_t cutoff) {
 maxi_float_t maxiFilter::lores(maxi_float_t input,maxi_float_t cutoff1, maxi_float_t resonance) {
 	cutoff=cutoff1;
 	if (cutoff<10) cutoff=10;
-	if (cutoff>(maxiSettings::sampleRate)) cutoff=(maxiSettings::sampleRate);
+	if (cutoff>(ctx->sampleRate)) cutoff=(ctx->sampleRate);
 	if (resonance<1.f) resonance = 1.;
-	z=cos(TWOPI*cutoff/maxiSettings::sampleRate);
+	z=cos(TWOPI*cutoff*ctx->invSampleRate);
 	c=2-2*z;
 	maxi_float_t r=(sqrt(2.0f)*sqrt(-pow((z-1.0f),3.0f))+resonance*(z-1))/(resonance*(z-1));
 	x=x+(input-y)*c;
@@ -485,9 +490,9 @@ maxi_float_t maxiFilter::lores(maxi_float_t input,maxi_float_t cutoff1, maxi_flo
 maxi_float_t maxiFilter::hires(maxi_float_t input,maxi_float_t cutoff1, maxi_float_t resonance) {
 	cutoff=cutoff1;
 	if (cutoff<10) cutoff=10;
-	if (cutoff>(maxiSettings::sampleRate)) cutoff=(maxiSettings::sampleRate);
+	if (cutoff>(ctx->sampleRate)) cutoff=(ctx->sampleRate);
 	if (resonance<1.f) resonance = 1.;
-	z=cos(TWOPI*cutoff/maxiSettings::sampleRate);
+	z=cos(TWOPI*cutoff*ctx->invSampleRate);
 	c=2-2*z;
 	maxi_float_t r=(sqrt(2.0f)*sqrt(-pow((z-1.0f),3.0f))+resonance*(z-1))/(resonance*(z-1));
 	x=x+(input-y)*c;
@@ -500,9 +505,9 @@ maxi_float_t maxiFilter::hires(maxi_float_t input,maxi_float_t cutoff1, maxi_flo
 //This works a bit. Needs attention.
 maxi_float_t maxiFilter::bandpass(maxi_float_t input,maxi_float_t cutoff1, maxi_float_t resonance) {
 	cutoff=cutoff1;
-	if (cutoff>(maxiSettings::sampleRate*0.5f)) cutoff=(maxiSettings::sampleRate*0.5f);
+	if (cutoff>(ctx->sampleRate*0.5f)) cutoff=(ctx->sampleRate*0.5f);
 	if (resonance>=1.f) resonance=0.999999;
-	z=cos(TWOPI*cutoff/maxiSettings::sampleRate);
+	z=cos(TWOPI*cutoff*ctx->invSampleRate);
 	inputs[0] = (1.0f-resonance)*(sqrt(resonance*(resonance-4.0f*pow(z,2.0f)+2.0f)+1));
 	inputs[1] = 2*z*resonance;
 	inputs[2] = pow((resonance*-1),2);
@@ -557,7 +562,7 @@ void maxiMix::ambisonic(maxi_float_t input,std::vector<maxi_float_t>&eight,maxi_
 // MAXI_SAMPLE
 
 
-maxiSample::maxiSample():position(0), recordPosition(0), myChannels(1), mySampleRate(maxiSettings::sampleRate) {};
+maxiSample::maxiSample():position(0), recordPosition(0), myChannels(1), mySampleRate(ctx->sampleRate) {};
 
 #ifdef VORBIS
 
@@ -790,7 +795,7 @@ maxi_float_t maxiSample::playAtSpeedBetweenPointsFromPos(maxi_float_t frequency,
 		}
 
 		if ( pos >= end ) pos = start;
-		pos += ((end-start)/((maxiSettings::sampleRate)/(frequency*chandiv)));
+		pos += ((end-start)*frequency*chandiv*ctx->invSampleRate);
 		remainder = pos - floor(pos);
 		long posl = floor(pos);
 		if (posl+1<amplen) {
@@ -810,7 +815,7 @@ maxi_float_t maxiSample::playAtSpeedBetweenPointsFromPos(maxi_float_t frequency,
 	} else {
 		frequency*=-1.;
 		if ( pos <= start ) pos = end;
-		pos -= ((end-start)/(maxiSettings::sampleRate/(frequency*chandiv)));
+		pos -= ((end-start)*frequency*chandiv*ctx->invSampleRate);
 		remainder = pos - floor(pos);
 		long posl = floor(pos);
 		if (posl-1>=0) {
@@ -842,7 +847,7 @@ maxi_float_t maxiSample::play4(maxi_float_t frequency, maxi_float_t start, maxi_
 			position=start;
 		}
 		if ( position >= end ) position = start;
-		position += ((end-start)/(maxiSettings::sampleRate/(frequency*chandiv)));
+		position += ((end-start)*frequency*chandiv*ctx->invSampleRate);
 		remainder = position - floor(position);
 		if (position>0) {
 			a=F64_ARRAY_AT(amplitudes,(int)(floor(position))-1);
@@ -874,7 +879,7 @@ maxi_float_t maxiSample::play4(maxi_float_t frequency, maxi_float_t start, maxi_
 	} else {
 		frequency*=-1.;
 		if ( position <= start ) position = end;
-		position -= ((end-start)/(maxiSettings::sampleRate/(frequency*chandiv)));
+		position -= ((end-start)*frequency*chandiv*ctx->invSampleRate);
 		remainder = position - floor(position);
 		if (position>start && position < end-1) {
 			a=F64_ARRAY_AT(amplitudes,(long) position+1);
@@ -951,7 +956,7 @@ maxi_float_t maxiSample::playOnceAtSpeed(maxi_float_t speed) {
 		F64_ARRAY_AT(amplitudes,1+(long) position));//linear interpolation
 	else
 		output=0;
-	position=position+((speed*chandiv)/(maxiSettings::sampleRate/mySampleRate));
+	position=position+(speed*chandiv*mySampleRate*ctx->invSampleRate);
 	return(output);
 }
 
@@ -1004,7 +1009,7 @@ maxi_float_t maxiSample::playUntilAtSpeed(maxi_float_t end, maxi_float_t speed)
 	else
 		output=0;
 
-	position=position+((speed*chandiv)/(maxiSettings::sampleRate/mySampleRate));
+	position=position+(speed*chandiv*mySampleRate*ctx->invSampleRate);
 	return output;
 }
 
@@ -1013,7 +1018,7 @@ maxi_float_t maxiSample::playUntilAtSpeed(maxi_float_t end, maxi_float_t speed)
 maxi_float_t maxiSample::playAtSpeed(maxi_float_t speed) {
 	maxi_float_t remainder;
 	long a,b;
-	position=position+((speed*chandiv)/(maxiSettings::sampleRate/mySampleRate));
+	position=position+(speed*chandiv*mySampleRate*ctx->invSampleRate);
 	if (speed >=0) {
 
 		if ((long) position>=amplitudes.size()-1) position=1;
@@ -1233,11 +1238,11 @@ maxi_float_t maxiDyn::compress(maxi_float_t input) {
 }
 
 void maxiDyn::setAttack(maxi_float_t attackMS) {
-	attack = pow( 0.01f, 1.0f / ( attackMS * maxiSettings::sampleRate * 0.001f ) );
+	attack = pow( 0.01f, 1.0f / ( attackMS * ctx->sampleRate * 0.001f ) );
 }
 
 void maxiDyn::setRelease(maxi_float_t releaseMS) {
-	release = pow( 0.01f, 1.0f / ( releaseMS * maxiSettings::sampleRate * 0.001f ) );
+	release = pow( 0.01f, 1.0f / ( releaseMS * ctx->sampleRate * 0.001f ) );
 }
 
 void maxiDyn::setThreshold(maxi_float_t thresholdI) {
@@ -1402,11 +1407,11 @@ maxi_float_t maxiEnv::adsr(maxi_float_t input, int trigger) {
 
 
 void maxiEnv::setAttack(maxi_float_t attackMS) {
-	attack = 1-pow( 0.01f, 1.0f / ( attackMS * maxiSettings::sampleRate * 0.001f ) );
+	attack = 1-pow( 0.01f, 1.0f / ( attackMS * ctx->sampleRate * 0.001f ) );
 }
 
 void maxiEnv::setRelease(maxi_float_t releaseMS) {
-	release = pow( 0.01f, 1.0f / ( releaseMS * maxiSettings::sampleRate * 0.001f ) );
+	release = pow( 0.01f, 1.0f / ( releaseMS * ctx->sampleRate * 0.001f ) );
 }
 
 void maxiEnv::setSustain(maxi_float_t sustainL) {
@@ -1414,7 +1419,7 @@ void maxiEnv::setSustain(maxi_float_t sustainL) {
 }
 
 void maxiEnv::setDecay(maxi_float_t decayMS) {
-	decay = pow( 0.01f, 1.0f / ( decayMS * maxiSettings::sampleRate * 0.001f ) );
+	decay = pow( 0.01f, 1.0f / ( decayMS * ctx->sampleRate * 0.001f ) );
 }
 
 
@@ -1425,11 +1430,11 @@ maxi_float_t convert::mtof(int midinote) {
 
 
 template<> void maxiEnvelopeFollower::setAttack(maxi_float_t attackMS) {
-	attack = pow( 0.01f, 1.0f / ( attackMS * maxiSettings::sampleRate * 0.001f ) );
+	attack = pow( 0.01f, 1.0f / ( attackMS * ctx->sampleRate * 0.001f ) );
 }
 
 template<> void maxiEnvelopeFollower::setRelease(maxi_float_t releaseMS) {
-	release = pow( 0.01f, 1.0f / ( releaseMS * maxiSettings::sampleRate * 0.001f ) );
+	release = pow( 0.01f, 1.0f / ( releaseMS * ctx->sampleRate * 0.001f ) );
 }
 
 
@@ -769,6 +769,7 @@ EMSCRIPTEN_BINDINGS(maxiSpectral) {
 	  enum_<maxiFFT::fftModes>("maxiFFTModes")
 		.value("WITH_POLAR_CONVERSION", maxiFFT::fftModes::WITH_POLAR_CONVERSION)
 	    .value("NO_POLAR_CONVERSION", maxiFFT::fftModes::NO_POLAR_CONVERSION)
+	    .value("MAGNITUDE_ONLY", maxiFFT::fftModes::MAGNITUDE_ONLY)
 	    ;
 
 
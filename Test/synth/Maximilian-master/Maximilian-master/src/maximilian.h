@@ -100,6 +100,34 @@ inline vector<maxi_float_t> convertArrayFromJS(maxi_number_tARRAY_REF x)
 
 const maxi_float_t pitchRatios[256] = {0.0006517771980725, 0.0006905338959768, 0.0007315951515920, 0.0007750981021672, 0.0008211878011934, 0.0008700182079338, 0.0009217521874234, 0.0009765623835847, 0.0010346318595111, 0.0010961542138830, 0.0011613349197432, 0.0012303915573284, 0.0013035543961450, 0.0013810677919537, 0.0014631903031841, 0.0015501962043345, 0.0016423756023869, 0.0017400364158675, 0.0018435043748468, 0.0019531247671694, 0.0020692637190223, 0.0021923084277660, 0.0023226698394865, 0.0024607831146568, 0.0026071087922901, 0.0027621355839074, 0.0029263808391988, 0.0031003924086690, 0.0032847514376044, 0.0034800728317350, 0.0036870087496936, 0.0039062497671694, 0.0041385274380445, 0.0043846168555319, 0.0046453396789730, 0.0049215662293136, 0.0052142175845802, 0.0055242711678147, 0.0058527616783977, 0.0062007848173380, 0.0065695028752089, 0.0069601456634700, 0.0073740174993873, 0.0078124995343387, 0.0082770548760891, 0.0087692337110639, 0.0092906802892685, 0.0098431324586272, 0.0104284351691604, 0.0110485423356295, 0.0117055233567953, 0.0124015696346760, 0.0131390057504177, 0.0139202913269401, 0.0147480349987745, 0.0156249990686774, 0.0165541097521782, 0.0175384692847729, 0.0185813605785370, 0.0196862649172544, 0.0208568722009659, 0.0220970865339041, 0.0234110467135906, 0.0248031392693520, 0.0262780115008354, 0.0278405826538801, 0.0294960699975491, 0.0312499981373549, 0.0331082195043564, 0.0350769385695457, 0.0371627211570740, 0.0393725298345089, 0.0417137444019318, 0.0441941730678082, 0.0468220934271812, 0.0496062822639942, 0.0525560230016708, 0.0556811690330505, 0.0589921437203884, 0.0624999962747097, 0.0662164390087128, 0.0701538771390915, 0.0743254423141479, 0.0787450596690178, 0.0834274888038635, 0.0883883461356163, 0.0936441868543625, 0.0992125645279884, 0.1051120460033417, 0.1113623380661011, 0.1179842874407768, 0.1249999925494194, 0.1324328780174255, 0.1403077542781830, 0.1486508846282959, 0.1574901193380356, 0.1668549776077271, 0.1767766922712326, 0.1872883737087250, 0.1984251290559769, 0.2102240920066833, 0.2227246761322021, 0.2359685748815536, 0.2500000000000000, 0.2648657560348511, 0.2806155085563660, 0.2973017692565918, 0.3149802684783936, 0.3337099552154541, 0.3535533845424652, 0.3745767772197723, 0.3968502581119537, 0.4204482138156891, 0.4454493522644043, 0.4719371497631073, 0.5000000000000000, 0.5297315716743469, 0.5612310171127319, 0.5946035385131836, 0.6299605369567871, 0.6674199104309082, 0.7071067690849304, 0.7491535544395447, 0.7937005162239075, 0.8408964276313782, 0.8908987045288086, 0.9438742995262146, 1.0000000000000000, 1.0594631433486938, 1.1224620342254639, 1.1892070770263672, 1.2599210739135742, 1.3348398208618164, 1.4142135381698608, 1.4983071088790894, 1.5874010324478149, 1.6817928552627563, 1.7817974090576172, 1.8877485990524292, 2.0000000000000000, 2.1189262866973877, 2.2449240684509277, 2.3784141540527344, 2.5198421478271484, 2.6696796417236328, 2.8284270763397217, 2.9966142177581787, 3.1748020648956299, 3.3635857105255127, 3.5635950565338135, 3.7754974365234375, 4.0000000000000000, 4.2378525733947754, 4.4898481369018555, 4.7568287849426270, 5.0396842956542969, 5.3393597602844238, 5.6568546295166016, 5.9932284355163574, 6.3496046066284180, 6.7271714210510254, 7.1271901130676270, 7.5509948730468750, 8.0000000000000000, 8.4757051467895508, 8.9796962738037109, 9.5136575698852539, 10.0793685913085938, 10.6787195205688477, 11.3137092590332031, 11.9864568710327148, 12.6992092132568359, 13.4543428421020508, 14.2543802261352539, 15.1019897460937500, 16.0000000000000000, 16.9514102935791016, 17.9593944549560547, 19.0273151397705078, 20.1587371826171875, 21.3574390411376953, 22.6274185180664062, 23.9729137420654297, 25.3984184265136719, 26.9086875915527344, 28.5087604522705078, 30.2039794921875000, 32.0000000000000000, 33.9028205871582031, 35.9187889099121094, 38.0546302795410156, 40.3174743652343750, 42.7148780822753906, 45.2548370361328125, 47.9458274841308594, 50.7968368530273438, 53.8173751831054688, 57.0175209045410156, 60.4079589843750000, 64.0000076293945312, 67.8056411743164062, 71.8375778198242188, 76.1092605590820312, 80.6349563598632812, 85.4297561645507812, 90.5096740722656250, 95.8916625976562500, 101.5936737060546875, 107.6347503662109375, 114.0350418090820312, 120.8159179687500000, 128.0000152587890625, 135.6112823486328125, 143.6751556396484375, 152.2185211181640625, 161.2699127197265625, 170.8595123291015625, 181.0193481445312500, 191.7833251953125000, 203.1873474121093750, 215.2695007324218750, 228.0700836181640625, 241.6318511962890625, 256.0000305175781250, 271.2225646972656250, 287.3503112792968750, 304.4370422363281250, 322.5398254394531250, 341.7190246582031250, 362.0386962890625000, 383.5666503906250000, 406.3746948242187500, 430.5390014648437500, 456.1401977539062500, 483.2637023925781250, 512.0000610351562500, 542.4451293945312500, 574.7006225585937500, 608.8740844726562500, 645.0796508789062500, 683.4380493164062500, 724.0773925781250000, 767.1333007812500000, 812.7494506835937500, 861.0780029296875000, 912.2803955078125000, 966.5274047851562500, 1024.0001220703125000, 1084.8903808593750000, 1149.4012451171875000, 1217.7481689453125000, 1290.1593017578125000, 1366.8762207031250000, 1448.1549072265625000, 1534.2666015625000000, 1625.4989013671875000};
 
+// Sample rate of a set of unit generators, with its reciprocal precomputed so
+// the per sample code multiplies instead of dividing. Unit generators use
+// maxiContext::global() (which follows maxiSettings::setup()) until they are
+// bound to another context with setContext(): this lets engines at different
+// rates run side by side (e.g. a live engine and an offline bounce) and on
+// separate threads without touching the global settings.
+class maxiContext
+{
+public:
+    maxiContext(int initSampleRate = 44100)
+    {
+        setSampleRate(initSampleRate);
+    }
+    void setSampleRate(int rate)
+    {
+        sampleRate = rate;
+        invSampleRate = 1.0f / rate;
+    }
+    int getSampleRate() const
+    {
+        return (int)sampleRate;
+    }
+    maxi_float_t sampleRate;
+    maxi_float_t invSampleRate;
+
+    static maxiContext &global();
+};
+
 class CHEERP_EXPORT maxiSettings
 {
 public:
@@ -112,6 +140,7 @@ public:
         maxiSettings::sampleRate = initSampleRate;
         maxiSettings::channels = initChannels;
         maxiSettings::bufferSize = initBufferSize;
+        maxiContext::global().setSampleRate(initSampleRate);
     }
     //
     // static void setSampleRate(int sampleRate_){
@@ -140,7 +169,24 @@ public:
     // }
 };
 
-class CHEERP_EXPORT maxiOsc
+// Base of the unit generators which depend on the sample rate
+class maxiContextual
+{
+public:
+    void setContext(const maxiContext &context)
+    {
+        ctx = &context;
+    }
+    const maxiContext &getContext() const
+    {
+        return *ctx;
+    }
+
+protected:
+    const maxiContext *ctx = &maxiContext::global();
+};
+
+class CHEERP_EXPORT maxiOsc : public maxiContextual
 {
 
     maxi_float_t frequency;
@@ -169,7 +215,7 @@ public:
     void phaseReset(maxi_float_t phaseIn);
 };
 
-class maxiEnvelope
+class maxiEnvelope : public maxiContextual
 {
 
     maxi_float_t period;
@@ -232,7 +278,7 @@ public:
     void setupMemory();
 };
 
-class CHEERP_EXPORT maxiFilter
+class CHEERP_EXPORT maxiFilter : public maxiContextual
 {
 private:
     maxi_float_t gain;
@@ -465,7 +511,7 @@ private:
 
 #endif
 
-class CHEERP_EXPORT maxiSample
+class CHEERP_EXPORT maxiSample : public maxiContextual
 {
 
 private:
@@ -497,7 +543,7 @@ public:
         position = 0;
         recordPosition = 0;
         myChannels = source.myChannels;
-        mySampleRate = maxiSettings::sampleRate;
+        mySampleRate = ctx->sampleRate;
         F64_ARRAY_SETFROM(amplitudes,source.amplitudes);
         return *this;
     }
@@ -648,7 +694,7 @@ public:
     }
 };
 
-class maxiDyn
+class maxiDyn : public maxiContextual
 {
 
 public:
@@ -688,7 +734,7 @@ public:
     // ------------------------------------------------
 };
 
-class maxiEnv
+class maxiEnv : public maxiContextual
 {
 
 public:
@@ -913,7 +959,7 @@ inline maxi_float_t maxiChorus::chorus(const maxi_float_t input, const unsigned
 }
 
 template <typename T>
-class maxiEnvelopeFollowerType
+class maxiEnvelopeFollowerType : public maxiContextual
 {
 public:
     maxiEnvelopeFollowerType()
@@ -924,11 +970,11 @@ public:
     }
     void setAttack(T attackMS)
     {
-        attack = pow(0.01f, 1.0f / (attackMS * maxiSettings::sampleRate * 0.001));
+        attack = pow(0.01f, 1.0f / (attackMS * ctx->sampleRate * 0.001));
     }
     void setRelease(T releaseMS)
     {
-        release = pow(0.01f, 1.0f / (releaseMS * maxiSettings::sampleRate * 0.001));
+        release = pow(0.01f, 1.0f / (releaseMS * ctx->sampleRate * 0.001));
     }
     inline T play(T input)
     {
@@ -980,7 +1026,7 @@ public:
  w = filter.setCutoff(param1).setResonance(param2).play(w, 0.0, 1.0, 0.0, 0.0f);
 
  */
-class maxiSVF
+class maxiSVF : public maxiContextual
 {
 public:
     maxiSVF() : v0z(0), v1(0), v2(0) { setParams(1000, 1); }
@@ -1019,7 +1065,7 @@ private:
     {
         freq = _freq;
         res = _res;
-        g = tan(PI * freq / maxiSettings::sampleRate);
+        g = tan(PI * freq * ctx->invSampleRate);
         damping = res == 0 ? 0 : 1.0f / res;
         k = damping;
         ginv = g / (1.0f + g * (g + k));
@@ -1034,7 +1080,7 @@ private:
 };
 
 //based on http://www.earlevel.com/main/2011/01/02/biquad-formulas/ and https://ccrma.stanford.edu/~jos/fp/Direct_Form_II.html
-class CHEERP_EXPORT maxiBiquad
+class CHEERP_EXPORT maxiBiquad : public maxiContextual
 {
 public:
     maxiBiquad();
@@ -1060,7 +1106,7 @@ public:
     {
         maxi_float_t norm = 0;
         maxi_float_t V = pow(10.0f, abs(peakGain) / 20.0f);
-        maxi_float_t K = tan(PI * cutoff / maxiSettings::sampleRate);
+        maxi_float_t K = tan(PI * cutoff * ctx->invSampleRate);
         switch (filtType)
         {
         case LOWPASS:
@@ -1194,7 +1240,7 @@ public:
     }
 };
 
-class maxiLine
+class maxiLine : public maxiContextual
 {
 public:
     maxiLine() {}
@@ -1236,7 +1282,7 @@ public:
         lineStart = start;
         lineEnd = end;
         maxi_float_t lineMag = end - start;
-        maxi_float_t durInSamples = durationMs / 1000.0f * maxiSettings::sampleRate;
+        maxi_float_t durInSamples = durationMs / 1000.0f * ctx->sampleRate;
         inc = lineMag / durInSamples;
         oneShot = isOneShot;
         reset();
@@ -1646,7 +1692,7 @@ private:
     maxi_float_t value = 0;
 };
 
-class CHEERP_EXPORT maxiRatioSeq
+class CHEERP_EXPORT maxiRatioSeq : public maxiContextual
 {
 public:
     maxiRatioSeq();
@@ -1668,7 +1714,7 @@ public:
             if (prevPhase > phase)
             {
                 //wrapping point
-                prevPhase = -1.0f / maxiSettings::sampleRate;
+                prevPhase = -ctx->invSampleRate;
             }
             if ((prevPhase <= normalisedTime && phase > normalisedTime))
             {
@@ -33,6 +33,15 @@ class FFTDriverESP32FFT : public FFTDriver {
             p_fft_object->input[idx]  = value; 
         }
 
+        void setValues(const float* values, int n, const float* window = nullptr) override {
+            float* x = p_fft_object->input;
+            if (window == nullptr) {
+                memcpy(x, values, n * sizeof(float));
+            } else {
+                for (int j = 0; j < n; j++) x[j] = values[j] * window[j];
+            }
+        }
+
         void fft() override{
             fft_execute(p_fft_object);
         };
@@ -50,6 +59,17 @@ class FFTDriverESP32FFT : public FFTDriver {
             return (pow(p_fft_object->output[2*idx],2) + pow(p_fft_object->output[2*idx+1],2));
         }
 
+        void magnitudes(float* out, int n) override {
+            magnitudesFast(out, n);
+            for (int j = 0; j < n; j++) out[j] = sqrt(out[j]);
+        }
+
+        /// output holds interleaved real/imaginary pairs
+        void magnitudesFast(float* out, int n) override {
+            const float* v = p_fft_object->output;
+            for (int j = 0; j < n; j++) out[j] = (v[2*j] * v[2*j]) + (v[2*j+1] * v[2*j+1]);
+        }
+
         float getValue(int idx) { return p_fft_object->input[idx];}
 
         bool setBin(int pos, float real, float img) override {
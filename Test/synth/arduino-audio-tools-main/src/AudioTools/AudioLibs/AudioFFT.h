@@ -159,12 +159,30 @@ class FFTDriver {
   virtual void end() = 0;
   /// Sets the real value
   virtual void setValue(int pos, float value) = 0;
+  /// Sets the first n real values in one call. If a window is provided the
+  /// values are multiplied by window[pos] while they are loaded.
+  virtual void setValues(const float *values, int n,
+                         const float *window = nullptr) {
+    if (window == nullptr) {
+      for (int j = 0; j < n; j++) setValue(j, values[j]);
+    } else {
+      for (int j = 0; j < n; j++) setValue(j, values[j] * window[j]);
+    }
+  }
   /// Perform FFT
   virtual void fft() = 0;
   /// Calculate the magnitude (fft result) at index (sqr(i² + r²))
   virtual float magnitude(int idx) = 0;
   /// Calculate the magnitude w/o sqare root
   virtual float magnitudeFast(int idx) = 0;
+  /// Calculates the magnitudes of the first n bins in one pass
+  virtual void magnitudes(float *out, int n) {
+    for (int j = 0; j < n; j++) out[j] = magnitude(j);
+  }
+  /// Calculates the magnitudes w/o square root of the first n bins in one pass
+  virtual void magnitudesFast(float *out, int n) {
+    for (int j = 0; j < n; j++) out[j] = magnitudeFast(j);
+  }
   virtual bool isValid() = 0;
   /// Returns true if reverse FFT is supported
   virtual bool isReverseFFT() { return false; }
@@ -240,6 +258,8 @@ class AudioFFTBase : public AudioStream {
     if (cfg.rxtx_mode == TX_MODE || cfg.rxtx_mode == RXTX_MODE) {
       // holds last N bytes that need to be reprocessed
       stride_buffer.resize((cfg.length) * bytesPerSample());
+      l_input.resize(cfg.length);
+      setupInputWindow();
       is_valid_rxtx = true;
     }
     if (cfg.rxtx_mode == RX_MODE || cfg.rxtx_mode == RXTX_MODE) {
@@ -267,6 +287,7 @@ class AudioFFTBase : public AudioStream {
     if (cfg.window_function_ifft != nullptr) {
       cfg.window_function_ifft->begin(cfg.length);
     }
+    if (l_window.size() > 0) setupInputWindow();
   }
 
   operator bool() override {
@@ -285,6 +306,8 @@ class AudioFFTBase : public AudioStream {
   void end() override {
     p_driver->end();
     l_magnitudes.resize(0);
+    l_input.resize(0);
+    l_window.resize(0);
     rfft_data.resize(0);
     rfft_add.resize(0);
     step_data.resize(0);
@@ -596,24 +619,26 @@ class AudioFFTBase : public AudioStream {
     if (l_magnitudes.size() == 0) {
       l_magnitudes.resize(size());
     }
-    for (int j = 0; j < size(); j++) {
-      l_magnitudes[j] = magnitude(j);
-    }
+    magnitudes(l_magnitudes.data());
     return l_magnitudes.data();
   }
 
+  /// Calculates all size() magnitudes into the provided array in one pass
+  void magnitudes(float *out) { p_driver->magnitudes(out, size()); }
+
   /// Provides the magnitudes w/o calling the square root function as array of
   /// size size(). Please note that this method is allocating additinal memory!
   float *magnitudesFast() {
     if (l_magnitudes.size() == 0) {
       l_magnitudes.resize(size());
     }
-    for (int j = 0; j < size(); j++) {
-      l_magnitudes[j] = magnitudeFast(j);
-    }
+    magnitudesFast(l_magnitudes.data());
     return l_magnitudes.data();
   }
 
+  /// Calculates all size() magnitudes w/o square root into the provided array
+  void magnitudesFast(float *out) { p_driver->magnitudesFast(out, size()); }
+
   /// sets the value of a bin
   bool setBin(int idx, float real, float img) {
     has_rfft_data = true;
@@ -653,6 +678,8 @@ class AudioFFTBase : public AudioStream {
   AudioFFTConfig cfg;
   FFTInverseOverlapAdder rfft_add{0};
   Vector<float> l_magnitudes{0};
+  Vector<float> l_input{0};
+  Vector<float> l_window{0};
   Vector<float> step_data{0};
   Vector<float> mel_bins{0};
   SingleBuffer<uint8_t> stride_buffer{0};
@@ -671,13 +698,13 @@ class AudioFFTBase : public AudioStream {
         T *samples = (T *)stride_buffer.data();
         int sample_count = stride_buffer.size() / sizeof(T);
         assert(sample_count == cfg.length);
+        // convert, scale and window in one pass, then hand over the block
+        float *input = l_input.data();
+        const float *window = l_window.data();
         for (int j = 0; j < sample_count; j++) {
-          T out_sample = samples[j];
-          T windowed_sample = windowedSample(out_sample, j);
-          float scaled_sample =
-              1.0f / NumberConverter::maxValueT<T>() * windowed_sample;
-          p_driver->setValue(j, scaled_sample);
+          input[j] = static_cast<float>(samples[j]) * window[j];
         }
+        p_driver->setValues(input, sample_count);
 
         fft<T>();
 
@@ -690,13 +717,15 @@ class AudioFFTBase : public AudioStream {
     }
   }
 
-  template <typename T>
-  T windowedSample(T sample, int pos) {
-    T result = sample;
-    if (cfg.window_function_fft != nullptr) {
-      result = cfg.window_function_fft->factor(pos) * sample;
+  /// Precalculates the fft window multiplied by the sample scaling factor
+  void setupInputWindow() {
+    l_window.resize(cfg.length);
+    float scale = 1.0f / NumberConverter::maxValue(cfg.bits_per_sample);
+    for (int j = 0; j < cfg.length; j++) {
+      l_window[j] = cfg.window_function_fft != nullptr
+                        ? cfg.window_function_fft->factor(j) * scale
+                        : scale;
     }
-    return result;
   }
 
   template <typename T>
@@ -39,6 +39,15 @@ class FFTDriverRealFFT : public FFTDriver {
             v_x[idx] = value; 
         }
 
+        void setValues(const float* values, int n, const float* window = nullptr) override {
+            float* x = v_x.data();
+            if (window == nullptr) {
+                memcpy(x, values, n * sizeof(float));
+            } else {
+                for (int j = 0; j < n; j++) x[j] = values[j] * window[j];
+            }
+        }
+
         void fft() override{
             memset(v_f.data(),0,len*sizeof(float));
             p_fft_object->do_fft(v_f.data(), v_x.data());    
@@ -56,9 +65,27 @@ class FFTDriverRealFFT : public FFTDriver {
             return sqrt(magnitudeFast(idx));
         }
 
-        /// magnitude w/o sqrt
+        /// magnitude w/o sqrt: do_fft() packs the real parts into v_f[0..len/2]
+        /// and the imaginary parts of bins 1..len/2-1 into v_f[len/2+1..]
         float magnitudeFast(int idx) override {
-            return ((v_x[idx] * v_x[idx]) + (v_f[idx] * v_f[idx]));
+            int half = len / 2;
+            float re = v_f[idx];
+            float im = (idx > 0 && idx < half) ? v_f[half + idx] : 0.0f;
+            return (re * re) + (im * im);
+        }
+
+        void magnitudes(float* out, int n) override {
+            magnitudesFast(out, n);
+            for (int j = 0; j < n; j++) out[j] = sqrt(out[j]);
+        }
+
+        void magnitudesFast(float* out, int n) override {
+            int half = len / 2;
+            if (n > half) n = half;
+            const float* re = v_f.data();
+            const float* im = re + half;
+            out[0] = re[0] * re[0];
+            for (int j = 1; j < n; j++) out[j] = (re[j] * re[j]) + (im[j] * im[j]);
         }
 
         bool isValid() override{ return p_fft_object!=nullptr; }
@@ -31,9 +31,20 @@ class Maximilian : public VolumeSupport {
         void begin(AudioInfo cfg){
             this->cfg = cfg;
             buffer.resize(buffer_size);
-            maxiSettings::setup(cfg.sample_rate, cfg.channels, DEFAULT_BUFFER_SIZE);
+            maxi_context.setSampleRate(cfg.sample_rate);
+            if (update_global_settings)
+                maxiSettings::setup(cfg.sample_rate, cfg.channels, DEFAULT_BUFFER_SIZE);
         }
 
+        /// Sample rate context of this instance: bind the unit generators with
+        /// setContext() to keep them independent of other instances
+        maxiContext &context() { return maxi_context; }
+
+        /// By default begin() also updates the global maxiSettings, which all
+        /// unit generators without their own context use. Deactivate this when
+        /// several instances run at different sample rates.
+        void setUpdateGlobalSettings(bool flag) { update_global_settings = flag; }
+
         /// Defines the volume. The values are between 0.0 and 1.0
         bool setVolume(float f) override{
             if (f>1.0f){
@@ -71,6 +82,8 @@ class Maximilian : public VolumeSupport {
         int buffer_size=256;
         Print *p_sink=nullptr;
         AudioInfo cfg;
+        maxiContext maxi_context;
+        bool update_global_settings = true;
         void (*callback)(maxi_float_t *channels);
 };
 
@@ -0,0 +1,94 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "AudioTools/CoreAudio/AudioBasic/Collections/Vector.h"
+
+namespace audio_tools {
+
+/**
+ * @brief Lock-free double buffer which publishes the latest array of values
+ * from a single writer to readers on other tasks or cores (e.g. an fft
+ * spectrum which is drawn on a display).
+ *
+ * The writer fills writeBuffer() and calls publish(), which makes it the
+ * front buffer; it never blocks. read() copies the front buffer and retries
+ * when a publish() happened during the copy, so a reader never sees a
+ * partially written array. Intermediate arrays are dropped if the reader is
+ * slower than the writer.
+ * @ingroup concurrency
+ * @author Phil Schatzmann
+ * @copyright GPLv3
+ * @tparam T
+ */
+template <typename T>
+class DoubleBufferLockFree {
+ public:
+  DoubleBufferLockFree(int size = 0) {
+    if (size > 0) resize(size);
+  }
+
+  /// Defines the number of values per array: not thread safe!
+  void resize(int size) {
+    buffer[0].resize(size);
+    buffer[1].resize(size);
+    clear();
+  }
+
+  /// Sets both arrays to 0 and forgets published data: not thread safe!
+  void clear() {
+    for (int j = 0; j < 2; j++) {
+      memset(buffer[j].data(), 0, buffer[j].size() * sizeof(T));
+    }
+    front.store(0, std::memory_order_relaxed);
+    sequence_no.store(0, std::memory_order_relaxed);
+  }
+
+  /// Number of values per array
+  int size() { return buffer[0].size(); }
+
+  /// Writer: array which will be published by the next publish()
+  T *writeBuffer() {
+    return buffer[1 - front.load(std::memory_order_relaxed)].data();
+  }
+
+  /// Writer: makes the write buffer visible to the readers
+  void publish() {
+    int next = 1 - front.load(std::memory_order_relaxed);
+    front.store(next, std::memory_order_release);
+    sequence_no.fetch_add(1, std::memory_order_relaxed);
+    // the next writes go to the old front: order them after the increment
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /// Number of published arrays: readers can poll this to detect new data
+  uint32_t sequence() { return sequence_no.load(std::memory_order_acquire); }
+
+  /// Reader: copies up to n values of the latest published array. Returns
+  /// false if nothing was published yet or if the writer did not let us
+  /// complete a consistent copy.
+  bool read(T *out, int n, uint32_t *p_sequence = nullptr, int retries = 4) {
+    if (n > size()) n = size();
+    for (int j = 0; j < retries; j++) {
+      uint32_t seq = sequence_no.load(std::memory_order_acquire);
+      if (seq == 0) return false;
+      int idx = front.load(std::memory_order_acquire);
+      memcpy(out, buffer[idx].data(), n * sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_no.load(std::memory_order_relaxed) == seq) {
+        if (p_sequence != nullptr) *p_sequence = seq;
+        return true;
+      }
+    }
+    return false;
+  }
+
+ protected:
+  Vector<T> buffer[2];
+  std::atomic<int> front{0};
+  std::atomic<uint32_t> sequence_no{0};
+};
+
+}  // namespace audio_tools
@@ -0,0 +1,254 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "AudioTools/CoreAudio/AudioBasic/Collections/Vector.h"
+#include "AudioTools/CoreAudio/Buffers.h"
+#include "AudioTools/Concurrency/TaskNotifier.h"
+
+#ifndef LOCK_FREE_CACHE_LINE
+#define LOCK_FREE_CACHE_LINE 64
+#endif
+
+namespace audio_tools {
+
+/**
+ * @brief Lock-free single producer / single consumer ring buffer for audio
+ * data between two tasks or cores (e.g. the audio task and a recorder,
+ * network or scope task). A replacement for a SynchronizedBuffer when there
+ * is exactly one writer and one reader: no mutex, no per entry copy.
+ *
+ * The read and write positions are free running counters in separate cache
+ * lines; each side only stores its own position and caches the other one.
+ * The storage is a power of two, so at most two memcpy calls are needed.
+ *
+ * Besides the BaseBuffer API it offers a zero-copy span API: acquireWrite()
+ * / commitWrite() for the producer and acquireRead() / commitRead() for the
+ * consumer. Each returns at most the contiguous region up to the wrap around,
+ * so call it again for the rest.
+ *
+ * By default nothing blocks. With setReadMaxWait() / setWriteMaxWait() the
+ * readArray() and writeArray() calls wait up to the indicated ms for data or
+ * space, using FreeRTOS task notifications (or a condition variable on the
+ * desktop). Don't set any wait on the real-time side.
+ * @ingroup buffers
+ * @ingroup concurrency
+ * @author Phil Schatzmann
+ * @copyright GPLv3
+ * @tparam T
+ */
+template <typename T>
+class RingBufferLockFree : public BaseBuffer<T> {
+ public:
+  RingBufferLockFree(int size = 0) {
+    if (size > 0) resize(size);
+  }
+
+  /// Defines the capacity (rounded up to the next power of two): not thread
+  /// safe!
+  bool resize(int size) override {
+    capacity = 1;
+    while (capacity < (uint32_t)size) capacity <<= 1;
+    buffer.resize(capacity);
+    mask = capacity - 1;
+    reset();
+    return true;
+  }
+
+  /// Forgets all data: not thread safe!
+  void reset() override {
+    write_pos.store(0, std::memory_order_relaxed);
+    read_pos.store(0, std::memory_order_relaxed);
+    cached_read_pos = 0;
+    cached_write_pos = 0;
+  }
+
+  /// Defines the max ms readArray() waits for data (default 0)
+  void setReadMaxWait(uint32_t ms) { read_max_wait = ms; }
+
+  /// Defines the max ms writeArray() waits for space (default 0)
+  void setWriteMaxWait(uint32_t ms) { write_max_wait = ms; }
+
+  // ---- producer ----
+
+  /// Provides the contiguous free region: len is set to its number of entries
+  T *acquireWrite(int &len) {
+    uint32_t w = write_pos.load(std::memory_order_relaxed);
+    uint32_t free_entries = capacity - (w - cached_read_pos);
+    if (free_entries == 0) {
+      cached_read_pos = read_pos.load(std::memory_order_acquire);
+      free_entries = capacity - (w - cached_read_pos);
+    }
+    uint32_t pos = w & mask;
+    uint32_t to_end = capacity - pos;
+    len = free_entries < to_end ? free_entries : to_end;
+    return len > 0 ? buffer.data() + pos : nullptr;
+  }
+
+  /// Publishes n entries which were filled via acquireWrite()
+  void commitWrite(int n) {
+    if (n <= 0) return;
+    write_pos.store(write_pos.load(std::memory_order_relaxed) + n,
+                    std::memory_order_release);
+    // pairs with the fence in waitForData()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (reader_waiting.load(std::memory_order_relaxed)) read_notify.notify();
+  }
+
+  bool write(T data) override { return writeArray(&data, 1) == 1; }
+
+  /// Copies the data with at most two memcpy (waits for space if defined by
+  /// setWriteMaxWait())
+  int writeArray(const T data[], int len) override {
+    int result = 0;
+    unsigned long timeout = write_max_wait > 0 ? millis() + write_max_wait : 0;
+    while (result < len) {
+      int open = 0;
+      T *dst = acquireWrite(open);
+      if (open <= 0) {
+        if (write_max_wait == 0 || !waitForSpace(timeout)) break;
+        continue;
+      }
+      int n = min(open, len - result);
+      memcpy(dst, data + result, n * sizeof(T));
+      commitWrite(n);
+      result += n;
+    }
+    return result;
+  }
+
+  /// Number of entries which can be written
+  int availableForWrite() override {
+    return capacity - (write_pos.load(std::memory_order_relaxed) -
+                       read_pos.load(std::memory_order_acquire));
+  }
+
+  // ---- consumer ----
+
+  /// Provides the contiguous region of available data: len is set to its
+  /// number of entries
+  T *acquireRead(int &len) {
+    uint32_t r = read_pos.load(std::memory_order_relaxed);
+    uint32_t filled = cached_write_pos - r;
+    if (filled == 0) {
+      cached_write_pos = write_pos.load(std::memory_order_acquire);
+      filled = cached_write_pos - r;
+    }
+    uint32_t pos = r & mask;
+    uint32_t to_end = capacity - pos;
+    len = filled < to_end ? filled : to_end;
+    return len > 0 ? buffer.data() + pos : nullptr;
+  }
+
+  /// Releases n entries which were processed via acquireRead()
+  void commitRead(int n) {
+    if (n <= 0) return;
+    read_pos.store(read_pos.load(std::memory_order_relaxed) + n,
+                   std::memory_order_release);
+    // pairs with the fence in waitForSpace()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (writer_waiting.load(std::memory_order_relaxed)) write_notify.notify();
+  }
+
+  bool read(T &result) override { return readArray(&result, 1) == 1; }
+
+  bool peek(T &result) override {
+    int len = 0;
+    T *src = acquireRead(len);
+    if (len == 0) return false;
+    result = *src;
+    return true;
+  }
+
+  /// Copies the data with at most two memcpy (waits for data if defined by
+  /// setReadMaxWait())
+  int readArray(T data[], int len) override {
+    if (data == nullptr) {
+      LOGE("NPE");
+      return 0;
+    }
+    int result = 0;
+    unsigned long timeout = read_max_wait > 0 ? millis() + read_max_wait : 0;
+    while (result < len) {
+      int open = 0;
+      T *src = acquireRead(open);
+      if (open <= 0) {
+        // return what we have: only wait if we got nothing yet
+        if (result > 0 || read_max_wait == 0 || !waitForData(timeout)) break;
+        continue;
+      }
+      int n = min(open, len - result);
+      memcpy(data + result, src, n * sizeof(T));
+      commitRead(n);
+      result += n;
+    }
+    return result;
+  }
+
+  /// Removes the next len entries
+  int clearArray(int len) override {
+    int result = min(len, available());
+    commitRead(result);
+    return result;
+  }
+
+  /// Number of entries which can be read
+  int available() override {
+    return write_pos.load(std::memory_order_acquire) -
+           read_pos.load(std::memory_order_relaxed);
+  }
+
+  bool isFull() override { return availableForWrite() == 0; }
+
+  T *address() override { return buffer.data(); }
+
+  size_t size() override { return buffer.size(); }
+
+ protected:
+  Vector<T> buffer;
+  uint32_t capacity = 0;
+  uint32_t mask = 0;
+  uint32_t read_max_wait = 0;
+  uint32_t write_max_wait = 0;
+  // producer side
+  alignas(LOCK_FREE_CACHE_LINE) std::atomic<uint32_t> write_pos{0};
+  uint32_t cached_read_pos = 0;
+  std::atomic<bool> writer_waiting{false};
+  TaskNotifier write_notify;
+  // consumer side
+  alignas(LOCK_FREE_CACHE_LINE) std::atomic<uint32_t> read_pos{0};
+  uint32_t cached_write_pos = 0;
+  std::atomic<bool> reader_waiting{false};
+  TaskNotifier read_notify;
+
+  bool waitForData(unsigned long timeout) {
+    reader_waiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // re-check: the writer might have committed before it saw the flag
+    bool result = available() > 0;
+    long open = (long)(timeout - millis());
+    if (!result && open > 0) {
+      read_notify.wait(open);
+      result = available() > 0;
+    }
+    reader_waiting.store(false, std::memory_order_relaxed);
+    return result;
+  }
+
+  bool waitForSpace(unsigned long timeout) {
+    writer_waiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool result = availableForWrite() > 0;
+    long open = (long)(timeout - millis());
+    if (!result && open > 0) {
+      write_notify.wait(open);
+      result = availableForWrite() > 0;
+    }
+    writer_waiting.store(false, std::memory_order_relaxed);
+    return result;
+  }
+};
+
+}  // namespace audio_tools
@@ -0,0 +1,354 @@
+#pragma once
+#include <atomic>
+#include <functional>
+
+#include "AudioToolsConfig.h"
+#include "AudioTools/CoreAudio/AudioBasic/Collections/Vector.h"
+#include "AudioTools/CoreAudio/AudioLogger.h"
+#include "AudioTools/CoreAudio/AudioTypes.h"
+#include "AudioTools/CoreAudio/BaseConverter.h"
+#include "AudioTools/CoreAudio/BaseStream.h"
+#include "AudioTools/Concurrency/TaskNotifier.h"
+#ifdef USE_CPP_TASK
+#include "AudioTools/Concurrency/Desktop.h"
+#else
+#include "AudioTools/Concurrency/RTOS/Task.h"
+#endif
+
+#ifndef PIPELINE_STACK_SIZE
+#define PIPELINE_STACK_SIZE 4096
+#endif
+
+#ifndef PIPELINE_PRIORITY
+#define PIPELINE_PRIORITY 5
+#endif
+
+namespace audio_tools {
+
+/**
+ * @brief Pipelined alternative to StreamCopy: a reader task fills blocks from
+ * the source while a writer task drains them to the destination, so a slow
+ * read (e.g. network or SD) and a blocking write (e.g. I2S) no longer add up.
+ * The two tasks are connected by a single producer / single consumer lock-free
+ * ring of N blocks.
+ *
+ * Instead of fixed delays both sides wait with a deadline of one block
+ * duration: a reader that finds the ring full sleeps until the writer frees a
+ * block (back-pressure) and a writer that finds it empty sleeps until the
+ * reader delivers one. A writer that misses its deadline counts an underrun
+ * and can write silence; for a live source the reader can drop the block it
+ * could not store by its deadline (counted as overrun), so that the source
+ * keeps being drained in time. An empty source and an output which takes no
+ * data are retried after a quarter block, also as a notifier wait, so that
+ * end() or notifyAvailable() cut the wait short.
+ *
+ * On the desktop (USE_CPP_TASK) the tasks are std::threads.
+ * @ingroup tools
+ * @ingroup concurrency
+ * @author Phil Schatzmann
+ * @copyright GPLv3
+ */
+class StreamCopyPipelined {
+ public:
+  StreamCopyPipelined(int bufferSize = DEFAULT_BUFFER_SIZE,
+                      int bufferCount = 4) {
+    block_size = bufferSize;
+    block_count = bufferCount;
+  }
+
+  StreamCopyPipelined(Print &to, AudioStream &from,
+                      int bufferSize = DEFAULT_BUFFER_SIZE,
+                      int bufferCount = 4)
+      : StreamCopyPipelined(bufferSize, bufferCount) {
+    p_to = &to;
+    p_from = &from;
+    setAudioInfo(from.audioInfo());
+  }
+
+  StreamCopyPipelined(Print &to, Stream &from,
+                      int bufferSize = DEFAULT_BUFFER_SIZE,
+                      int bufferCount = 4)
+      : StreamCopyPipelined(bufferSize, bufferCount) {
+    p_to = &to;
+    p_from = &from;
+  }
+
+  ~StreamCopyPipelined() { end(); }
+
+  /// Defines the block size in bytes and the number of blocks in the ring
+  void resize(int bufferSize, int bufferCount) {
+    block_size = bufferSize;
+    block_count = bufferCount;
+  }
+
+  /// Defines the stack, priority and the cores of the reader and writer task
+  void setTaskConfig(int stackSize, int priority, int readerCore = -1,
+                     int writerCore = -1) {
+    stack_size = stackSize;
+    task_priority = priority;
+    reader_core = readerCore;
+    writer_core = writerCore;
+  }
+
+  /// Used to round the reads to full frames and to determine the deadline
+  void setAudioInfo(AudioInfo info) {
+    frame_size = info.channels * info.bits_per_sample / 8;
+    if (frame_size <= 0) frame_size = 1;
+    int bytes_per_second = info.sample_rate * frame_size;
+    if (bytes_per_second > 0) {
+      block_ms = 1000 * (block_size / frame_size * frame_size) /
+                 bytes_per_second;
+      if (block_ms == 0) block_ms = 1;
+    }
+  }
+
+  /// Defines the deadline in ms explicitly (default: 10 ms or the duration
+  /// of one block as determined by setAudioInfo())
+  void setDeadline(uint32_t ms) { block_ms = ms > 0 ? ms : 1; }
+
+  /// Converter which is applied by the reader task
+  void setConverter(BaseConverter &converter) { p_converter = &converter; }
+
+  /// The reader discards a block which does not fit into the ring by the
+  /// deadline, so that a live source is drained in time (default: false - the
+  /// reader waits)
+  void setDropOnOverrun(bool flag) { drop_on_overrun = flag; }
+
+  /// The writer outputs a block of silence when no data arrives by the deadline
+  void setSilenceOnUnderrun(bool flag) { silence_on_underrun = flag; }
+
+  /// Number of blocks which must be available before the writer starts (again
+  /// after an underrun)
+  void setPrebuffer(int blocks) { prebuffer = blocks; }
+
+  /// Starts the processing with a new output and input stream
+  bool begin(Print &to, AudioStream &from) {
+    setAudioInfo(from.audioInfo());
+    p_from = &from;
+    p_to = &to;
+    return begin();
+  }
+
+  /// Starts the processing with a new output and input stream
+  bool begin(Print &to, Stream &from) {
+    p_from = &from;
+    p_to = &to;
+    return begin();
+  }
+
+  /// (Re)starts the reader and writer task
+  bool begin() {
+    TRACED();
+    end();
+    if (p_from == nullptr || p_to == nullptr) {
+      LOGE("No input or output defined");
+      return false;
+    }
+    if (block_count < 2 || block_size < frame_size) {
+      LOGE("Invalid buffer definition: %d x %d", block_count, block_size);
+      return false;
+    }
+    if (prebuffer > block_count) prebuffer = block_count;
+    data.resize(block_size * block_count);
+    lengths.resize(block_count);
+    if (silence_on_underrun) {
+      silence.resize(block_size);
+      memset(silence.data(), 0, block_size);
+    }
+    if (drop_on_overrun) discard.resize(block_size);
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    writer_started = false;
+    resetStats();
+
+    if (!tasks_created) {
+      reader_task.create("copy-read", stack_size, task_priority, reader_core);
+      writer_task.create("copy-write", stack_size, task_priority, writer_core);
+      tasks_created = true;
+    }
+    reader_parked = false;
+    writer_parked = false;
+    active = true;
+    reader_task.begin(std::bind(&StreamCopyPipelined::readerLoop, this));
+    writer_task.begin(std::bind(&StreamCopyPipelined::writerLoop, this));
+    LOGI("pipeline: %d x %d bytes, deadline %d ms", block_count, block_size,
+         (int)block_ms);
+    return true;
+  }
+
+  /// Stops both tasks after they have completed the current block
+  void end() {
+    if (!active) return;
+    active = false;
+    reader_notify.notify();
+    writer_notify.notify();
+    // give the tasks the chance to leave read()/write() before we suspend them
+    unsigned long start = millis();
+    unsigned long timeout = 4 * block_ms + 100;
+    while (!(reader_parked && writer_parked) && millis() - start < timeout) {
+      delay(1);
+    }
+    reader_task.end();
+    writer_task.end();
+  }
+
+  /// Wakes a reader which waits for an empty source: call from the side that
+  /// fills the source (e.g. a network callback) when new data has arrived
+  void notifyAvailable() { reader_notify.notify(); }
+
+  /// Number of times the writer had no data by the deadline
+  uint32_t underruns() { return underrun_count.load(); }
+
+  /// Number of blocks which were dropped because the ring was still full at
+  /// the reader's deadline (only with setDropOnOverrun())
+  uint32_t overruns() { return overrun_count.load(); }
+
+  /// Number of bytes which were written to the output
+  size_t bytesCopied() { return bytes_copied.load(); }
+
+  /// Number of filled blocks waiting for the writer
+  int bufferedBlocks() {
+    return head.load(std::memory_order_acquire) -
+           tail.load(std::memory_order_acquire);
+  }
+
+  /// Resets the underrun, overrun and byte counters
+  void resetStats() {
+    underrun_count = 0;
+    overrun_count = 0;
+    bytes_copied = 0;
+  }
+
+  /// Returns true if the tasks are running
+  bool isActive() { return active; }
+
+  operator bool() { return active; }
+
+ protected:
+  Stream *p_from = nullptr;
+  Print *p_to = nullptr;
+  BaseConverter *p_converter = nullptr;
+  int block_size = DEFAULT_BUFFER_SIZE;
+  int block_count = 4;
+  int frame_size = 1;
+  uint32_t block_ms = 10;
+  int prebuffer = 1;
+  bool drop_on_overrun = false;
+  bool silence_on_underrun = false;
+  int stack_size = PIPELINE_STACK_SIZE;
+  int task_priority = PIPELINE_PRIORITY;
+  int reader_core = -1;
+  int writer_core = -1;
+
+  // ring: the reader (producer) only advances head, the writer only tail
+  Vector<uint8_t> data;
+  Vector<int> lengths;
+  Vector<uint8_t> silence;
+  Vector<uint8_t> discard;
+  std::atomic<uint32_t> head{0};
+  std::atomic<uint32_t> tail{0};
+  bool writer_started = false;
+
+  Task reader_task;
+  Task writer_task;
+  bool tasks_created = false;
+  TaskNotifier reader_notify;  // writer -> reader: a block was freed
+  TaskNotifier writer_notify;  // reader -> writer: a block was filled
+  std::atomic<bool> active{false};
+  std::atomic<bool> reader_parked{false};
+  std::atomic<bool> writer_parked{false};
+
+  std::atomic<uint32_t> underrun_count{0};
+  std::atomic<uint32_t> overrun_count{0};
+  std::atomic<size_t> bytes_copied{0};
+
+  /// Deadline of a retry on an empty source or a full output
+  uint32_t retryMs() { return block_ms / 4 + 1; }
+
+  bool isFull(uint32_t h) {
+    return h - tail.load(std::memory_order_acquire) >= (uint32_t)block_count;
+  }
+
+  /// Reads one block from the source: returns the (converted) length
+  int readBlock(uint8_t *dst) {
+    int len = p_from->readBytes(dst, block_size / frame_size * frame_size);
+    if (len > 0 && p_converter != nullptr) {
+      len = p_converter->convert(dst, len);
+    }
+    return len;
+  }
+
+  void readerLoop() {
+    if (!active) {
+      reader_parked = true;
+      delay(block_ms);
+      return;
+    }
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (isFull(h)) {
+      // back-pressure: wait for the writer to free a block up to the deadline
+      reader_notify.wait(block_ms);
+      if (!active || !isFull(h) || !drop_on_overrun) return;
+      // keep a live source drained; the writer still owns the ring
+      // blocks, so we can only discard the newest data
+      if (readBlock(discard.data()) > 0) overrun_count++;
+      return;
+    }
+
+    uint8_t *dst = data.data() + (h % block_count) * block_size;
+    int len = readBlock(dst);
+    if (len <= 0) {
+      // no data yet: try again well before the writer's deadline
+      reader_notify.wait(retryMs());
+      return;
+    }
+    lengths[h % block_count] = len;
+    head.store(h + 1, std::memory_order_release);
+    writer_notify.notify();
+  }
+
+  void writerLoop() {
+    if (!active) {
+      writer_parked = true;
+      delay(block_ms);
+      return;
+    }
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t available = head.load(std::memory_order_acquire) - t;
+    if (available == 0 || (!writer_started && available < (uint32_t)prebuffer)) {
+      if (writer_notify.wait(block_ms)) return;
+      // deadline expired
+      if (writer_started && head.load(std::memory_order_acquire) == t) {
+        underrun_count++;
+        writer_started = false;
+        if (silence_on_underrun) writeAll(silence.data(), block_size);
+      }
+      return;
+    }
+    writer_started = true;
+
+    uint8_t *src = data.data() + (t % block_count) * block_size;
+    int len = lengths[t % block_count];
+    writeAll(src, len);
+    tail.store(t + 1, std::memory_order_release);
+    bytes_copied += len;
+    reader_notify.notify();
+  }
+
+  /// Writes the full block: a blocking output (e.g. I2S) paces the writer
+  void writeAll(const uint8_t *src, int len) {
+    int open = len;
+    while (open > 0 && active) {
+      int written = p_to->write(src + len - open, open);
+      if (written <= 0) {
+        // output full: a new block or end() wakes us early, which is harmless
+        // since writerLoop() checks the ring before it waits
+        writer_notify.wait(retryMs());
+        continue;
+      }
+      open -= written;
+    }
+  }
+};
+
+}  // namespace audio_tools
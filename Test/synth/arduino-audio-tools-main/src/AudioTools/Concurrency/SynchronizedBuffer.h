@@ -10,7 +10,8 @@ namespace audio_tools {
 
 /**
  * @brief Wrapper class that can turn any Buffer into a thread save
- * implementation.
+ * implementation. For a single writer and a single reader (e.g. between the
+ * audio task and another core) prefer the lock-free RingBufferLockFree.
  * @ingroup buffers
  * @ingroup concurrency
  * @author Phil Schatzmann
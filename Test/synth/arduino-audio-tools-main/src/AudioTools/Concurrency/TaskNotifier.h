@@ -0,0 +1,80 @@
+#pragma once
+#include <stdint.h>
+
+#include <atomic>
+
+#ifdef USE_CPP_TASK
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#elif defined(ESP32)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+namespace audio_tools {
+
+/**
+ * @brief Lets one task sleep until another task signals progress (or a
+ * timeout expires). Uses FreeRTOS direct task notifications, or a
+ * std::condition_variable on the desktop (USE_CPP_TASK). A notify() which
+ * happens before the wait() is not lost: the next wait() returns at once
+ * (with FreeRTOS also before the first wait(), when no task is bound yet).
+ * Only one task may wait on a notifier.
+ * @ingroup concurrency
+ * @author Phil Schatzmann
+ * @copyright GPLv3
+ */
+class TaskNotifier {
+ public:
+  /// Blocks the calling task until notify() or the timeout: returns true if
+  /// notified
+  bool wait(uint32_t timeoutMs) {
+#ifdef USE_CPP_TASK
+    std::unique_lock<std::mutex> lock(mtx);
+    bool result = cv.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                              [this] { return pending; });
+    pending = false;
+    return result;
+#else
+    waiting_task.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+    // A notify() that found no waiting task yet only left the flag
+    if (pending.exchange(false, std::memory_order_acq_rel)) return true;
+    TickType_t ticks = pdMS_TO_TICKS(timeoutMs);
+    if (ticks == 0 && timeoutMs > 0) ticks = 1;
+    bool notified = ulTaskNotifyTake(pdTRUE, ticks) > 0;
+    // The notification consumed here also set the flag
+    return pending.exchange(false, std::memory_order_acq_rel) || notified;
+#endif
+  }
+
+  /// Wakes up the waiting task
+  void notify() {
+#ifdef USE_CPP_TASK
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      pending = true;
+    }
+    cv.notify_one();
+#else
+    pending.store(true, std::memory_order_release);
+    TaskHandle_t task = waiting_task.load(std::memory_order_acquire);
+    if (task != nullptr) xTaskNotifyGive(task);
+#endif
+  }
+
+ protected:
+#ifdef USE_CPP_TASK
+  std::mutex mtx;
+  std::condition_variable cv;
+  bool pending = false;
+#else
+  std::atomic<TaskHandle_t> waiting_task{nullptr};
+  std::atomic<bool> pending{false};
+#endif
+};
+
+}  // namespace audio_tools
@@ -46,8 +46,10 @@ class BaseBuffer {
   /// Removes the next len entries
   virtual int clearArray(int len) {
     int lenResult = min(len, available());
-    T dummy[lenResult];
-    readArray(dummy, lenResult);
+    T dummy;
+    for (int j = 0; j < lenResult; j++) {
+      read(dummy);
+    }
     return lenResult;
   }
 
@@ -200,7 +202,23 @@ class SingleBuffer : public BaseBuffer<T> {
 
   int writeArray(const T data[], int len) override {
     if (size() == 0) resize(len);
-    return BaseBuffer<T>::writeArray(data, len);
+    int result = min(len, availableForWrite());
+    if (result <= 0) return 0;
+    memcpy(buffer.data() + current_write_pos, data, result * sizeof(T));
+    current_write_pos += result;
+    return result;
+  }
+
+  int readArray(T data[], int len) override {
+    if (data == nullptr) {
+      LOGE("NPE");
+      return 0;
+    }
+    int result = min(len, available());
+    if (result <= 0) return 0;
+    memcpy(data, buffer.data() + current_read_pos, result * sizeof(T));
+    current_read_pos += result;
+    return result;
   }
 
   bool write(T sample) override {
@@ -333,7 +351,10 @@ class SingleBuffer : public BaseBuffer<T> {
 };
 
 /**
- * @brief Implements a typed Ringbuffer
+ * @brief Implements a typed Ringbuffer. The storage is allocated with a power
+ * of two number of entries, so that the free running read and write positions
+ * can be mapped with a mask. readArray(), writeArray(), peekArray() and
+ * clearArray() copy with at most two memcpy calls.
  * @ingroup buffers
  * @tparam T
  */
@@ -350,35 +371,54 @@ class RingBuffer : public BaseBuffer<T> {
       return false;
     }
 
-    result = _aucBuffer[_iTail];
-    _iTail = nextIndex(_iTail);
-    _numElems--;
-
+    result = _aucBuffer[_iTail & _mask];
+    _iTail++;
     return true;
   }
 
+  /// reads multiple values
+  int readArray(T data[], int len) override {
+    if (data == nullptr) {
+      LOGE("NPE");
+      return 0;
+    }
+    int result = peekArray(data, len);
+    if (result <= 0) return 0;
+    _iTail += result;
+    return result;
+  }
+
   // peeks the actual entry from the buffer
   bool peek(T &result) override {
     if (isEmpty()) {
       return false;
     }
 
-    result = _aucBuffer[_iTail];
+    result = _aucBuffer[_iTail & _mask];
     return true;
   }
 
+  /// copies multiple values w/o removing them: returns -1 if the buffer is empty
   virtual int peekArray(T *data, int n) {
     if (isEmpty()) return -1;
-    int result = 0;
-    int count = _numElems;
-    int tail = _iTail;
-    for (int j = 0; j < n; j++) {
-      data[j] = _aucBuffer[tail];
-      tail = nextIndex(tail);
-      count--;
-      result++;
-      if (count == 0) break;
-    }
+    int result = min(n, available());
+    copySpans(data, _iTail, result);
+    return result;
+  }
+
+  /// Provides the address of the oldest entry and the number of entries which
+  /// can be accessed from there w/o wrapping (0 if empty). Use clearArray() to
+  /// consume them.
+  T *peekSpan(int &len) {
+    uint32_t pos = _iTail & _mask;
+    len = min(available(), (int)(_mask + 1 - pos));
+    return len > 0 ? _aucBuffer.data() + pos : nullptr;
+  }
+
+  /// Removes the next len entries
+  int clearArray(int len) override {
+    int result = min(len, available());
+    if (result > 0) _iTail += result;
     return result;
   }
 
@@ -391,35 +431,52 @@ class RingBuffer : public BaseBuffer<T> {
   virtual bool write(T data) override {
     bool result = false;
     if (!isFull()) {
-      _aucBuffer[_iHead] = data;
-      _iHead = nextIndex(_iHead);
-      _numElems++;
+      _aucBuffer[_iHead & _mask] = data;
+      _iHead++;
       result = true;
     }
     return result;
   }
 
+  /// Fills the buffer data
+  int writeArray(const T data[], int len) override {
+    int result = min(len, availableForWrite());
+    if (result <= 0) return 0;
+    uint32_t pos = _iHead & _mask;
+    int len1 = min(result, (int)(_mask + 1 - pos));
+    memcpy(_aucBuffer.data() + pos, data, len1 * sizeof(T));
+    if (result > len1) {
+      memcpy(_aucBuffer.data(), data + len1, (result - len1) * sizeof(T));
+    }
+    _iHead += result;
+    return result;
+  }
+
   // clears the buffer
   virtual void reset() override {
     _iHead = 0;
     _iTail = 0;
-    _numElems = 0;
   }
 
   // provides the number of entries that are available to read
-  virtual int available() override { return _numElems; }
+  virtual int available() override { return (int)(_iHead - _iTail); }
 
   // provides the number of entries that are available to write
-  virtual int availableForWrite() override { return (max_size - _numElems); }
+  virtual int availableForWrite() override { return (max_size - available()); }
 
   // returns the address of the start of the physical read buffer
   virtual T *address() override { return _aucBuffer.data(); }
 
+  /// Defines the capacity: the storage is rounded up to the next power of two
   virtual bool resize(int len) {
     if (max_size != len && len > 0) {
       LOGI("resize: %d", len);
-      _aucBuffer.resize(len);
+      uint32_t capacity = 1;
+      while (capacity < (uint32_t)len) capacity <<= 1;
+      _aucBuffer.resize(capacity);
+      _mask = capacity - 1;
       max_size = len;
+      reset();
     }
     return true;
   }
@@ -430,14 +487,21 @@ class RingBuffer : public BaseBuffer<T> {
  protected:
   Allocator &_allocator;
   Vector<T> _aucBuffer{_allocator};
-  int _iHead;
-  int _iTail;
-  int _numElems;
+  // free running positions: the difference is the number of entries
+  uint32_t _iHead = 0;
+  uint32_t _iTail = 0;
+  uint32_t _mask = 0;
   int max_size = 0;
 
-  int nextIndex(int index) { 
-    if (max_size == 0) return 0;
-    return (uint32_t)(index + 1) % max_size; }
+  /// copies len entries starting at the indicated position
+  void copySpans(T *data, uint32_t from, int len) {
+    uint32_t pos = from & _mask;
+    int len1 = min(len, (int)(_mask + 1 - pos));
+    memcpy(data, _aucBuffer.data() + pos, len1 * sizeof(T));
+    if (len > len1) {
+      memcpy(data + len1, _aucBuffer.data(), (len - len1) * sizeof(T));
+    }
+  }
 };
 
 /**
@@ -678,6 +742,41 @@ class NBuffer : public BaseBuffer<T> {
     return actual_read_buffer->peek(result);
   }
 
+  /// reads multiple values from the actual read buffer
+  int readArray(T data[], int len) override {
+    if (data == nullptr) {
+      LOGE("NPE");
+      return 0;
+    }
+    int result = min(len, available());
+    if (result <= 0) return 0;
+    return actual_read_buffer->readArray(data, result);
+  }
+
+  /// Fills the buffer data: a full buffer is handed over to the reader
+  /// immediately
+  int writeArray(const T data[], int len) override {
+    int result = 0;
+    while (result < len) {
+      int open = availableForWrite();
+      if (open <= 0) break;
+      int n = actual_write_buffer->writeArray(data + result,
+                                              min(len - result, open));
+      if (n <= 0) break;
+      result += n;
+      if (actual_write_buffer->isFull()) {
+        addFilledBuffer(actual_write_buffer);
+        actual_write_buffer = getNextAvailableBuffer();
+      }
+    }
+
+    if (start_time == 0l) {
+      start_time = millis();
+    }
+    sample_count += result;
+    return result;
+  }
+
   /// checks if the buffer is full
   bool isFull() { return availableForWrite() == 0; }
 
@@ -1,4 +1,5 @@
 #pragma once
+#include <math.h>
 #include "AudioTools/CoreAudio/AudioBasic/Collections/Vector.h"
 #include "AudioTools/CoreAudio/Buffers.h"
 
@@ -245,6 +246,172 @@ struct ParabolicInterpolator : public BaseInterpolator {
   }
 };
 
+/**
+ * @brief Polyphase windowed-sinc resampler for a fixed rational ratio.
+ *
+ * The step size is approximated by a fraction M/L (input frames per output
+ * frame) with L <= maxPhases. One Blackman windowed-sinc FIR of 2 * halfTaps
+ * coefficients is precomputed for each of the L output phases, so producing an
+ * output sample is a single dot product with no per-sample coefficient
+ * calculation and no virtual call. When downsampling the cutoff follows the
+ * output Nyquist frequency, so the same table also acts as anti-alias filter.
+ *
+ * Frames are interleaved; the history is kept per channel (planar, written
+ * twice) so that every dot product reads one contiguous span. The latency is
+ * halfTaps input frames.
+ *
+ * Can be used directly with process() or as the TInterpolator of
+ * ResampleStreamT / MultiChannelResampler.
+ */
+class PolyphaseResampler {
+ public:
+  PolyphaseResampler(int halfTaps = 8, int maxPhases = 320) {
+    half_taps = halfTaps < 1 ? 1 : halfTaps;
+    taps = 2 * half_taps;
+    max_phases = maxPhases < 1 ? 1 : maxPhases;
+  }
+
+  /// Defines the number of interleaved channels (clears the history)
+  void setChannels(int channels) {
+    if (channels == _channels) return;
+    _channels = channels;
+    history.resize(_channels * 2 * taps);
+    reset();
+  }
+
+  /// Sets the input frames per output frame and rebuilds the coefficient table
+  void setStepSize(float step) {
+    if (step <= 0.0f) return;
+    if (step == step_size && !coefficients.empty()) return;
+    step_size = step;
+    approximate(step, max_phases, step_down, phases);
+    if ((float)step_down / (float)phases != step) {
+      LOGW("step %f approximated by %d/%d", step, step_down, phases);
+    }
+    buildTable();
+    reset();
+  }
+
+  /// Clears the history and restarts the phase
+  void reset() {
+    for (int j = 0; j < (int)history.size(); j++) history[j] = 0.0f;
+    pos = 0;
+    phase = 0;
+    has_input = false;
+  }
+
+  /// Adds one interleaved input frame
+  void addValues(const float* frame) {
+    if (phase >= phases) phase -= phases;
+    for (int ch = 0; ch < _channels; ch++) {
+      float* hist = &history[ch * 2 * taps];
+      hist[pos] = frame[ch];
+      hist[pos + taps] = frame[ch];
+    }
+    if (++pos == taps) pos = 0;
+    has_input = true;
+  }
+
+  /// Produces the next interleaved output frame: false if more input is needed
+  bool getValues(float* frame) {
+    if (!has_input || phase >= phases) return false;
+    const float* coef = &coefficients[phase * taps];
+    for (int ch = 0; ch < _channels; ch++) {
+      // oldest .. newest frame are contiguous at pos .. pos + taps - 1
+      const float* hist = &history[ch * 2 * taps + pos];
+      float sum = 0.0f;
+      for (int j = 0; j < taps; j++) sum += coef[j] * hist[j];
+      frame[ch] = sum;
+    }
+    phase += step_down;
+    return true;
+  }
+
+  /**
+   * @brief Resamples a block of interleaved frames.
+   * @param in Input frames (channels() values each)
+   * @param frames Number of input frames
+   * @param out Output buffer with room for maxOutputFrames(frames) frames
+   * @return Number of output frames written
+   */
+  size_t process(const float* in, size_t frames, float* out) {
+    size_t result = 0;
+    for (size_t i = 0; i < frames; i++) {
+      addValues(in + i * _channels);
+      while (getValues(out + result * _channels)) result++;
+    }
+    return result;
+  }
+
+  /// Upper bound for the output frames of process()
+  size_t maxOutputFrames(size_t frames) const {
+    return frames * phases / step_down + 1;
+  }
+
+  operator bool() const { return has_input && phase < phases; }
+
+  int channels() const { return _channels; }
+
+ protected:
+  int half_taps;
+  int taps;
+  int max_phases;
+  int _channels = 0;
+  float step_size = 0.0f;
+  int step_down = 1;  ///< M: input frames per L output frames
+  int phases = 1;     ///< L: number of coefficient sets
+  int phase = 0;      ///< Output position in 1/L input frames
+  int pos = 0;        ///< Oldest frame in the history
+  bool has_input = false;
+  Vector<float> coefficients;
+  Vector<float> history;
+
+  /// Best fraction num/den ~ value with den <= maxDen (continued fraction)
+  static void approximate(float value, int maxDen, int& num, int& den) {
+    long p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+    double x = value;
+    for (int iter = 0; iter < 32; iter++) {
+      long a = (long)x;
+      long p2 = a * p1 + p0;
+      long q2 = a * q1 + q0;
+      if (q2 > maxDen) break;
+      p0 = p1; q0 = q1; p1 = p2; q1 = q2;
+      double rest = x - (double)a;
+      if (rest < 1e-9) break;
+      x = 1.0 / rest;
+    }
+    if (q1 == 0) { p1 = (long)(value + 0.5f); q1 = 1; }
+    num = p1 < 1 ? 1 : (int)p1;
+    den = (int)q1;
+  }
+
+  void buildTable() {
+    const double pi = 3.14159265358979323846;
+    // cutoff relative to the input Nyquist frequency
+    double fc = step_size > 1.0f ? 1.0 / step_size : 1.0;
+    // slightly below Nyquist so the transition band is not folded back
+    fc *= 0.92;
+    coefficients.resize(phases * taps);
+    for (int p = 0; p < phases; p++) {
+      // position of the output sample between history[half_taps - 1] and
+      // history[half_taps]
+      double t = (double)(half_taps - 1) + (double)p / phases;
+      double sum = 0.0;
+      float* coef = &coefficients[p * taps];
+      for (int j = 0; j < taps; j++) {
+        double x = (double)j - t;
+        double sinc = x == 0.0 ? fc : sin(pi * fc * x) / (pi * x);
+        double w = 0.42 + 0.5 * cos(pi * x / half_taps) +
+                   0.08 * cos(2.0 * pi * x / half_taps);
+        coef[j] = (float)(sinc * w);
+        sum += coef[j];
+      }
+      // unity gain at DC for every phase
+      for (int j = 0; j < taps; j++) coef[j] = (float)(coef[j] / sum);
+    }
+  }
+};
+
 /**
  * @brief Multi-channel resampler that applies a BaseInterpolator-derived algorithm
  * to each channel.
@@ -270,6 +437,7 @@ class MultiChannelResampler {
    * @param step The new step size.
    */
   void setStepSize(float step) {
+    _step = step;
     for (int i = 0; i < _channels; ++i) {
       _resamplers[i].setStepSize(step);
     }
@@ -316,15 +484,59 @@ class MultiChannelResampler {
    */
   int channels() const { return _channels; }
 
+  /**
+   * @brief Resamples a block of interleaved frames.
+   * @return Number of output frames written to out
+   */
+  size_t process(const float* in, size_t frames, float* out) {
+    size_t result = 0;
+    for (size_t i = 0; i < frames; i++) {
+      addValues(in + i * _channels);
+      while (getValues(out + result * _channels)) result++;
+    }
+    return result;
+  }
+
+  /// Upper bound for the output frames of process()
+  size_t maxOutputFrames(size_t frames) const {
+    return (size_t)(frames / _step) + 2;
+  }
+
  protected:
   int _channels = 0;
+  float _step = 1.0f;
   Vector<TInterpolator> _resamplers;
 };
 
+/**
+ * @brief MultiChannelResampler for the PolyphaseResampler: all channels share
+ * one coefficient table and are processed as interleaved frames.
+ */
+template <>
+class MultiChannelResampler<PolyphaseResampler> {
+ public:
+  void setChannels(int channels) { _resampler.setChannels(channels); }
+  void setStepSize(float step) { _resampler.setStepSize(step); }
+  void addValues(const float* values) { _resampler.addValues(values); }
+  bool getValues(float* out) { return _resampler.getValues(out); }
+  size_t process(const float* in, size_t frames, float* out) {
+    return _resampler.process(in, frames, out);
+  }
+  size_t maxOutputFrames(size_t frames) const {
+    return _resampler.maxOutputFrames(frames);
+  }
+  operator bool() const { return _resampler.channels() > 0 && _resampler; }
+  int channels() const { return _resampler.channels(); }
+
+ protected:
+  PolyphaseResampler _resampler;
+};
+
 /**
  * @brief A Stream implementation for resamping using a specified interpolation
  * algorithm.
- * @tparam TInterpolator The resampler type (must derive from BaseInterpolator).
+ * @tparam TInterpolator The resampler type (derived from BaseInterpolator, or
+ * PolyphaseResampler)
  */
 template <class TInterpolator>
 class ResampleStreamT : public ReformatBaseStream {
@@ -485,7 +697,12 @@ class ResampleStreamT : public ReformatBaseStream {
   MultiChannelResampler<TInterpolator> _resampler;
   ResampleConfig cfg;
 
-  /// Writes the buffer to defined output after resampling
+  Vector<float> _in_frames;
+  Vector<float> _out_frames;
+  Vector<uint8_t> _out_bytes;
+
+  /// Writes the buffer to defined output after resampling: the data is
+  /// converted in blocks and each block is written with a single call
   template <typename T>
   size_t writeT(Print* p_out, const uint8_t* buffer, size_t bytes,
                 size_t& written) {
@@ -496,38 +713,42 @@ class ResampleStreamT : public ReformatBaseStream {
       return p_out->write(buffer, bytes);
     }
 
-    // resample the data
+    const int block_frames = 64;
     int channels = audioInfo().channels;
-    T* data = (T*)buffer;
-    float frame[channels];
+    const T* data = (const T*)buffer;
     size_t frames = bytes / (sizeof(T) * channels);
     size_t frames_written = 0;
-    for (size_t i = 0; i < frames; ++i) {
-      // fill frame (of floats) with values from data
-      for (int ch = 0; ch < channels; ++ch) {
-        frame[ch] = static_cast<float>(data[i * channels + ch]);
+    _in_frames.resize(block_frames * channels);
+    _out_frames.resize(_resampler.maxOutputFrames(block_frames) * channels);
+    _out_bytes.resize(_out_frames.size() * sizeof(T));
+
+    for (size_t start = 0; start < frames; start += block_frames) {
+      size_t n = frames - start;
+      if (n > (size_t)block_frames) n = block_frames;
+
+      // fill frames (of floats) with values from data
+      const T* src = data + start * channels;
+      for (size_t j = 0; j < n * channels; ++j) {
+        _in_frames[j] = static_cast<float>(src[j]);
+      }
+
+      size_t result = _resampler.process(_in_frames.data(), n,
+                                         _out_frames.data());
+
+      // Convert float to correct output type
+      T* resultT = (T*)_out_bytes.data();
+      for (size_t j = 0; j < result * channels; ++j) {
+        resultT[j] = NumberConverter::clipT<T>(_out_frames[j]);
       }
 
-      // Add values to resampler
-      _resampler.addValues(frame);
-
-      // Get resampled values
-      float result[channels];
-      while (_resampler.getValues(result)) {
-        // Convert float to correct output type
-        T resultT[channels];
-        for (int ch = 0; ch < channels; ++ch) {
-          resultT[ch] = NumberConverter::clipT<T>(result[ch]);
-        }
-
-        // Write the frame
-        size_t to_write = sizeof(T) * channels;
-        size_t written = p_out->write((const uint8_t*)resultT, to_write);
-        if (written != to_write) {
-          LOGE("write error %zu -> %zu", to_write, written);
-        }
-        frames_written++;
+      // Write the block
+      size_t to_write = result * sizeof(T) * channels;
+      if (to_write == 0) continue;
+      size_t written = p_out->write((const uint8_t*)resultT, to_write);
+      if (written != to_write) {
+        LOGE("write error %zu -> %zu", to_write, written);
       }
+      frames_written += result;
     }
 
     return frames_written * sizeof(T) * channels;
@@ -0,0 +1,185 @@
+// Throughput of RingBuffer and NBuffer readArray()/writeArray() compared to
+// the previous per-entry implementation (copied below as LegacyRingBuffer and
+// LegacyNBuffer). Also checks that the data comes out unchanged.
+#include <chrono>
+#include <functional>
+#include "AudioTools.h"
+
+const int total = 16 * 1024 * 1024;  // entries per run
+const int runs = 3;
+
+/// RingBuffer as it was: per entry read/write with a % per index
+template <typename T>
+class LegacyRingBuffer : public BaseBuffer<T> {
+ public:
+  LegacyRingBuffer(int size) { resize(size); }
+  bool read(T &result) override {
+    if (isEmpty()) return false;
+    result = buffer[tail];
+    tail = nextIndex(tail);
+    count--;
+    return true;
+  }
+  bool peek(T &result) override {
+    if (isEmpty()) return false;
+    result = buffer[tail];
+    return true;
+  }
+  int clearArray(int len) override {
+    int result = min(len, available());
+    T dummy[result];
+    this->readArray(dummy, result);
+    return result;
+  }
+  bool isFull() override { return available() == max_size; }
+  bool isEmpty() { return available() == 0; }
+  bool write(T data) override {
+    if (isFull()) return false;
+    buffer[head] = data;
+    head = nextIndex(head);
+    count++;
+    return true;
+  }
+  void reset() override { head = tail = count = 0; }
+  int available() override { return count; }
+  int availableForWrite() override { return max_size - count; }
+  T *address() override { return buffer.data(); }
+  bool resize(int len) override {
+    buffer.resize(len);
+    max_size = len;
+    reset();
+    return true;
+  }
+  size_t size() override { return max_size; }
+
+ protected:
+  Vector<T> buffer;
+  int head = 0, tail = 0, count = 0, max_size = 0;
+  int nextIndex(int index) { return (uint32_t)(index + 1) % max_size; }
+};
+
+/// SingleBuffer w/o the memcpy overrides, so that NBuffer copies per entry
+template <typename T>
+class LegacySingleBuffer : public SingleBuffer<T> {
+ public:
+  LegacySingleBuffer(int size) : SingleBuffer<T>(size) {}
+  int readArray(T data[], int len) override {
+    return BaseBuffer<T>::readArray(data, len);
+  }
+  int writeArray(const T data[], int len) override {
+    return BaseBuffer<T>::writeArray(data, len);
+  }
+};
+
+/// NBuffer with the per entry readArray()/writeArray()
+template <typename T>
+class LegacyNBuffer : public NBuffer<T> {
+ public:
+  LegacyNBuffer(int size, int count) : NBuffer<T>(size, count) {}
+  int readArray(T data[], int len) override {
+    return BaseBuffer<T>::readArray(data, len);
+  }
+  int writeArray(const T data[], int len) override {
+    return BaseBuffer<T>::writeArray(data, len);
+  }
+};
+
+/// Streams total entries through the buffer in chunks: returns MB/s and
+/// checks the sequence
+template <typename T>
+double measure(BaseBuffer<T> &buffer, int chunk, bool &ok) {
+  Vector<T> in, out;
+  in.resize(chunk);
+  out.resize(chunk);
+  uint32_t next_in = 0, next_out = 0;
+  ok = true;
+  auto start = std::chrono::high_resolution_clock::now();
+  while (next_out < total) {
+    for (int j = 0; j < chunk; j++) in[j] = (T)(next_in + j);
+    int written = buffer.writeArray(in.data(), chunk);
+    next_in += written;
+    // keep the buffer half filled so that the copies wrap around
+    while (buffer.available() > 0 && next_out < next_in) {
+      int n = buffer.readArray(out.data(), chunk);
+      if (n <= 0) break;
+      for (int j = 0; j < n; j++) {
+        if (out[j] != (T)(next_out + j)) ok = false;
+      }
+      next_out += n;
+      if (buffer.available() < (int)buffer.size() / 2) break;
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double sec = std::chrono::duration<double>(end - start).count();
+  return (double)total * sizeof(T) / sec / 1.0e6;
+}
+
+/// Each run uses new buffers: NBuffer::reset() keeps the partial write buffer
+template <typename T, class Legacy, class Current>
+void compare(const char *title, int chunk, std::function<Legacy *()> newLegacy,
+             std::function<Current *()> newCurrent) {
+  double best_legacy = 0, best_current = 0;
+  bool ok_legacy = true, ok_current = true;
+  for (int r = 0; r < runs; r++) {
+    bool ok;
+    Legacy *legacy = newLegacy();
+    best_legacy = max(best_legacy, measure<T>(*legacy, chunk, ok));
+    ok_legacy = ok_legacy && ok;
+    delete legacy;
+    Current *current = newCurrent();
+    best_current = max(best_current, measure<T>(*current, chunk, ok));
+    ok_current = ok_current && ok;
+    delete current;
+  }
+  printf("%-22s chunk %5d: legacy %8.1f MB/s  current %8.1f MB/s  x%5.1f %s\n",
+         title, chunk, best_legacy, best_current, best_current / best_legacy,
+         (ok_legacy && ok_current) ? "ok" : "DATA MISMATCH");
+}
+
+template <typename T>
+void compareRingBuffer(const char *title, int size, int chunk) {
+  compare<T, LegacyRingBuffer<T>, RingBuffer<T>>(
+      title, chunk, [=]() { return new LegacyRingBuffer<T>(size); },
+      [=]() { return new RingBuffer<T>(size); });
+}
+
+template <typename T>
+void compareNBuffer(const char *title, int size, int count, int chunk) {
+  compare<T, LegacyNBuffer<T>, NBuffer<T>>(
+      title, chunk, [=]() { return new LegacyNBuffer<T>(size, count); },
+      [=]() { return new NBuffer<T>(size, count); });
+}
+
+void testPeekSpan() {
+  RingBuffer<int16_t> buffer(100);  // storage 128 entries
+  int16_t data[80];
+  for (int j = 0; j < 80; j++) data[j] = j;
+  buffer.writeArray(data, 80);
+  buffer.clearArray(80);
+  buffer.writeArray(data, 80);  // wraps after 48 entries
+  int len = 0;
+  int16_t *span = buffer.peekSpan(len);
+  bool ok = len == 48 && span[0] == 0 && span[47] == 47;
+  buffer.clearArray(len);
+  span = buffer.peekSpan(len);
+  ok = ok && len == 32 && span[0] == 48 && span[31] == 79;
+  buffer.clearArray(len);
+  span = buffer.peekSpan(len);
+  ok = ok && len == 0 && span == nullptr;
+  ok = ok && buffer.size() == 100 && buffer.availableForWrite() == 100;
+  printf("peekSpan: %s\n", ok ? "ok" : "FAILED");
+}
+
+void setup() {
+  AudioToolsLogger.begin(Serial, AudioToolsLogLevel::Warning);
+  testPeekSpan();
+  for (int chunk : {32, 256, 1024}) {
+    compareRingBuffer<uint8_t>("RingBuffer<uint8_t>", 4096, chunk);
+    compareRingBuffer<int16_t>("RingBuffer<int16_t>", 4096, chunk);
+    compareRingBuffer<float>("RingBuffer<float>", 4096, chunk);
+    compareNBuffer<uint8_t>("NBuffer<uint8_t>", 1024, 4, chunk);
+  }
+  exit(0);
+}
+
+void loop() {}
@@ -0,0 +1,111 @@
+// Producer and consumer thread: RingBufferLockFree compared to a RingBuffer
+// which is protected by a SynchronizedBuffer. Checks that the data arrives
+// unchanged, also with blocking reads/writes and the span API.
+#define USE_STD_CONCURRENCY
+#include <chrono>
+#include <thread>
+#include "AudioTools.h"
+#include "AudioTools/Concurrency/SynchronizedBuffer.h"
+#include "AudioTools/Concurrency/LockFree/RingBufferLockFree.h"
+
+const uint32_t total = 8 * 1024 * 1024;  // bytes per run
+const int chunk = 256;
+
+/// Copies total bytes through the buffer: returns MB/s
+double measure(BaseBuffer<uint8_t> &buffer, bool &ok) {
+  ok = true;
+  auto start = std::chrono::high_resolution_clock::now();
+  std::thread producer([&]() {
+    uint8_t data[chunk];
+    uint32_t pos = 0;
+    while (pos < total) {
+      for (int j = 0; j < chunk; j++) data[j] = (uint8_t)(pos + j);
+      int n = 0;
+      while (n < chunk) {
+        int written = buffer.writeArray(data + n, chunk - n);
+        if (written == 0) std::this_thread::yield();
+        n += written;
+      }
+      pos += chunk;
+    }
+  });
+  uint8_t data[chunk];
+  uint32_t pos = 0;
+  while (pos < total) {
+    int n = buffer.readArray(data, chunk);
+    if (n == 0) std::this_thread::yield();
+    for (int j = 0; j < n; j++) {
+      if (data[j] != (uint8_t)(pos + j)) ok = false;
+    }
+    pos += n;
+  }
+  producer.join();
+  auto end = std::chrono::high_resolution_clock::now();
+  double sec = std::chrono::duration<double>(end - start).count();
+  return total / sec / 1.0e6;
+}
+
+/// Producer uses acquireWrite()/commitWrite(), consumer acquireRead()/commitRead()
+double measureSpans(RingBufferLockFree<uint8_t> &buffer, bool &ok) {
+  ok = true;
+  auto start = std::chrono::high_resolution_clock::now();
+  std::thread producer([&]() {
+    uint32_t pos = 0;
+    while (pos < total) {
+      int len = 0;
+      uint8_t *dst = buffer.acquireWrite(len);
+      if (len == 0) std::this_thread::yield();
+      if (len > chunk) len = chunk;
+      for (int j = 0; j < len; j++) dst[j] = (uint8_t)(pos + j);
+      buffer.commitWrite(len);
+      pos += len;
+    }
+  });
+  uint32_t pos = 0;
+  while (pos < total) {
+    int len = 0;
+    uint8_t *src = buffer.acquireRead(len);
+    if (len == 0) std::this_thread::yield();
+    for (int j = 0; j < len; j++) {
+      if (src[j] != (uint8_t)(pos + j)) ok = false;
+    }
+    buffer.commitRead(len);
+    pos += len;
+  }
+  producer.join();
+  auto end = std::chrono::high_resolution_clock::now();
+  double sec = std::chrono::duration<double>(end - start).count();
+  return total / sec / 1.0e6;
+}
+
+void report(const char *title, BaseBuffer<uint8_t> &buffer) {
+  bool ok = false;
+  double mb = measure(buffer, ok);
+  printf("%-36s %8.1f MB/s %s\n", title, mb, ok ? "ok" : "DATA MISMATCH");
+}
+
+void setup() {
+  AudioToolsLogger.begin(Serial, AudioToolsLogLevel::Warning);
+
+  RingBuffer<uint8_t> ring(4096);
+  StdMutex mutex;
+  SynchronizedBuffer<uint8_t> synchronized(ring, mutex);
+  report("SynchronizedBuffer(RingBuffer)", synchronized);
+
+  RingBufferLockFree<uint8_t> lock_free(4096);
+  report("RingBufferLockFree", lock_free);
+
+  RingBufferLockFree<uint8_t> blocking(4096);
+  blocking.setReadMaxWait(100);
+  blocking.setWriteMaxWait(100);
+  report("RingBufferLockFree (blocking)", blocking);
+
+  RingBufferLockFree<uint8_t> spans(4096);
+  bool ok = false;
+  double mb = measureSpans(spans, ok);
+  printf("%-36s %8.1f MB/s %s\n", "RingBufferLockFree (spans)", mb,
+         ok ? "ok" : "DATA MISMATCH");
+  exit(0);
+}
+
+void loop() {}
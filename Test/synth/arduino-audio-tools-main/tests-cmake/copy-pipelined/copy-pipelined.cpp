@@ -0,0 +1,100 @@
+// Pipelined copy: two seconds of a generator are copied to an output which
+// consumes in real time but with jitter. With prebuffering the writer must
+// never run dry before the source ends, and every byte must arrive.
+#include <assert.h>
+#include <random>
+#include "AudioTools.h"
+#include "AudioTools/Concurrency/StreamCopyPipelined.h"
+
+/// Consumes the data at the audio rate, but each write takes a random time
+class JitterOutput : public AudioOutput {
+ public:
+  size_t write(const uint8_t *data, size_t len) override {
+    AudioInfo cfg = audioInfo();
+    int frame_size = cfg.channels * cfg.bits_per_sample / 8;
+    uint32_t us = 1000000ull * (len / frame_size) / cfg.sample_rate;
+    std::uniform_int_distribution<int> jitter(0, us);
+    // sometimes late, on average real time
+    delayMicroseconds(us / 2 + jitter(rnd));
+    bytes += len;
+    return len;
+  }
+
+  size_t bytesReceived() { return bytes; }
+
+ protected:
+  std::mt19937 rnd{1};
+  std::atomic<size_t> bytes{0};
+};
+
+/// Provides the first `limit` bytes of a stream, then nothing
+class FiniteStream : public AudioStream {
+ public:
+  FiniteStream(AudioStream &in, size_t limit) : p_in(&in), open(limit) {}
+
+  size_t readBytes(uint8_t *data, size_t len) override {
+    if (len > open) len = open;
+    size_t result = p_in->readBytes(data, len);
+    open -= result;
+    if (open == 0 && !ended) {
+      ended = true;
+      onEnd();
+    }
+    return result;
+  }
+
+ protected:
+  AudioStream *p_in;
+  size_t open;
+  bool ended = false;
+  void onEnd();
+};
+
+AudioInfo info(44100, 2, 16);
+const size_t total_bytes = 2 * 44100 * 4;  // 2 seconds
+SineWaveGenerator<int16_t> sineWave(32000);
+GeneratedSoundStream<int16_t> sound(sineWave);
+FiniteStream source(sound, total_bytes);
+JitterOutput out;
+StreamCopyPipelined copier(out, source, 1024, 4);
+// Underruns when the source ran out: the writer only counts the final one
+// (ring drained, no more data) after that
+std::atomic<int> underruns_at_end{-1};
+uint32_t start_ms = 0;
+
+void FiniteStream::onEnd() { underruns_at_end = copier.underruns(); }
+
+void setup() {
+  AudioToolsLogger.begin(Serial, AudioToolsLogLevel::Warning);
+  sineWave.begin(info, N_B4);
+  sound.begin(info);
+  source.setAudioInfo(info);
+  out.begin(info);
+  copier.setAudioInfo(info);
+  copier.setPrebuffer(2);
+  copier.begin();
+  start_ms = millis();
+}
+
+void loop() {
+  // the ring is written out in real time: allow twice that
+  if (copier.bytesCopied() < total_bytes && millis() - start_ms < 4000) {
+    delay(10);
+    return;
+  }
+  copier.end();
+  Serial.print("bytes: ");
+  Serial.print((int)copier.bytesCopied());
+  Serial.print(" received: ");
+  Serial.print((int)out.bytesReceived());
+  Serial.print(" underruns: ");
+  Serial.print((int)underruns_at_end);
+  Serial.print(" overruns: ");
+  Serial.print((int)copier.overruns());
+  Serial.println();
+  assert(copier.bytesCopied() == total_bytes);
+  assert(out.bytesReceived() == total_bytes);
+  assert(underruns_at_end == 0);
+  assert(copier.overruns() == 0);
+  exit(0);
+}
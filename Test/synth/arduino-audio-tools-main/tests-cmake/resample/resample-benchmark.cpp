@@ -0,0 +1,90 @@
+// Compares the resampling interpolators: throughput and quality for
+// 44.1 kHz -> 32 kHz (stereo, float)
+#include <chrono>
+#include "AudioTools.h"
+
+const float from_rate = 44100.0f;
+const float to_rate = 32000.0f;
+const int frames = 44100 * 4;
+const int channels = 2;
+const int runs = 5;
+
+Vector<float> input;
+Vector<float> output;
+
+// channel 0: 1 kHz tone (pass band), channel 1: 20 kHz tone (aliases to 12 kHz)
+void createInput() {
+  input.resize(frames * channels);
+  for (int i = 0; i < frames; i++) {
+    input[i * channels] = 0.5f * sin(2.0 * PI * 1000.0 * i / from_rate);
+    input[i * channels + 1] = 0.5f * sin(2.0 * PI * 20000.0 * i / from_rate);
+  }
+}
+
+/// Least squares fit of a*sin + b*cos at freq: returns the residual / fitted power
+void fitTone(int channel, size_t n, double freq, double& signal,
+             double& residual) {
+  double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0;
+  size_t start = n / 10;  // skip the filter latency
+  for (size_t k = start; k < n; k++) {
+    double w = 2.0 * PI * freq * k / to_rate;
+    double s = sin(w), c = cos(w), y = output[k * channels + channel];
+    ss += s * s; cc += c * c; sc += s * c; ys += y * s; yc += y * c;
+  }
+  double det = ss * cc - sc * sc;
+  double a = (ys * cc - yc * sc) / det;
+  double b = (yc * ss - ys * sc) / det;
+  signal = 0;
+  residual = 0;
+  for (size_t k = start; k < n; k++) {
+    double w = 2.0 * PI * freq * k / to_rate;
+    double fit = a * sin(w) + b * cos(w);
+    double y = output[k * channels + channel];
+    signal += fit * fit;
+    residual += (y - fit) * (y - fit);
+  }
+}
+
+template <class TInterpolator>
+void benchmark(const char* name) {
+  MultiChannelResampler<TInterpolator> resampler;
+  resampler.setChannels(channels);
+  resampler.setStepSize(from_rate / to_rate);
+  output.resize(resampler.maxOutputFrames(frames) * channels);
+
+  size_t n = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int r = 0; r < runs; r++) {
+    n = resampler.process(input.data(), frames, output.data());
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double sec = std::chrono::duration<double>(end - start).count();
+
+  // 1 kHz: everything that is not the tone is error
+  double signal, residual;
+  fitTone(0, n, 1000.0, signal, residual);
+  double snr = 10.0 * log10(signal / residual);
+  // 20 kHz: anything left is the alias at 12 kHz
+  double alias = 0;
+  for (size_t k = n / 10; k < n; k++) {
+    alias += output[k * channels + 1] * output[k * channels + 1];
+  }
+  double level = 0.125 * (n - n / 10);  // power of the 0.5 amplitude input
+  double rejection = 10.0 * log10(level / alias);
+
+  printf("%-12s %8.1f Mframes/s  %6.1fx realtime  SNR(1k) %6.1f dB  alias(20k) %6.1f dB\n",
+         name, frames * runs / sec / 1e6, frames * runs / from_rate / sec,
+         snr, -rejection);
+}
+
+void setup() {
+  createInput();
+  benchmark<LinearInterpolator>("linear");
+  benchmark<BSplineInterpolator>("bspline");
+  benchmark<LagrangeInterpolator>("lagrange");
+  benchmark<HermiteInterpolator>("hermite");
+  benchmark<PolyphaseResampler>("polyphase");
+  exit(0);
+}
+
+void loop() {}
@@ -0,0 +1,258 @@
+#include "SimBoard.h"
+#include "Config.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+SimBoard simBoard;
+
+SimBoard::SimBoard() {
+    memset(pinModes, INPUT, sizeof(pinModes));
+    memset(pinLevels, LOW, sizeof(pinLevels));
+    memset(buttonDown, 0, sizeof(buttonDown));
+    memset(padDown, 0, sizeof(padDown));
+    memset(padEdgeUs, 0, sizeof(padEdgeUs));
+    memset(padChatterUs, 0, sizeof(padChatterUs));
+    memset(ledcDuty, 0, sizeof(ledcDuty));
+}
+
+// -----------------------------------------------------------------------------
+// Script
+// -----------------------------------------------------------------------------
+static bool parseTarget(std::istringstream& in, int& pin, bool& pad) {
+    std::string name;
+    if (!(in >> name)) return false;
+    pad = false;
+    if (name == "pad") {
+        pad = true;
+        return (in >> pin) && pin >= 0 && pin < 16;
+    }
+    if (name == "mode") pin = BTN_MODE;
+    else if (name == "octave") pin = BTN_OCTAVE;
+    else if (name == "boot") pin = BTN_BOOT;
+    else return false;
+    return true;
+}
+
+bool SimBoard::loadScript(const char* path) {
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "[SimBoard] Cannot open script %s\n", path);
+        return false;
+    }
+    std::vector<Event> parsed;
+    std::string line;
+    int lineNo = 0;
+    bool ended = false;
+    while (std::getline(file, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream in(line);
+        long ms;
+        std::string command;
+        if (!(in >> ms)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            fprintf(stderr, "[SimBoard] %s:%d: expected a time in ms\n", path, lineNo);
+            return false;
+        }
+        Event event = {(unsigned long)ms, EVENT_PRESS, 0, false, ""};
+        bool ok = (in >> command) && ms >= 0;
+        if (ok && (command == "press" || command == "release" || command == "tap")) {
+            ok = parseTarget(in, event.pin, event.pad);
+            if (ok && command == "release") event.type = EVENT_RELEASE;
+            parsed.push_back(event);
+            if (ok && command == "tap") {
+                int holdMs = SIM_TAP_MS;
+                in >> holdMs;
+                event.type = EVENT_RELEASE;
+                event.ms += holdMs;
+                parsed.push_back(event);
+            }
+        } else if (ok && command == "bounce") {
+            event.type = EVENT_BOUNCE;
+            ok = (in >> event.pin) && event.pin >= 0;
+            parsed.push_back(event);
+        } else if (ok && command == "serial") {
+            event.type = EVENT_SERIAL;
+            ok = (bool)(in >> event.text);
+            parsed.push_back(event);
+        } else if (ok && command == "end") {
+            event.type = EVENT_END;
+            parsed.push_back(event);
+            ended = true;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "[SimBoard] %s:%d: cannot parse '%s'\n", path, lineNo, line.c_str());
+            return false;
+        }
+    }
+
+    std::stable_sort(parsed.begin(), parsed.end(),
+                     [](const Event& a, const Event& b) { return a.ms < b.ms; });
+    std::lock_guard<std::mutex> guard(lock);
+    events = parsed;
+    nextEvent = 0;
+    endEvent = ended;
+    scriptEnd = 0;
+    for (const Event& event : events) {
+        if (event.type == EVENT_END) {
+            scriptEnd = event.ms;
+            break;
+        }
+        scriptEnd = event.ms;
+    }
+    return true;
+}
+
+void SimBoard::update(unsigned long nowMs) {
+    std::lock_guard<std::mutex> guard(lock);
+    while (nextEvent < events.size() && events[nextEvent].ms <= nowMs)
+        apply(events[nextEvent++]);
+}
+
+void SimBoard::apply(const Event& event) {
+    switch (event.type) {
+    case EVENT_PRESS:
+    case EVENT_RELEASE: {
+        bool down = event.type == EVENT_PRESS;
+        if (event.pad) {
+            if (padDown[event.pin] != down) {
+                padEdgeUs[event.pin] = (uint64_t)event.ms * 1000;
+                padChatterUs[event.pin] = chatterUs;
+            }
+            padDown[event.pin] = down;
+        } else {
+            buttonDown[event.pin] = down;
+        }
+        break;
+    }
+    case EVENT_BOUNCE:
+        chatterUs = (uint32_t)event.pin * 1000;
+        break;
+    case EVENT_SERIAL:
+        serialInput += event.text;
+        break;
+    case EVENT_END:
+        break;
+    }
+}
+
+void SimBoard::setPad(int index, bool down) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (index >= 0 && index < 16) padDown[index] = down;
+}
+
+void SimBoard::setButton(int pin, bool down) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (pin >= 0 && pin < SIM_PIN_COUNT) buttonDown[pin] = down;
+}
+
+int SimBoard::getLedDuty(int channel) const {
+    return channel >= 0 && channel < SIM_LEDC_CHANNELS ? (int)ledcDuty[channel] : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Pins
+// -----------------------------------------------------------------------------
+void SimBoard::pinMode(uint8_t pin, uint8_t mode) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (pin < SIM_PIN_COUNT) pinModes[pin] = mode;
+}
+
+void SimBoard::digitalWrite(uint8_t pin, uint8_t val) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (pin < SIM_PIN_COUNT) pinLevels[pin] = val ? HIGH : LOW;
+}
+
+/// Contact state: the scripted state, except while the last edge still bounces
+bool SimBoard::isPadClosed(int index, uint64_t nowUs) {
+    uint64_t since = nowUs - padEdgeUs[index];
+    if (nowUs < padEdgeUs[index] || since >= padChatterUs[index])
+        return padDown[index];
+    return ((since / SIM_CHATTER_US) & 1) ? !padDown[index] : padDown[index];
+}
+
+bool SimBoard::isPadPulledLow(int col, uint64_t nowUs) {
+    for (int row = 0; row < 4; row++) {
+        int pin = ROW_PINS[row];
+        if (pinModes[pin] == OUTPUT && pinLevels[pin] == LOW && isPadClosed(row * 4 + col, nowUs))
+            return true;
+    }
+    return false;
+}
+
+int SimBoard::digitalRead(uint8_t pin) {
+    if (pin >= SIM_PIN_COUNT) return LOW;
+    uint64_t nowUs = micros();
+    update(nowUs / 1000);
+    std::lock_guard<std::mutex> guard(lock);
+    return readPin(pin, nowUs);
+}
+
+uint32_t SimBoard::readGpio(int bank) {
+    uint64_t nowUs = micros();
+    update(nowUs / 1000);
+    std::lock_guard<std::mutex> guard(lock);
+    uint32_t levels = 0;
+    for (int bit = 0; bit < 32 && bank * 32 + bit < SIM_PIN_COUNT; bit++)
+        if (readPin(bank * 32 + bit, nowUs)) levels |= 1UL << bit;
+    return levels;
+}
+
+void SimBoard::writeGpio(SimGpioRegister reg, uint32_t mask) {
+    std::lock_guard<std::mutex> guard(lock);
+    for (int pin = 0; pin < 32; pin++) {
+        if (!(mask & (1UL << pin))) continue;
+        switch (reg) {
+        case SIM_GPIO_OUT_W1TS: pinLevels[pin] = HIGH; break;
+        case SIM_GPIO_OUT_W1TC: pinLevels[pin] = LOW; break;
+        case SIM_GPIO_ENABLE_W1TS: pinModes[pin] = OUTPUT; break;
+        case SIM_GPIO_ENABLE_W1TC: pinModes[pin] = INPUT; break;
+        }
+    }
+}
+
+/// Level of a pin; call with the lock held
+int SimBoard::readPin(int pin, uint64_t nowUs) {
+    if (pinModes[pin] == OUTPUT) return pinLevels[pin];
+    for (int col = 0; col < 4; col++) {
+        if (COL_PINS[col] == pin)
+            return isPadPulledLow(col, nowUs) ? LOW : HIGH;
+    }
+    if (buttonDown[pin]) return LOW;
+    return pinModes[pin] == INPUT_PULLUP ? HIGH : LOW;
+}
+
+void SimBoard::ledcAttachPin(uint8_t pin, uint8_t channel) {
+    (void)pin;
+    (void)channel;
+}
+
+void SimBoard::ledcWrite(uint8_t channel, uint32_t duty) {
+    if (channel < SIM_LEDC_CHANNELS) ledcDuty[channel] = duty;
+}
+
+// -----------------------------------------------------------------------------
+// Serial input
+// -----------------------------------------------------------------------------
+int SimBoard::serialAvailable() {
+    update(millis());
+    std::lock_guard<std::mutex> guard(lock);
+    return (int)serialInput.size();
+}
+
+int SimBoard::serialRead() {
+    std::lock_guard<std::mutex> guard(lock);
+    if (serialInput.empty()) return -1;
+    int c = (uint8_t)serialInput[0];
+    serialInput.erase(0, 1);
+    return c;
+}
+
+int SimBoard::serialPeek() {
+    std::lock_guard<std::mutex> guard(lock);
+    return serialInput.empty() ? -1 : (uint8_t)serialInput[0];
+}
@@ -0,0 +1,101 @@
+#ifndef SIM_BOARD_H
+#define SIM_BOARD_H
+
+#include <Arduino.h>
+#include "soc/gpio_struct.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// SIMULATED BOARD
+// =============================================================================
+// Electrical model of the synth's inputs behind pinMode/digitalRead and the
+// GPIO registers, so the real scanner in Hardware.cpp (row drive, pull-ups,
+// debounce) runs unchanged:
+// a column reads LOW while one of its pads is held and that pad's row is
+// driven LOW; the function buttons pull their pin LOW. Pad contacts can bounce:
+// after an edge they toggle every SIM_CHATTER_US for the `bounce` time. LEDC duties are kept
+// for the LED state.
+//
+// Pad presses, button presses and serial input come from a script of timed
+// events, applied when the firmware next looks at the pins or the serial port:
+//
+//   # ms    command   target       (comments and blank lines are ignored)
+//   500     press     pad 5        pads 0-15, row * 4 + col
+//   620     release   pad 5
+//   1000    tap       mode 50      press, release 50 ms later (default 30)
+//   2000    serial    p            characters for Serial.read()
+//   3000    bounce    4            later pad edges chatter for 4 ms (0 = clean)
+//   4000    end                    stop the simulation
+// =============================================================================
+
+#define SIM_PIN_COUNT 64
+#define SIM_LEDC_CHANNELS 8
+#define SIM_TAP_MS 30
+#define SIM_CHATTER_US 300
+
+class SimBoard {
+public:
+    SimBoard();
+    /// Loads the event script; prints the offending line and returns false on errors
+    bool loadScript(const char* path);
+    /// Time of the `end` event or the last event (0 without a script)
+    unsigned long getScriptEnd() const { return scriptEnd; }
+    bool hasEndEvent() const { return endEvent; }
+
+    /// Applies the events that are due at nowMs
+    void update(unsigned long nowMs);
+
+    void setPad(int index, bool down);
+    void setButton(int pin, bool down);
+    int getLedDuty(int channel) const;
+
+    // --- Arduino core backend ---
+    void pinMode(uint8_t pin, uint8_t mode);
+    void digitalWrite(uint8_t pin, uint8_t val);
+    int digitalRead(uint8_t pin);
+    /// GPIO.in (bank 0, GPIO 0-31) / GPIO.in1 (bank 1, GPIO 32+)
+    uint32_t readGpio(int bank);
+    void writeGpio(SimGpioRegister reg, uint32_t mask);
+    void ledcAttachPin(uint8_t pin, uint8_t channel);
+    void ledcWrite(uint8_t channel, uint32_t duty);
+    int serialAvailable();
+    int serialRead();
+    int serialPeek();
+
+private:
+    enum EventType { EVENT_PRESS, EVENT_RELEASE, EVENT_SERIAL, EVENT_BOUNCE, EVENT_END };
+    struct Event {
+        unsigned long ms;
+        EventType type;
+        int pin;                    // Pad index (pad = true), button pin or bounce ms
+        bool pad;
+        std::string text;
+    };
+
+    std::mutex lock;
+    std::vector<Event> events;      // Sorted by time
+    size_t nextEvent = 0;
+    unsigned long scriptEnd = 0;
+    bool endEvent = false;
+
+    uint8_t pinModes[SIM_PIN_COUNT];
+    uint8_t pinLevels[SIM_PIN_COUNT];
+    bool buttonDown[SIM_PIN_COUNT];
+    bool padDown[16];
+    uint64_t padEdgeUs[16];         // Time of the last scripted edge
+    uint32_t padChatterUs[16];      // Bounce time of that edge
+    uint32_t chatterUs = 0;         // Set by `bounce`
+    uint32_t ledcDuty[SIM_LEDC_CHANNELS];
+    std::string serialInput;
+
+    void apply(const Event& event);
+    bool isPadClosed(int index, uint64_t nowUs);
+    bool isPadPulledLow(int col, uint64_t nowUs);
+    int readPin(int pin, uint64_t nowUs);
+};
+
+extern SimBoard simBoard;
+
+#endif
@@ -0,0 +1,23 @@
+# ctest helper: runs the sim on a script, then prints the SHA-256 of the file
+# the run wrote, for the test's PASS_REGULAR_EXPRESSION. The virtual clock makes
+# the output the same on every run, so a changed hash means changed behavior.
+#
+#   cmake -DSIM=<synth-sim> -DSCRIPT=<script> [-DOUT=<wav>] -DCHECK=<file> -P SimCheck.cmake
+#
+# CHECK is the file hashed: OUT, or a file the firmware writes (bounce.wav).
+
+file(REMOVE ${CHECK})
+set(args --script ${SCRIPT})
+if (OUT)
+    list(APPEND args --out ${OUT})
+endif()
+execute_process(COMMAND ${SIM} ${args} RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "synth-sim failed: ${result}")
+endif()
+if (NOT EXISTS ${CHECK})
+    message(FATAL_ERROR "${CHECK} not written")
+endif()
+file(SHA256 ${CHECK} hash)
+get_filename_component(name ${CHECK} NAME)
+message(STATUS "${name} sha256 ${hash}")
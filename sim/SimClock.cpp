@@ -0,0 +1,168 @@
+#include "SimClock.h"
+#include <chrono>
+
+SimClock simClock;
+
+uint64_t SimClock::wallUs() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void SimClock::begin(SimClockMode clockMode) {
+    std::lock_guard<std::mutex> guard(lock);
+    mode = clockMode;
+    loopThread = std::this_thread::get_id();
+    startWallUs = wallUs();
+    now = 0;
+    audioUs = 0;
+    queuedUs = 0;
+    driven = false;
+    sleeping = false;
+    stopped = false;
+    parked = false;
+}
+
+uint64_t SimClock::nowUs() {
+    if (mode == SIM_CLOCK_REALTIME)
+        return wallUs() - startWallUs;
+    std::lock_guard<std::mutex> guard(lock);
+    return now;
+}
+
+void SimClock::sleepUs(uint64_t us) {
+    if (mode == SIM_CLOCK_REALTIME || std::this_thread::get_id() != loopThread) {
+        if (!isStopped())
+            std::this_thread::sleep_for(std::chrono::microseconds(us));
+        return;
+    }
+    std::unique_lock<std::mutex> guard(lock);
+    if (stopped) return;
+    if (!driven) {
+        // No audio yet: loop() owns the time
+        uint64_t until = now + us;
+        runTimers(guard, until);
+        now = until;
+        return;
+    }
+    // Hand the time over to the audio task until it reaches our wake-up time
+    wake = now + us;
+    sleeping = true;
+    changed.notify_all();
+    changed.wait(guard, [this] { return !sleeping || stopped; });
+    sleeping = false;
+}
+
+void SimClock::delayUs(uint32_t us) {
+    if (mode != SIM_CLOCK_REALTIME) return;     // Busy waits take no simulated time
+    uint64_t end = wallUs() + us;
+    while (wallUs() < end) {
+    }
+}
+
+void SimClock::attachAudio(uint32_t lead) {
+    std::lock_guard<std::mutex> guard(lock);
+    leadUs = lead;
+    driven = true;
+}
+
+void SimClock::advanceAudio(uint64_t us) {
+    std::unique_lock<std::mutex> guard(lock);
+    if (stopped) park(guard);
+    if (mode == SIM_CLOCK_REALTIME) {
+        audioUs += us;
+        uint64_t played = wallUs() - startWallUs + leadUs;
+        if (audioUs > played) {
+            // The DMA queue is full: wait until the DAC has taken the difference
+            guard.unlock();
+            std::this_thread::sleep_for(std::chrono::microseconds(audioUs - played));
+        }
+        return;
+    }
+
+    // The DMA queue fills first, then each write waits for the DAC
+    if (queuedUs < leadUs) {
+        uint64_t fill = std::min<uint64_t>(us, leadUs - queuedUs);
+        queuedUs += fill;
+        us -= fill;
+        if (us == 0) return;
+    }
+
+    uint64_t target = now + us;
+    while (true) {
+        // Time only moves while loop() sleeps
+        changed.wait(guard, [this] { return sleeping || stopped; });
+        if (stopped) park(guard);
+        runTimers(guard, std::min(wake, target));
+        if (stopped) park(guard);
+        if (wake > target) {
+            now = target;
+            return;
+        }
+        now = wake;
+        sleeping = false;
+        changed.notify_all();
+    }
+}
+
+void SimClock::addTimer(uint32_t periodUs, void (*fn)()) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (mode == SIM_CLOCK_REALTIME) {
+        std::thread([this, periodUs, fn]() {
+            uint64_t next = wallUs() + periodUs;
+            while (!isStopped()) {
+                uint64_t t = wallUs();
+                if (t < next) std::this_thread::sleep_for(std::chrono::microseconds(next - t));
+                fn();
+                next += periodUs;
+            }
+        }).detach();
+        return;
+    }
+    timers.push_back({periodUs, fn, now + periodUs});
+}
+
+/// Virtual time: fires the timer ticks up to `until` in order, outside the lock
+void SimClock::runTimers(std::unique_lock<std::mutex>& guard, uint64_t until) {
+    while (!stopped) {
+        Timer* due = nullptr;
+        for (Timer& timer : timers)
+            if (timer.next <= until && (!due || timer.next < due->next)) due = &timer;
+        if (!due) return;
+        now = std::max(now, due->next);
+        due->next += due->periodUs;
+        void (*fn)() = due->fn;
+        guard.unlock();
+        fn();
+        guard.lock();
+    }
+}
+
+void SimClock::waitForLoop() {
+    if (mode == SIM_CLOCK_REALTIME || std::this_thread::get_id() == loopThread) return;
+    std::unique_lock<std::mutex> guard(lock);
+    if (driven)
+        changed.wait(guard, [this] { return sleeping || stopped; });
+}
+
+void SimClock::park(std::unique_lock<std::mutex>& guard) {
+    // Sleeps outside the lock, so the clock can be destroyed at exit
+    parked = true;
+    changed.notify_all();
+    guard.unlock();
+    while (true)
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+}
+
+void SimClock::stop() {
+    std::unique_lock<std::mutex> guard(lock);
+    stopped = true;
+    changed.notify_all();
+    // The audio task must not be inside the engine while the process exits
+    if (driven)
+        changed.wait_for(guard, std::chrono::seconds(1), [this] { return parked; });
+}
+
+bool SimClock::isStopped() {
+    std::lock_guard<std::mutex> guard(lock);
+    return stopped;
+}
@@ -0,0 +1,90 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <Arduino.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// =============================================================================
+// SIMULATED TIME
+// =============================================================================
+// millis()/micros()/delay() of the desktop simulation.
+//
+// SIM_CLOCK_VIRTUAL (default): time is the number of frames the audio task has
+// written beyond the DMA queue (the first writes fill the queue and take no
+// time). The audio task and loop() run in lockstep - time only moves while
+// loop() sleeps in delay(), and loop() wakes at exactly the time it asked for -
+// so a scripted session gives the same output on every run and the engine runs
+// as fast as the host allows (perf, cachegrind, sanitizers). Durations measured
+// with micros() are simulated time: use the render profiler for CPU time.
+//
+// SIM_CLOCK_REALTIME: wall-clock time; the audio output is paced like the I2S
+// DMA queue (or by the sound card when playing through PortAudio/miniaudio).
+//
+// Only the thread that called begin() (loop()) takes part in the lockstep;
+// delay() on any other task sleeps in real time. Periodic timers (the hardware
+// timer interrupts) fire at their exact simulated times, while loop() sleeps.
+// =============================================================================
+
+enum SimClockMode {
+    SIM_CLOCK_VIRTUAL,
+    SIM_CLOCK_REALTIME
+};
+
+class SimClock {
+public:
+    /// Call from the thread that runs setup()/loop()
+    void begin(SimClockMode mode);
+    SimClockMode getMode() const { return mode; }
+
+    uint64_t nowUs();
+    void sleepUs(uint64_t us);
+    void delayUs(uint32_t us);      // Busy wait - no lockstep hand-off
+
+    /// Audio output: from now on the audio writes beyond leadUs drive the time
+    void attachAudio(uint32_t leadUs);
+    /// Audio task: us of output were written. May block (lockstep/pacing)
+    void advanceAudio(uint64_t us);
+    /// Periodic callback, like a hardware timer interrupt
+    void addTimer(uint32_t periodUs, void (*fn)());
+    /// New tasks: in lockstep a task starts once loop() sleeps
+    void waitForLoop();
+
+    /// Ends the session: delay() returns at once, the audio task stops at its
+    /// next write (waited for here)
+    void stop();
+    bool isStopped();
+
+private:
+    SimClockMode mode = SIM_CLOCK_VIRTUAL;
+    std::mutex lock;
+    std::condition_variable changed;
+    std::thread::id loopThread;
+    uint64_t startWallUs = 0;
+    uint64_t now = 0;               // Virtual time
+    uint64_t audioUs = 0;           // Realtime: output written so far
+    uint64_t wake = 0;              // When loop() resumes
+    uint32_t leadUs = 0;            // Output queued ahead of the DAC (DMA queue)
+    uint64_t queuedUs = 0;          // Virtual: how far the queue has been filled
+    bool driven = false;            // Audio writes advance the time
+    bool sleeping = false;          // loop() is waiting in delay()
+    bool stopped = false;
+    bool parked = false;            // The audio task has stopped for good
+
+    struct Timer {
+        uint32_t periodUs;
+        void (*fn)();
+        uint64_t next;              // Virtual: time of the next tick
+    };
+    std::vector<Timer> timers;
+
+    uint64_t wallUs();
+    void runTimers(std::unique_lock<std::mutex>& guard, uint64_t until);
+    [[noreturn]] void park(std::unique_lock<std::mutex>& guard);
+};
+
+extern SimClock simClock;
+
+#endif
@@ -0,0 +1,150 @@
+#include "SimI2S.h"
+#include "SimClock.h"
+#ifdef SIM_PORTAUDIO
+#include "AudioTools/AudioLibs/PortAudioStream.h"
+#endif
+#ifdef SIM_MINIAUDIO
+#include "AudioTools/AudioLibs/MiniAudioStream.h"
+#endif
+
+#define SIM_WAV_HEADER_LEN 44
+
+SimAudioOut simAudioOut;
+
+#ifdef SIM_PORTAUDIO
+static audio_tools::PortAudioStream s_portAudio;
+#endif
+#ifdef SIM_MINIAUDIO
+static audio_tools::MiniAudioStream s_miniAudio;
+#endif
+static audio_tools::AudioStream* s_device = nullptr;
+
+static void putLE(uint8_t* p, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) p[i] = (uint8_t)(value >> (8 * i));
+}
+
+// PCM header; the sizes are patched in end()
+static void wavHeader(uint8_t* h, int sampleRate, int channels, uint32_t dataLen) {
+    memcpy(h, "RIFF", 4);
+    putLE(h + 4, dataLen + SIM_WAV_HEADER_LEN - 8, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    putLE(h + 16, 16, 4);
+    putLE(h + 20, 1, 2);
+    putLE(h + 22, channels, 2);
+    putLE(h + 24, sampleRate, 4);
+    putLE(h + 28, sampleRate * channels * 2, 4);
+    putLE(h + 32, channels * 2, 2);
+    putLE(h + 34, 16, 2);
+    memcpy(h + 36, "data", 4);
+    putLE(h + 40, dataLen, 4);
+}
+
+bool SimAudioOut::setSink(const char* spec) {
+    path = nullptr;
+    if (strcmp(spec, "null") == 0) {
+        sink = SIM_AUDIO_NULL;
+    } else if (strcmp(spec, "portaudio") == 0) {
+#ifndef SIM_PORTAUDIO
+        fprintf(stderr, "[SimAudio] Built without PortAudio (SIM_PORTAUDIO)\n");
+        return false;
+#endif
+        sink = SIM_AUDIO_PORTAUDIO;
+    } else if (strcmp(spec, "miniaudio") == 0) {
+#ifndef SIM_MINIAUDIO
+        fprintf(stderr, "[SimAudio] Built without miniaudio (SIM_MINIAUDIO)\n");
+        return false;
+#endif
+        sink = SIM_AUDIO_MINIAUDIO;
+    } else {
+        sink = SIM_AUDIO_WAV;
+        path = spec;
+    }
+    return true;
+}
+
+bool SimAudioOut::begin(int rate, int channelCount, uint32_t leadFrames) {
+    end();
+    std::lock_guard<std::mutex> guard(lock);
+    sampleRate = rate;
+    channels = channelCount;
+    frames = 0;
+    clockUs = 0;
+    clipped = 0;
+
+    if (sink == SIM_AUDIO_WAV) {
+        file = fopen(path, "wb");
+        if (!file) {
+            fprintf(stderr, "[SimAudio] Cannot create %s\n", path);
+            return false;
+        }
+        uint8_t header[SIM_WAV_HEADER_LEN];
+        wavHeader(header, sampleRate, channels, 0);
+        fwrite(header, 1, sizeof(header), file);
+    }
+#ifdef SIM_PORTAUDIO
+    if (sink == SIM_AUDIO_PORTAUDIO) {
+        auto cfg = s_portAudio.defaultConfig(audio_tools::TX_MODE);
+        cfg.sample_rate = sampleRate;
+        cfg.channels = channels;
+        cfg.bits_per_sample = 16;
+        if (!s_portAudio.begin(cfg)) return false;
+        s_device = &s_portAudio;
+    }
+#endif
+#ifdef SIM_MINIAUDIO
+    if (sink == SIM_AUDIO_MINIAUDIO) {
+        auto cfg = s_miniAudio.defaultConfig(audio_tools::TX_MODE);
+        cfg.sample_rate = sampleRate;
+        cfg.channels = channels;
+        cfg.bits_per_sample = 16;
+        if (!s_miniAudio.begin(cfg)) return false;
+        s_device = &s_miniAudio;
+    }
+#endif
+
+    simClock.attachAudio((uint32_t)(1000000ULL * leadFrames / sampleRate));
+    active = true;
+    return true;
+}
+
+size_t SimAudioOut::write(const uint8_t* data, size_t len) {
+    std::unique_lock<std::mutex> guard(lock);
+    if (!active) {
+        guard.unlock();
+        simClock.advanceAudio(0);   // After the session: parks the audio task
+        return 0;
+    }
+    const int16_t* samples = (const int16_t*)data;
+    size_t count = len / sizeof(int16_t);
+    for (size_t i = 0; i < count; i++) {
+        if (samples[i] >= 32767 || samples[i] <= -32767) clipped++;
+    }
+    if (file) fwrite(data, 1, len, file);
+    if (s_device) s_device->write(data, len);
+
+    frames += len / (channels * sizeof(int16_t));
+    uint64_t us = frames * 1000000ULL / sampleRate;
+    uint64_t step = us - clockUs;
+    clockUs = us;
+    guard.unlock();
+    simClock.advanceAudio(step);
+    return len;
+}
+
+void SimAudioOut::end() {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!active) return;
+    active = false;
+    if (file) {
+        uint8_t header[SIM_WAV_HEADER_LEN];
+        wavHeader(header, sampleRate, channels, (uint32_t)(frames * channels * sizeof(int16_t)));
+        fseek(file, 0, SEEK_SET);
+        fwrite(header, 1, sizeof(header), file);
+        fclose(file);
+        file = nullptr;
+    }
+    if (s_device) {
+        s_device->end();
+        s_device = nullptr;
+    }
+}
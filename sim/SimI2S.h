@@ -0,0 +1,108 @@
+#ifndef SIM_I2S_H
+#define SIM_I2S_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "AudioTools.h"
+#include <mutex>
+
+// =============================================================================
+// SIMULATED AUDIO OUTPUT
+// =============================================================================
+// AudioTools has no I2SStream off target. This stand-in takes the same config
+// and sends the frames to the sink picked on the command line: nothing (null),
+// a WAV file, or the sound card through PortAudioStream / MiniAudioStream
+// (built with SIM_PORTAUDIO / SIM_MINIAUDIO). Every write moves the simulated
+// clock, so the output paces the firmware the way the I2S DMA does.
+// =============================================================================
+
+enum SimAudioSink {
+    SIM_AUDIO_NULL,
+    SIM_AUDIO_WAV,
+    SIM_AUDIO_PORTAUDIO,
+    SIM_AUDIO_MINIAUDIO
+};
+
+class SimAudioOut {
+public:
+    /// "null", "portaudio", "miniaudio" or the path of a WAV file
+    bool setSink(const char* spec);
+    SimAudioSink getSink() const { return sink; }
+
+    bool begin(int sampleRate, int channels, uint32_t leadFrames);
+    size_t write(const uint8_t* data, size_t len);
+    /// Completes the WAV header / closes the sound card
+    void end();
+
+    uint64_t getFrames() const { return frames; }
+    uint32_t getClipped() const { return clipped; }
+
+private:
+    std::mutex lock;                // write() on the audio task, end() on loop()
+    SimAudioSink sink = SIM_AUDIO_NULL;
+    const char* path = nullptr;
+    FILE* file = nullptr;
+    int sampleRate = ENGINE_SAMPLE_RATE;
+    int channels = 2;
+    uint64_t frames = 0;
+    uint64_t clockUs = 0;           // Time handed to the SimClock so far
+    uint32_t clipped = 0;           // Samples at full scale
+    bool active = false;
+};
+
+extern SimAudioOut simAudioOut;
+
+namespace audio_tools {
+
+/// The fields of the ESP32 I2SConfig the firmware sets
+class I2SConfig : public AudioInfo {
+public:
+    RxTxMode rx_tx_mode = TX_MODE;
+    int pin_bck = -1;
+    int pin_ws = -1;
+    int pin_data = -1;
+    int pin_data_rx = -1;
+    bool is_master = true;
+    int buffer_count = I2S_BUFFER_COUNT;
+    int buffer_size = I2S_BUFFER_SIZE;
+};
+
+class I2SStream : public AudioStream {
+public:
+    I2SConfig defaultConfig(RxTxMode mode = TX_MODE) {
+        I2SConfig cfg;
+        cfg.rx_tx_mode = mode;
+        cfg.sample_rate = 44100;
+        cfg.channels = 2;
+        cfg.bits_per_sample = 16;
+        return cfg;
+    }
+
+    bool begin(I2SConfig cfg) {
+        config = cfg;
+        info = cfg;
+        // Legacy driver: buffer_size is in frames
+        return simAudioOut.begin(cfg.sample_rate, cfg.channels,
+                                 cfg.buffer_count * cfg.buffer_size);
+    }
+    bool begin() override { return begin(config); }
+    void end() override { simAudioOut.end(); }
+
+    size_t write(const uint8_t* data, size_t len) override { return simAudioOut.write(data, len); }
+    int availableForWrite() override { return config.buffer_size; }
+
+    /// Sync input: the line input is silent
+    size_t readBytes(uint8_t* data, size_t len) override {
+        if (config.rx_tx_mode == TX_MODE) return 0;
+        memset(data, 0, len);
+        return len;
+    }
+    int available() override { return config.rx_tx_mode == TX_MODE ? 0 : config.buffer_size; }
+
+private:
+    I2SConfig config;
+};
+
+}  // namespace audio_tools
+
+#endif
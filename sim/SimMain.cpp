@@ -0,0 +1,121 @@
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include <getopt.h>
+#include <chrono>
+#include "Config.h"
+#include "AudioEngine.h"
+#include "SimBoard.h"
+#include "SimClock.h"
+#include "SimI2S.h"
+
+// =============================================================================
+// DESKTOP SIMULATION - runs src/main.cpp's setup()/loop() on the host
+// =============================================================================
+// loop() runs on the main thread, the audio task on its own thread, exactly as
+// the firmware creates it. Pad presses come from the script (SimBoard), the
+// display is the in-memory U8g2 stand-in and the audio goes to the sink given
+// with --out.
+// =============================================================================
+
+#define SIM_DEFAULT_SECONDS 10
+#define SIM_SCRIPT_TAIL_MS 1000     // Runs on this long after the last scripted event
+
+extern AudioEngine audioEngine;
+void setup();
+void loop();
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -s, --script FILE     timed pad/button/serial events (see sim/README.md)\n"
+            "  -o, --out SINK        null (default), FILE.wav, portaudio or miniaudio\n"
+            "  -t, --seconds N       simulated time to run (default: script end + 1 s, or %d s)\n"
+            "  -r, --realtime        wall-clock time instead of running as fast as possible\n"
+            "  -d, --display FILE    write the last display frame as a PBM image\n"
+            "  -b, --bench           time every instrument x4 against the block period;\n"
+            "                        exit status 1 when Pad x4 does not fit\n",
+            name, SIM_DEFAULT_SECONDS);
+}
+
+int main(int argc, char** argv) {
+    static const struct option options[] = {
+        {"script", required_argument, nullptr, 's'},
+        {"out", required_argument, nullptr, 'o'},
+        {"seconds", required_argument, nullptr, 't'},
+        {"realtime", no_argument, nullptr, 'r'},
+        {"display", required_argument, nullptr, 'd'},
+        {"bench", no_argument, nullptr, 'b'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}};
+
+    const char* script = nullptr;
+    const char* out = "null";
+    const char* displayPath = nullptr;
+    double seconds = 0;
+    SimClockMode mode = SIM_CLOCK_VIRTUAL;
+    bool bench = false;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:o:t:rd:bh", options, nullptr)) != -1) {
+        switch (opt) {
+        case 's': script = optarg; break;
+        case 'o': out = optarg; break;
+        case 't': seconds = atof(optarg); break;
+        case 'r': mode = SIM_CLOCK_REALTIME; break;
+        case 'd': displayPath = optarg; break;
+        case 'b': bench = true; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    if (bench) {
+        // The firmware's SYNTH_BENCHMARK run, before any audio task exists
+        simClock.begin(mode);
+        audioEngine.init();
+        bool fits = audioEngine.benchmark(Serial);
+        fflush(stdout);
+        return fits ? 0 : 1;
+    }
+
+    if (script && !simBoard.loadScript(script)) return 1;
+    if (!simAudioOut.setSink(out)) return 1;
+
+    unsigned long endMs = (unsigned long)(seconds * 1000);
+    if (endMs == 0) {
+        if (simBoard.hasEndEvent()) endMs = simBoard.getScriptEnd();
+        else if (script) endMs = simBoard.getScriptEnd() + SIM_SCRIPT_TAIL_MS;
+        else endMs = SIM_DEFAULT_SECONDS * 1000;
+    }
+
+    auto wallStart = std::chrono::steady_clock::now();
+    simClock.begin(mode);
+    setup();
+    while (millis() < endMs)
+        loop();
+
+    // Park the audio task before closing the output under it
+    simClock.stop();
+    simAudioOut.end();
+    double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double audioSec = (double)simAudioOut.getFrames() / ENGINE_SAMPLE_RATE;
+
+    U8G2* display = U8G2::getDisplay();
+    printf("\n[Sim] %.2f s of audio (%llu frames, %u clipped samples) in %.2f s wall time, %.1fx real time\n",
+           audioSec, (unsigned long long)simAudioOut.getFrames(), simAudioOut.getClipped(),
+           wallSec, wallSec > 0 ? audioSec / wallSec : 0.0);
+    if (display) {
+        printf("[Sim] %u display frames, last frame shows:\n%s", display->getFrameCount(),
+               display->getText().c_str());
+        if (displayPath && !display->writePBM(displayPath))
+            fprintf(stderr, "[Sim] Cannot write %s\n", displayPath);
+    }
+#ifdef SYNTH_PROFILE
+    audioEngine.getProfiler().printReport(Serial);
+#endif
+#ifdef SYNTH_LATENCY
+    audioEngine.getLatencyProbe().printReport(Serial);
+#endif
+    fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,241 @@
+#include "Arduino.h"
+#include "Wire.h"
+#include "soc/gpio_struct.h"
+#include "../SimBoard.h"
+#include "../SimClock.h"
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+TwoWire Wire;
+gpio_dev_t GPIO;
+
+// -----------------------------------------------------------------------------
+// Print / Stream
+// -----------------------------------------------------------------------------
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (n < size && write(buffer[n])) n++;
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(small)) return write((const uint8_t*)small, len);
+
+    char* big = (char*)malloc(len + 1);
+    if (!big) return 0;
+    va_start(args, format);
+    vsnprintf(big, len + 1, format, args);
+    va_end(args);
+    size_t n = write((const uint8_t*)big, len);
+    free(big);
+    return n;
+}
+
+size_t Print::print(long n, int base) {
+    if (base == DEC) return printf("%ld", n);
+    if (n < 0) return print('-') + print((unsigned long)-n, base);
+    return print((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+    if (base < 2 || base > 16) base = DEC;
+    char digits[8 * sizeof(long) + 1];
+    char* p = &digits[sizeof(digits) - 1];
+    *p = '\0';
+    do {
+        *--p = "0123456789ABCDEF"[n % base];
+        n /= base;
+    } while (n);
+    return write(p);
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+    size_t n = 0;
+    while (n < length) {
+        int c = read();
+        if (c < 0) break;
+        buffer[n++] = (uint8_t)c;
+    }
+    return n;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+    size_t n = 0;
+    while (n < length) {
+        int c = read();
+        if (c < 0 || c == terminator) break;
+        buffer[n++] = (char)c;
+    }
+    return n;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+int HardwareSerial::available() {
+    return simBoard.serialAvailable();
+}
+
+int HardwareSerial::read() {
+    return simBoard.serialRead();
+}
+
+int HardwareSerial::peek() {
+    return simBoard.serialPeek();
+}
+
+// -----------------------------------------------------------------------------
+// GPIO / LEDC
+// -----------------------------------------------------------------------------
+void pinMode(uint8_t pin, uint8_t mode) {
+    simBoard.pinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    simBoard.digitalWrite(pin, val);
+}
+
+int digitalRead(uint8_t pin) {
+    return simBoard.digitalRead(pin);
+}
+
+uint32_t simGpioRead(int bank) {
+    return simBoard.readGpio(bank);
+}
+
+void simGpioWrite(SimGpioRegister reg, uint32_t mask) {
+    simBoard.writeGpio(reg, mask);
+}
+
+double ledcSetup(uint8_t chan, double freq, uint8_t bits) {
+    (void)chan;
+    (void)bits;
+    return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t chan) {
+    simBoard.ledcAttachPin(pin, chan);
+}
+
+void ledcWrite(uint8_t chan, uint32_t duty) {
+    simBoard.ledcWrite(chan, duty);
+}
+
+// -----------------------------------------------------------------------------
+// Hardware timers
+// -----------------------------------------------------------------------------
+struct hw_timer_t {
+    uint16_t divider;
+    void (*fn)(void);
+    uint64_t alarm;
+    bool autoreload;
+};
+
+static hw_timer_t s_timers[4];
+
+hw_timer_t* timerBegin(uint8_t num, uint16_t divider, bool countUp) {
+    (void)countUp;
+    if (num >= 4) return nullptr;
+    s_timers[num] = {divider, nullptr, 0, false};
+    return &s_timers[num];
+}
+
+void timerAttachInterrupt(hw_timer_t* timer, void (*fn)(void), bool edge) {
+    (void)edge;
+    if (timer) timer->fn = fn;
+}
+
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarmValue, bool autoreload) {
+    if (!timer) return;
+    timer->alarm = alarmValue;
+    timer->autoreload = autoreload;
+}
+
+void timerAlarmEnable(hw_timer_t* timer) {
+    if (!timer || !timer->fn || !timer->autoreload) return;     // One-shot alarms are not used
+    uint64_t periodUs = timer->alarm * timer->divider / 80;
+    simClock.addTimer((uint32_t)std::max<uint64_t>(periodUs, 1), timer->fn);
+}
+
+// -----------------------------------------------------------------------------
+// Time
+// -----------------------------------------------------------------------------
+unsigned long millis() {
+    return (unsigned long)(simClock.nowUs() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)simClock.nowUs();
+}
+
+void delay(uint32_t ms) {
+    simClock.sleepUs((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    simClock.delayUs(us);
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+// Fixed seed: a scripted session renders the same audio on every run
+static std::mt19937 s_random(1);
+
+long random(long howbig) {
+    if (howbig <= 0) return 0;
+    return (long)(s_random() % (unsigned long)howbig);
+}
+
+long random(long howsmall, long howbig) {
+    if (howsmall >= howbig) return howsmall;
+    return howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) s_random.seed(seed);
+}
+
+// -----------------------------------------------------------------------------
+// FreeRTOS
+// -----------------------------------------------------------------------------
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+    (void)name;
+    (void)stackDepth;
+    (void)priority;
+    (void)core;
+    std::thread* thread = new std::thread([fn, param]() {
+        simClock.waitForLoop();     // Deterministic start relative to loop()
+        fn(param);
+    });
+    thread->detach();               // Tasks run until the simulation exits
+    if (handle) *handle = thread;
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    delay(ticks * portTICK_PERIOD_MS);
+}
+
+void taskYIELD() {
+    std::this_thread::yield();
+}
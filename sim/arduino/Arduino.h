@@ -0,0 +1,175 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+// =============================================================================
+// ARDUINO CORE STAND-IN FOR THE DESKTOP SIMULATION
+// =============================================================================
+// The subset of the ESP32 Arduino core (and its FreeRTOS API) the firmware in
+// src/ uses. Time, GPIO and LEDC are backed by the simulated board (SimClock,
+// SimBoard); Serial writes to stdout and reads the serial lines of the input
+// script. ESP32 is deliberately not defined: the firmware takes its portable
+// code paths (e.g. std::chrono instead of the CPU cycle counter).
+// =============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define IRAM_ATTR
+#define PSTR(s) (s)
+#define F(s) (s)
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// --- GPIO (ESP32 values) ---
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+
+#define CHANGE 0x03
+#define FALLING 0x02
+#define RISING 0x01
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+// No pin interrupts: the firmware polls
+#define digitalPinToInterrupt(p) (p)
+inline void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) { (void)pin; (void)isr; (void)mode; }
+inline void detachInterrupt(uint8_t pin) { (void)pin; }
+
+// LEDC PWM (ESP32 core 2.x API)
+double ledcSetup(uint8_t chan, double freq, uint8_t bits);
+void ledcAttachPin(uint8_t pin, uint8_t chan);
+void ledcWrite(uint8_t chan, uint32_t duty);
+
+// Hardware timers (ESP32 core 2.x API): the alarm interrupt runs in simulated
+// time (SimClock::addTimer). APB clock 80 MHz / divider = timer ticks.
+struct hw_timer_t;
+hw_timer_t* timerBegin(uint8_t num, uint16_t divider, bool countUp);
+void timerAttachInterrupt(hw_timer_t* timer, void (*fn)(void), bool edge);
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarmValue, bool autoreload);
+void timerAlarmEnable(hw_timer_t* timer);
+
+// --- Time (SimClock) ---
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// =============================================================================
+// Print / Stream
+// =============================================================================
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char* str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2) { return printf("%.*f", digits, n); }
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(T value) { return print(value) + println(); }
+    template <typename T> size_t println(T value, int format) { return print(value, format) + println(); }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual size_t readBytes(uint8_t* buffer, size_t length);
+    size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+    size_t readBytesUntil(char terminator, char* buffer, size_t length);
+    void setTimeout(unsigned long timeout) { this->timeout = timeout; }
+    unsigned long getTimeout() { return timeout; }
+protected:
+    unsigned long timeout = 1000;
+};
+
+/// stdout, input from the `serial` lines of the input script
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    operator bool() const { return true; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite() override { return 1024; }
+    void flush() override;
+    int available() override;
+    int read() override;
+    int peek() override;
+};
+
+extern HardwareSerial Serial;
+
+// =============================================================================
+// FreeRTOS subset - tasks are std::threads, priorities and cores are ignored
+// =============================================================================
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdPASS 1
+#define pdFAIL 0
+#define configMAX_PRIORITIES 25
+#define portTICK_PERIOD_MS 1
+#define portMAX_DELAY 0xffffffffUL
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+void taskYIELD();
+
+#endif
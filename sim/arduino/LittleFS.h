@@ -0,0 +1,73 @@
+#ifndef SIM_LITTLEFS_H
+#define SIM_LITTLEFS_H
+
+#include "Arduino.h"
+#include <string>
+
+// Flash file system stand-in: "/name" is the file "name" in the working
+// directory of the simulation
+class File : public Stream {
+public:
+    File(FILE* file = nullptr) : file(file) {}
+    operator bool() const { return file != nullptr; }
+    void close() {
+        if (file) fclose(file);
+        file = nullptr;
+    }
+    size_t size() {
+        if (!file) return 0;
+        long pos = ftell(file);
+        fseek(file, 0, SEEK_END);
+        long len = ftell(file);
+        fseek(file, pos, SEEK_SET);
+        return (size_t)len;
+    }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        return file ? fwrite(buffer, 1, size, file) : 0;
+    }
+    using Print::write;
+    void flush() override {
+        if (file) fflush(file);
+    }
+    int available() override { return file ? (int)(size() - ftell(file)) : 0; }
+    int read() override { return file ? fgetc(file) : -1; }
+    int peek() override {
+        if (!file) return -1;
+        int c = fgetc(file);
+        if (c >= 0) ungetc(c, file);
+        return c;
+    }
+
+private:
+    FILE* file;
+};
+
+class LittleFSFS {
+public:
+    bool begin(bool formatOnFail = false) {
+        (void)formatOnFail;
+        return true;
+    }
+    void end() {}
+    File open(const char* path, const char* mode = "r") {
+        std::string fopenMode = mode[0] == 'w' ? "wb" : mode[0] == 'a' ? "ab" : "rb";
+        return File(fopen(hostPath(path).c_str(), fopenMode.c_str()));
+    }
+    bool exists(const char* path) {
+        FILE* file = fopen(hostPath(path).c_str(), "rb");
+        if (file) fclose(file);
+        return file != nullptr;
+    }
+    bool remove(const char* path) { return ::remove(hostPath(path).c_str()) == 0; }
+
+private:
+    static std::string hostPath(const char* path) {
+        return path[0] == '/' ? std::string(path + 1) : std::string(path);
+    }
+};
+
+static LittleFSFS LittleFS;
+
+#endif
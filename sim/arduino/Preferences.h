@@ -0,0 +1,60 @@
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+#include "Arduino.h"
+#include <map>
+#include <string>
+#include <vector>
+
+// NVS stand-in: keys live in memory for the run of the simulation, so every
+// session starts from the firmware defaults
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false, const char* partition = nullptr) {
+        (void)partition;
+        space = name;
+        this->readOnly = readOnly;
+        open = true;
+        return true;
+    }
+    void end() { open = false; }
+
+    size_t putBytes(const char* key, const void* value, size_t len) {
+        if (!open || readOnly || !key) return 0;
+        const uint8_t* bytes = (const uint8_t*)value;
+        store()[space + "/" + key].assign(bytes, bytes + len);
+        return len;
+    }
+    size_t getBytesLength(const char* key) {
+        const std::vector<uint8_t>* value = find(key);
+        return value ? value->size() : 0;
+    }
+    size_t getBytes(const char* key, void* buf, size_t maxLen) {
+        const std::vector<uint8_t>* value = find(key);
+        if (!value || value->size() > maxLen) return 0;
+        memcpy(buf, value->data(), value->size());
+        return value->size();
+    }
+    bool isKey(const char* key) { return find(key) != nullptr; }
+    bool remove(const char* key) {
+        if (!open || readOnly || !key) return false;
+        return store().erase(space + "/" + key) > 0;
+    }
+
+private:
+    std::string space;
+    bool readOnly = false;
+    bool open = false;
+
+    static std::map<std::string, std::vector<uint8_t>>& store() {
+        static std::map<std::string, std::vector<uint8_t>> values;
+        return values;
+    }
+    const std::vector<uint8_t>* find(const char* key) {
+        if (!open || !key) return nullptr;
+        auto it = store().find(space + "/" + key);
+        return it == store().end() ? nullptr : &it->second;
+    }
+};
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef SIM_PRINT_H
+#define SIM_PRINT_H
+
+// Arduino core header layout: Print and Stream are declared in Arduino.h
+#include "Arduino.h"
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef SIM_STREAM_H
+#define SIM_STREAM_H
+
+// Arduino core header layout: Print and Stream are declared in Arduino.h
+#include "Arduino.h"
+
+#endif
@@ -0,0 +1,121 @@
+#include "U8g2lib.h"
+
+const u8g2_cb_t u8g2_cb_r0 = {0};
+U8G2* U8G2::display = nullptr;
+
+U8G2::U8G2() {
+    memset(buffer, 0, sizeof(buffer));
+    memset(sent, 0, sizeof(sent));
+    display = this;
+}
+
+void U8G2::clearBuffer() {
+    memset(buffer, 0, sizeof(buffer));
+    drawnText.clear();
+}
+
+void U8G2::sendBuffer() {
+    memcpy(sent, buffer, sizeof(sent));
+    text = drawnText;
+    frames++;
+}
+
+void U8G2::clearDisplay() {
+    clearBuffer();
+    sendBuffer();
+}
+
+void U8G2::drawPixel(int x, int y) {
+    if (x < 0 || y < 0 || x >= SIM_U8G2_WIDTH || y >= SIM_U8G2_HEIGHT) return;
+    uint8_t& b = buffer[(y / 8) * SIM_U8G2_WIDTH + x];
+    uint8_t mask = 1 << (y & 7);
+    if (drawColor == 0) b &= ~mask;
+    else if (drawColor == 1) b |= mask;
+    else b ^= mask;
+}
+
+void U8G2::drawHLine(int x, int y, int w) {
+    for (int i = 0; i < w; i++) drawPixel(x + i, y);
+}
+
+void U8G2::drawVLine(int x, int y, int h) {
+    for (int i = 0; i < h; i++) drawPixel(x, y + i);
+}
+
+void U8G2::drawLine(int x0, int y0, int x1, int y1) {
+    int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    while (true) {
+        drawPixel(x0, y0);
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+void U8G2::drawBox(int x, int y, int w, int h) {
+    for (int j = 0; j < h; j++) drawHLine(x, y + j, w);
+}
+
+void U8G2::drawFrame(int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) return;
+    drawHLine(x, y, w);
+    drawHLine(x, y + h - 1, w);
+    drawVLine(x, y + 1, h - 2);
+    drawVLine(x + w - 1, y + 1, h - 2);
+}
+
+static int edge(int ax, int ay, int bx, int by, int px, int py) {
+    return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+void U8G2::drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2) {
+    int minX = min(x0, min(x1, x2)), maxX = max(x0, max(x1, x2));
+    int minY = min(y0, min(y1, y2)), maxY = max(y0, max(y1, y2));
+    int area = edge(x0, y0, x1, y1, x2, y2);
+    for (int y = minY; y <= maxY; y++) {
+        for (int x = minX; x <= maxX; x++) {
+            int w0 = edge(x1, y1, x2, y2, x, y);
+            int w1 = edge(x2, y2, x0, y0, x, y);
+            int w2 = edge(x0, y0, x1, y1, x, y);
+            bool inside = area >= 0 ? (w0 >= 0 && w1 >= 0 && w2 >= 0)
+                                     : (w0 <= 0 && w1 <= 0 && w2 <= 0);
+            if (inside) drawPixel(x, y);
+        }
+    }
+}
+
+u8g2_uint_t U8G2::getStrWidth(const char* str) {
+    return str ? (u8g2_uint_t)(strlen(str) * font[0]) : 0;
+}
+
+u8g2_uint_t U8G2::drawStr(int x, int y, const char* str) {
+    if (!str) return 0;
+    int advance = font[0], ascent = font[1];
+    for (const char* c = str; *c; c++) {
+        if (*c != ' ') drawBox(x + (c - str) * advance, y - ascent + 1, advance - 1, ascent);
+    }
+    drawnText += str;
+    drawnText += '\n';
+    return getStrWidth(str);
+}
+
+bool U8G2::getPixel(int x, int y) const {
+    if (x < 0 || y < 0 || x >= SIM_U8G2_WIDTH || y >= SIM_U8G2_HEIGHT) return false;
+    return sent[(y / 8) * SIM_U8G2_WIDTH + x] & (1 << (y & 7));
+}
+
+bool U8G2::writePBM(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "P1\n%d %d\n", SIM_U8G2_WIDTH, SIM_U8G2_HEIGHT);
+    for (int y = 0; y < SIM_U8G2_HEIGHT; y++) {
+        for (int x = 0; x < SIM_U8G2_WIDTH; x++)
+            fputc(getPixel(x, y) ? '1' : '0', file);
+        fputc('\n', file);
+    }
+    fclose(file);
+    return true;
+}
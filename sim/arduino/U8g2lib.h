@@ -0,0 +1,96 @@
+#ifndef SIM_U8G2LIB_H
+#define SIM_U8G2LIB_H
+
+#include "Arduino.h"
+#include <string>
+#include <vector>
+
+// =============================================================================
+// U8G2 STAND-IN: IN-MEMORY FRAMEBUFFER
+// =============================================================================
+// Same full-buffer layout as U8g2's _F_ constructors (8 pages of 128 columns,
+// one bit per pixel), same drawing primitives. sendBuffer() latches the frame
+// instead of an I2C transfer. There is no glyph data: each character is drawn
+// as a solid cell of the font's advance and ascent, and the strings of the
+// latched frame are kept as text, so scripts can check what the screen shows.
+// =============================================================================
+
+typedef uint8_t u8g2_uint_t;
+typedef struct { uint8_t rotation; } u8g2_cb_t;
+
+extern const u8g2_cb_t u8g2_cb_r0;
+#define U8G2_R0 (&u8g2_cb_r0)
+#define U8X8_PIN_NONE 255
+
+// Font metrics: advance, ascent, descent (pixels)
+static const uint8_t u8g2_font_5x7_tf[] = {5, 6, 1};
+static const uint8_t u8g2_font_6x10_tf[] = {6, 7, 2};
+static const uint8_t u8g2_font_ncenB10_tr[] = {9, 11, 3};
+
+#define SIM_U8G2_WIDTH 128
+#define SIM_U8G2_HEIGHT 64
+
+class U8G2 {
+public:
+    U8G2();
+    bool begin() { return true; }
+    void setI2CAddress(uint8_t address) { i2cAddress = address; }
+    void setContrast(uint8_t value) { contrast = value; }
+    void setPowerSave(uint8_t on) { (void)on; }
+
+    void clearBuffer();
+    void sendBuffer();
+    void clearDisplay();
+    uint8_t* getBufferPtr() { return buffer; }
+    u8g2_uint_t getDisplayWidth() const { return SIM_U8G2_WIDTH; }
+    u8g2_uint_t getDisplayHeight() const { return SIM_U8G2_HEIGHT; }
+
+    void setFont(const uint8_t* font) { this->font = font; }
+    void setDrawColor(uint8_t color) { drawColor = color; }
+    u8g2_uint_t drawStr(int x, int y, const char* str);
+    u8g2_uint_t getStrWidth(const char* str);
+
+    void drawPixel(int x, int y);
+    void drawHLine(int x, int y, int w);
+    void drawVLine(int x, int y, int h);
+    void drawLine(int x0, int y0, int x1, int y1);
+    void drawBox(int x, int y, int w, int h);
+    void drawFrame(int x, int y, int w, int h);
+    void drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2);
+
+    // --- Simulation ---
+    /// The display the firmware created last
+    static U8G2* getDisplay() { return display; }
+    /// Pixel of the last frame sent to the display
+    bool getPixel(int x, int y) const;
+    /// Strings drawn in the last frame sent, one per line
+    const std::string& getText() const { return text; }
+    uint32_t getFrameCount() const { return frames; }
+    /// Writes the last frame sent as a PBM image
+    bool writePBM(const char* path) const;
+
+private:
+    static U8G2* display;
+    uint8_t buffer[SIM_U8G2_WIDTH * SIM_U8G2_HEIGHT / 8];
+    uint8_t sent[SIM_U8G2_WIDTH * SIM_U8G2_HEIGHT / 8];
+    std::string drawnText;
+    std::string text;
+    uint32_t frames = 0;
+    const uint8_t* font = u8g2_font_6x10_tf;
+    uint8_t drawColor = 1;
+    uint8_t i2cAddress = 0x78;
+    uint8_t contrast = 255;
+};
+
+class U8G2_SSD1306_128X64_NONAME_F_HW_I2C : public U8G2 {
+public:
+    U8G2_SSD1306_128X64_NONAME_F_HW_I2C(const u8g2_cb_t* rotation, uint8_t reset = U8X8_PIN_NONE,
+                                        uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE) {
+        (void)rotation;
+        (void)reset;
+        (void)clock;
+        (void)data;
+    }
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+#include "Arduino.h"
+
+// I2C stand-in: the only I2C device, the display, is simulated by U8g2lib.h
+class TwoWire : public Stream {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) {
+        (void)sda;
+        (void)scl;
+        if (frequency) clock = frequency;
+        return true;
+    }
+    void end() {}
+    void setClock(uint32_t frequency) { clock = frequency; }
+    uint32_t getClock() { return clock; }
+
+    void beginTransmission(uint8_t address) { (void)address; }
+    uint8_t endTransmission(bool sendStop = true) { (void)sendStop; return 2; }  // NACK
+    uint8_t requestFrom(uint8_t address, size_t size, bool sendStop = true) {
+        (void)address;
+        (void)size;
+        (void)sendStop;
+        return 0;
+    }
+
+    size_t write(uint8_t c) override { (void)c; return 1; }
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+
+private:
+    uint32_t clock = 100000;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef SIM_SOC_GPIO_STRUCT_H
+#define SIM_SOC_GPIO_STRUCT_H
+
+#include <stdint.h>
+
+// GPIO register block of the ESP32-S3 (soc/gpio_struct.h), the registers the
+// firmware uses. Reads and writes go to the simulated board: the set/clear
+// registers act on GPIO 0-31, `in` and `in1.val` return the input levels of
+// GPIO 0-31 and 32+.
+enum SimGpioRegister {
+    SIM_GPIO_OUT_W1TS,
+    SIM_GPIO_OUT_W1TC,
+    SIM_GPIO_ENABLE_W1TS,
+    SIM_GPIO_ENABLE_W1TC
+};
+
+uint32_t simGpioRead(int bank);
+void simGpioWrite(SimGpioRegister reg, uint32_t mask);
+
+class SimGpioInputRegister {
+public:
+    explicit SimGpioInputRegister(int bank) : bank(bank) {}
+    operator uint32_t() const { return simGpioRead(bank); }
+private:
+    int bank;
+};
+
+class SimGpioSetClearRegister {
+public:
+    explicit SimGpioSetClearRegister(SimGpioRegister reg) : reg(reg) {}
+    void operator=(uint32_t mask) { simGpioWrite(reg, mask); }
+private:
+    SimGpioRegister reg;
+};
+
+struct gpio_dev_t {
+    SimGpioSetClearRegister out_w1ts{SIM_GPIO_OUT_W1TS};
+    SimGpioSetClearRegister out_w1tc{SIM_GPIO_OUT_W1TC};
+    SimGpioSetClearRegister enable_w1ts{SIM_GPIO_ENABLE_W1TS};
+    SimGpioSetClearRegister enable_w1tc{SIM_GPIO_ENABLE_W1TC};
+    SimGpioInputRegister in{0};
+    struct {
+        SimGpioInputRegister val{1};
+    } in1;
+};
+
+extern gpio_dev_t GPIO;
+
+#endif
@@ -0,0 +1,230 @@
+#include "Arpeggiator.h"
+
+// Chord shapes, semitones above the key
+static const int8_t CHORD_SHAPES[CHORD_TYPE_COUNT][ARP_MAX_CHORD] = {
+    {0},                // Off
+    {0, 4, 7},          // Major
+    {0, 3, 7},          // Minor
+    {0, 4, 7, 11},      // Maj7
+    {0, 3, 7, 10},      // Min7
+    {0}                 // Memory (shape in `memory`)
+};
+static const int CHORD_SIZES[CHORD_TYPE_COUNT] = {1, 3, 3, 4, 4, 0};
+
+// Steps per beat of each ArpRate
+static const int RATE_STEPS[ARP_RATE_COUNT] = {1, 2, 3, 4, 6, 8};
+
+Arpeggiator::Arpeggiator() {
+    mode = ARP_OFF;
+    rate = ARP_RATE_16;
+    gate = 0.5f;
+    chord = CHORD_OFF;
+    tempo = 120.0f;
+    samplesPerMinute = ENGINE_SAMPLE_RATE * 60.0f;
+
+    // Memory starts as the Fmaj7 voicing of the original chord demo (root position)
+    static const int8_t initialMemory[] = {0, 4, 7, 11};
+    memorySize = 4;
+    memcpy(memory, initialMemory, sizeof(initialMemory));
+    builtChord = CHORD_OFF;
+    noiseState = 0x2545F491;
+    reset();
+}
+
+void Arpeggiator::init(float sampleRate) {
+    samplesPerMinute = sampleRate * 60.0f;
+}
+
+void Arpeggiator::reset() {
+    keyCount = 0;
+    keysChanged = false;
+    noteCount = 0;
+    soundingCount = 0;
+    running = false;
+    untilStep = 0.0f;
+    untilOff = 0.0f;
+    lastNote = -1;
+    playedIndex = 0;
+}
+
+void Arpeggiator::keyOn(int note, Instrument inst) {
+    for (int i = 0; i < keyCount; i++)
+        if (keys[i].note == note) return;
+    if (keyCount == ARP_MAX_KEYS) return;
+    keys[keyCount].note = note;
+    keys[keyCount].inst = inst;
+    keyCount++;
+    keysChanged = true;
+
+    // Chord memory: a held chord becomes the shape single keys play
+    if (chord == CHORD_MEMORY && keyCount >= 2) {
+        int low = 127;
+        for (int i = 0; i < keyCount; i++)
+            low = min(low, (int)keys[i].note);
+        memorySize = 0;
+        for (int i = 0; i < keyCount && memorySize < ARP_MAX_CHORD; i++)
+            memory[memorySize++] = keys[i].note - low;
+    }
+}
+
+void Arpeggiator::keyOff(int note) {
+    for (int i = 0; i < keyCount; i++) {
+        if (keys[i].note != note) continue;
+        for (int j = i + 1; j < keyCount; j++)
+            keys[j - 1] = keys[j];
+        keyCount--;
+        keysChanged = true;
+        return;
+    }
+}
+
+void Arpeggiator::addNote(int note, uint8_t inst) {
+    if (note < 0 || note > 127 || noteCount == ARP_MAX_NOTES) return;
+    for (int i = 0; i < noteCount; i++)
+        if (played[i].note == note) return;
+    played[noteCount].note = note;
+    played[noteCount].inst = inst;
+    noteCount++;
+}
+
+/// Expands the held keys through the chord stage into the note lists
+void Arpeggiator::rebuild() {
+    noteCount = 0;
+    const int8_t* shape = CHORD_SHAPES[builtChord];
+    int size = CHORD_SIZES[builtChord];
+    if (builtChord == CHORD_MEMORY) {
+        // A held chord plays as it is, a single key plays the stored shape
+        shape = keyCount >= 2 ? CHORD_SHAPES[CHORD_OFF] : memory;
+        size = keyCount >= 2 ? 1 : memorySize;
+    }
+    for (int k = 0; k < keyCount; k++)
+        for (int i = 0; i < size; i++)
+            addNote(keys[k].note + shape[i], keys[k].inst);
+
+    // Insertion sort: few notes, and only when the keys change
+    memcpy(sorted, played, noteCount * sizeof(Key));
+    for (int i = 1; i < noteCount; i++) {
+        Key k = sorted[i];
+        int j = i - 1;
+        while (j >= 0 && sorted[j].note > k.note) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = k;
+    }
+}
+
+float Arpeggiator::stepSamples() const {
+    float bpm = max(20.0f, (float)tempo);
+    return samplesPerMinute / (bpm * RATE_STEPS[rate]);
+}
+
+/// Note list index of the next step
+int Arpeggiator::nextIndex(ArpMode m) {
+    switch (m) {
+    case ARP_UP:
+        for (int i = 0; i < noteCount; i++)
+            if (sorted[i].note > lastNote) return i;
+        return 0;
+    case ARP_DOWN:
+        for (int i = noteCount - 1; i >= 0; i--)
+            if (lastNote < 0 || sorted[i].note < lastNote) return i;
+        return noteCount - 1;
+    case ARP_RANDOM: {
+        noiseState ^= noiseState << 13;
+        noiseState ^= noiseState >> 17;
+        noiseState ^= noiseState << 5;
+        int i = noiseState % noteCount;
+        if (noteCount > 1 && sorted[i].note == lastNote)
+            i = (i + 1) % noteCount;
+        return i;
+    }
+    default:
+        // As played: index into the key-order list
+        return playedIndex++ % noteCount;
+    }
+}
+
+int Arpeggiator::process(int n, ArpEvent* events, int maxEvents) {
+    int count = 0;
+    ChordType c = chord;
+    bool changed = keysChanged || c != builtChord;
+    if (changed) {
+        builtChord = c;
+        keysChanged = false;
+        rebuild();
+    }
+
+    ArpMode m = mode;
+    if (m == ARP_OFF) {
+        // Chord stage only: sounding follows the expanded notes
+        if (!changed && !running) return 0;
+        running = false;
+        int kept = 0;
+        for (int s = 0; s < soundingCount; s++) {
+            bool held = false;
+            for (int i = 0; i < noteCount && !held; i++)
+                held = played[i].note == sounding[s].note;
+            if (held)
+                sounding[kept++] = sounding[s];
+            else if (count < maxEvents)
+                events[count++] = {0, sounding[s].note, sounding[s].inst, false};
+        }
+        soundingCount = kept;
+        for (int i = 0; i < noteCount; i++) {
+            bool on = false;
+            for (int s = 0; s < kept && !on; s++)
+                on = sounding[s].note == played[i].note;
+            if (on || count == maxEvents) continue;
+            events[count++] = {0, played[i].note, played[i].inst, true};
+            sounding[soundingCount++] = played[i];
+        }
+        return count;
+    }
+
+    // Arpeggio: at most one stage note sounds. Leaving chord mode or letting go
+    // of every key releases what sounds at the start of the block.
+    if ((!running || noteCount == 0) && soundingCount > 0) {
+        for (int s = 0; s < soundingCount && count < maxEvents; s++)
+            events[count++] = {0, sounding[s].note, sounding[s].inst, false};
+        soundingCount = 0;
+    }
+    if (noteCount == 0) {
+        running = false;
+        return count;
+    }
+    if (!running) {
+        // First key: the arpeggio starts on it, at the start of the block
+        running = true;
+        untilStep = 0.0f;
+        lastNote = -1;
+        playedIndex = 0;
+    }
+
+    float step = stepSamples();
+    float gateSamples = max(1.0f, gate * step);
+    while (count < maxEvents) {
+        // The gate ends before (or with) the next step
+        if (soundingCount > 0 && untilOff <= untilStep && untilOff < n) {
+            events[count++] = {(uint16_t)untilOff, sounding[0].note, sounding[0].inst, false};
+            soundingCount = 0;
+            continue;
+        }
+        if (untilStep >= n || count + 2 > maxEvents) break;
+        if (soundingCount > 0) {
+            events[count++] = {(uint16_t)untilStep, sounding[0].note, sounding[0].inst, false};
+            soundingCount = 0;
+        }
+        int i = nextIndex(m);
+        const Key& k = m == ARP_AS_PLAYED ? played[i] : sorted[i];
+        events[count++] = {(uint16_t)untilStep, k.note, k.inst, true};
+        sounding[0] = k;
+        soundingCount = 1;
+        lastNote = k.note;
+        untilOff = untilStep + gateSamples;
+        untilStep += step;
+    }
+    untilStep -= n;
+    untilOff -= n;
+    return count;
+}
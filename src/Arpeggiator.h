@@ -0,0 +1,144 @@
+#ifndef ARPEGGIATOR_H
+#define ARPEGGIATOR_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// =============================================================================
+// ARPEGGIATOR AND CHORD MEMORY
+// =============================================================================
+// Stage between the played keys (launchpad pads) and the voices, run by the
+// audio core at the start of every render block. The chord stage expands each
+// held key into a chord (a preset, or the shape of the last chord held in
+// memory mode); with the arpeggiator off the expanded notes sound together,
+// otherwise they are stepped through in the chosen order.
+//
+// Steps are counted in samples at the sequencer tempo, not in loop() time:
+// process() returns the note on/off events that fall into the block with
+// their sample offsets, and the engine starts and releases the voices at
+// exactly those samples. The expanded notes are rebuilt and sorted only when
+// the keys or the chord change, so a step is a short scan with 16 keys held.
+//
+// Threading: set...() from the UI core, read once per block by the audio core.
+// Keys, reset() and process() belong to the audio core (the engine forwards
+// them from its note queue).
+// =============================================================================
+
+#define ARP_MAX_KEYS 16             // Held keys (one per pad)
+#define ARP_MAX_NOTES 32            // Notes after chord expansion
+#define ARP_MAX_CHORD 6             // Notes in a chord shape
+#define ARP_MAX_EVENTS (2 * ARP_MAX_NOTES)  // Events per block
+
+enum ArpMode {
+    ARP_OFF,            // Chord stage only, notes sound together
+    ARP_UP,
+    ARP_DOWN,
+    ARP_RANDOM,
+    ARP_AS_PLAYED,      // Order the keys were pressed in
+    ARP_MODE_COUNT
+};
+
+/// Step length as a note value at the sequencer tempo
+enum ArpRate {
+    ARP_RATE_4,
+    ARP_RATE_8,
+    ARP_RATE_8T,
+    ARP_RATE_16,
+    ARP_RATE_16T,
+    ARP_RATE_32,
+    ARP_RATE_COUNT
+};
+
+enum ChordType {
+    CHORD_OFF,
+    CHORD_MAJOR,
+    CHORD_MINOR,
+    CHORD_MAJ7,
+    CHORD_MIN7,
+    CHORD_MEMORY,       // Holding 2+ keys stores their shape, one key plays it
+    CHORD_TYPE_COUNT
+};
+
+static const char* arpModeNames[] = {"Off", "Up", "Down", "Random", "Played"};
+static const char* arpRateNames[] = {"1/4", "1/8", "1/8T", "1/16", "1/16T", "1/32"};
+static const char* chordTypeNames[] = {"Off", "Major", "Minor", "Maj7", "Min7", "Memory"};
+
+/// A note starting or ending `offset` samples into the block
+struct ArpEvent {
+    uint16_t offset;
+    uint8_t note;
+    uint8_t inst;               // Instrument
+    bool on;
+};
+
+class Arpeggiator {
+public:
+    Arpeggiator();
+    void init(float sampleRate);
+
+    // --- UI core ---
+    void setMode(ArpMode m) { mode = m; }
+    ArpMode getMode() const { return mode; }
+    void setRate(ArpRate r) { rate = r; }
+    ArpRate getRate() const { return rate; }
+    void setGate(float g) { gate = constrain(g, 0.05f, 1.0f); } // Fraction of a step
+    float getGate() const { return gate; }
+    void setChord(ChordType c) { chord = c; }
+    ChordType getChord() const { return chord; }
+    void setTempo(float bpm) { tempo = bpm; }
+    /// Keys go through the stage (false: pads play their note directly)
+    bool isEnabled() const { return mode != ARP_OFF || chord != CHORD_OFF; }
+
+    // --- Audio core ---
+    void keyOn(int note, Instrument inst);
+    void keyOff(int note);
+    /// Forget the keys and notes (the engine has stopped all voices)
+    void reset();
+    /// Events of the next n samples, ordered by offset; returns their count
+    int process(int n, ArpEvent* events, int maxEvents);
+    /// Keys held or notes sounding: the output must not go idle
+    bool isActive() const { return keyCount > 0 || soundingCount > 0; }
+
+private:
+    struct Key {
+        uint8_t note;
+        uint8_t inst;
+    };
+
+    void rebuild();
+    void addNote(int note, uint8_t inst);
+    int nextIndex(ArpMode m);
+    float stepSamples() const;
+
+    // Configuration (UI core)
+    volatile ArpMode mode;
+    volatile ArpRate rate;
+    volatile float gate;
+    volatile ChordType chord;
+    volatile float tempo;           // BPM
+    float samplesPerMinute;
+
+    // Audio core
+    Key keys[ARP_MAX_KEYS];         // Held keys, in the order they were pressed
+    int keyCount;
+    bool keysChanged;
+    ChordType builtChord;           // Chord the note lists were built with
+    int8_t memory[ARP_MAX_CHORD];   // CHORD_MEMORY shape, semitones above its root
+    int memorySize;
+
+    Key played[ARP_MAX_NOTES];      // Expanded notes, in key order
+    Key sorted[ARP_MAX_NOTES];      // Expanded notes, ascending
+    int noteCount;
+
+    Key sounding[ARP_MAX_NOTES];    // Notes the stage has started and not released
+    int soundingCount;
+
+    bool running;                   // Arpeggio clock started
+    float untilStep;                // Samples from the block start to the next step
+    float untilOff;                 // ... to the end of the sounding step's gate
+    int lastNote;                   // Last stepped note (-1 = none)
+    int playedIndex;                // ARP_AS_PLAYED position
+    uint32_t noiseState;            // xorshift state for ARP_RANDOM (deterministic)
+};
+
+#endif
@@ -1,6 +1,9 @@
 #include "AudioEngine.h"
 #include "AudioTools.h"
 #include "AudioTools/AudioLibs/MaximilianDSP.h"
+#ifdef SYNTH_SIM
+#include "SimI2S.h"     // I2SStream stand-in of the desktop simulation (sim/)
+#endif
 #include <math.h>
 
 #ifndef PI
@@ -10,18 +13,46 @@
 // -----------------------------------------------------------------------------
 // Static Maximilian objects - live in .cpp to avoid pulling headers into AudioEngine.h
 // play() is called once per stereo sample at audio rate (e.g. 32000 Hz)
+// and drains a block rendered by AudioEngine::renderBlock()
 // -----------------------------------------------------------------------------
 static audio_tools::I2SStream i2sOut;
 static audio_tools::Maximilian* s_maximilian = nullptr;
-static maxiOsc s_osc[POLYPHONY];
-static maxiFilter s_filter;
 static AudioEngine* g_audioEngine = nullptr;
 
-// DC blocker state (removes droning from filter/osc DC)
-static float s_dcPrevX = 0.0f;
-static float s_dcPrevY = 0.0f;
+#ifdef SYNC_AUDIO_INPUT
+static int16_t s_syncInput[2 * 64];  // Interleaved stereo input frames
+#endif
+
+// DC blocker state per channel (removes droning from filter/osc DC)
+static float s_dcPrevX[2] = {0.0f, 0.0f};
+static float s_dcPrevY[2] = {0.0f, 0.0f};
 static const float DC_COEFF = 0.9992f;
 
+// Written directly to I2S while the output is idle (same size as Maximilian's buffer)
+static const int16_t s_silence[OUTPUT_BUFFER_SIZE / sizeof(int16_t)] = {0};
+static const float s_zeroBlock[RENDER_BLOCK_SIZE] = {0.0f};
+static const uint32_t DMA_FRAMES = I2S_BUFFER_COUNT * I2S_BUFFER_SIZE;
+static Print* s_out = nullptr;
+
+#ifdef SYNTH_PROFILE
+// Times the I2S writes: output conversion cost and DMA queue model
+class ProfiledOutput : public Print {
+public:
+    ProfiledOutput(Print& out, RenderProfiler& profiler) : out(out), profiler(profiler) {}
+    size_t write(const uint8_t* data, size_t len) override {
+        uint32_t start = RenderProfiler::ticks();
+        size_t result = out.write(data, len);
+        profiler.onWrite(start, RenderProfiler::ticks(), result / (2 * sizeof(int16_t)));
+        return result;
+    }
+    size_t write(uint8_t b) override { return out.write(b); }
+private:
+    Print& out;
+    RenderProfiler& profiler;
+};
+static ProfiledOutput* s_profiledOut = nullptr;
+#endif
+
 // Forward declare so we can pass to Maximilian constructor
 void play(maxi_float_t* channels);
 
@@ -42,31 +73,62 @@ void play(maxi_float_t* channels) {
 // AudioEngine
 // -----------------------------------------------------------------------------
 AudioEngine::AudioEngine() {
+    for (int i = 0; i < INST_COUNT; i++)
+        compilePatch(getInstrumentPatch((Instrument)i), ENGINE_SAMPLE_RATE, instrumentPatches[i]);
+    modMatrix.init(ENGINE_SAMPLE_RATE, RENDER_BLOCK_SIZE);
+    arp.init(ENGINE_SAMPLE_RATE);
+    renderOffset = 0;
+    blockFrame = 0;
+    writtenFrames = 0;
+    for (int i = 0; i < ENGINE_MARKERS; i++)
+        markerFrames[i].store(0);
+    clockSeq.store(0);
+    clockFrames = 0;
+    clockUs = 0;
+
+    memset(voices, 0, sizeof(voices));
     for (int i = 0; i < POLYPHONY; i++) {
-        voices[i].active = false;
-        voices[i].releasing = false;
-        voices[i].envelope = 0.0f;
-        voices[i].attacking = false;
-        voices[i].attackEnv = 0.0f;
+        voices[i].instrument = INST_SINE;
+        voices[i].patch = &instrumentPatches[INST_SINE];
     }
-    masterVolume = 0.8f;
-    filterCutoff = 0.5f;
+    masterVolume.init(ENGINE_SAMPLE_RATE);
+    masterVolume.setTarget(0.8f);
+    masterVolume.snap();
+    filterCutoff.init(ENGINE_SAMPLE_RATE);
+    filterCutoff.setTarget(0.5f);
+    filterCutoff.snap();
     visualizerIdx = 0;
-    lpf_state = 0.0f;
+    memset(visualizerBuffer, 0, sizeof(visualizerBuffer));
+    blockPos = RENDER_BLOCK_SIZE;  // Force a render on the first callback
+    silentBlocks = 0;
+    idleFrames = 0;
+    offline = false;
+    offlineAck = false;
+#ifdef SYNTH_LATENCY
+    pendingInputUs = 0;
+    inputPending = false;
+    keyProbe.probed = false;
+#endif
 }
 
 void AudioEngine::init() {
     g_audioEngine = this;
 
     // Match working reference: 32 kHz, 16-bit (default), let Maximilian handle writes
+#ifdef SYNC_AUDIO_INPUT
+    auto cfg = i2sOut.defaultConfig(audio_tools::RXTX_MODE);
+    cfg.pin_data_rx = I2S_DIN;
+#else
     auto cfg = i2sOut.defaultConfig(audio_tools::TX_MODE);
-    cfg.sample_rate = 32000;
+#endif
+    cfg.sample_rate = ENGINE_SAMPLE_RATE;
     cfg.channels = 2;
     cfg.pin_bck = I2S_BCLK;
     cfg.pin_ws = I2S_LRC;
     cfg.pin_data = I2S_DOUT;
     cfg.is_master = true;
-    cfg.buffer_size = 256;
+    cfg.buffer_count = I2S_BUFFER_COUNT;
+    cfg.buffer_size = I2S_BUFFER_SIZE;
 
     if (!i2sOut.begin(cfg)) {
         Serial.println("[AudioEngine] I2S begin FAILED");
@@ -75,36 +137,150 @@ void AudioEngine::init() {
     Serial.println("[AudioEngine] I2S started @ 32 kHz");
 
     // Use Maximilian wrapper (handles buffer + I2S writes)
-    s_maximilian = new audio_tools::Maximilian(i2sOut);
+#ifdef SYNTH_PROFILE
+    profiler.init(ENGINE_SAMPLE_RATE, RENDER_BLOCK_SIZE, DMA_FRAMES);
+    s_profiledOut = new ProfiledOutput(i2sOut, profiler);
+    s_out = s_profiledOut;
+#else
+    s_out = &i2sOut;
+#endif
+#ifdef SYNTH_LATENCY
+    latency.init(ENGINE_SAMPLE_RATE, cfg.buffer_count * cfg.buffer_size);
+#endif
+    s_maximilian = new audio_tools::Maximilian(*s_out, OUTPUT_BUFFER_SIZE);
     s_maximilian->begin(cfg);
-    s_maximilian->setVolume(1.0f);  // we apply volume in playCallback
+    s_maximilian->setVolume(1.0f);  // Stays at 1.0: masterVolume is applied in renderBlock()
+
+    if (!spectrum.init(ENGINE_SAMPLE_RATE))
+        Serial.println("[AudioEngine] Spectrum FFT allocation FAILED");
+    beatTracker.init(ENGINE_SAMPLE_RATE);
 
     resetFilterState();
+
+    if (!renderPool.begin(RENDER_GROUPS))
+        Serial.printf("[AudioEngine] Parallel render FAILED, %d of %d voice groups\n",
+                      renderPool.getGroups(), RENDER_GROUPS);
 }
 
 void AudioEngine::copy() {
+    if (offline) {
+        // An offline render owns the engine: keep the DMA fed with silence
+        offlineAck = true;
+        if (s_out) {
+            s_out->write((const uint8_t*)s_silence, sizeof(s_silence));
+            onOutputWritten();
+        }
+        return;
+    }
+
+    PROFILE_MARK(copyStart);
+    // On a block boundary the next block starts at the next frame written
+    if (blockPos >= RENDER_BLOCK_SIZE)
+        blockFrame = writtenFrames;
+    if (s_maximilian) {
+        if (blockPos >= RENDER_BLOCK_SIZE && isOutputIdle()) {
+            // Nothing playing and the tails have settled: write the zeroed buffer
+            // as is and skip the per-sample callbacks. The I2S write blocks, so
+            // the audio core mostly sleeps; control state still advances per block.
+            idleFrames += sizeof(s_silence) / (2 * sizeof(int16_t));
+            while (idleFrames >= RENDER_BLOCK_SIZE) {
+                idleBlock(RENDER_BLOCK_SIZE);
+                idleFrames -= RENDER_BLOCK_SIZE;
+            }
+            s_out->write((const uint8_t*)s_silence, sizeof(s_silence));
+        } else {
+            s_maximilian->copy();
+        }
+    }
+    PROFILE_END_COPY(profiler, copyStart);
     if (s_maximilian)
-        s_maximilian->copy();
+        onOutputWritten();
+
+#ifdef SYNC_AUDIO_INPUT
+    // Input and output share the bit clock: each buffer written out means one
+    // buffer of input frames has arrived, so this read does not wait
+    if (s_maximilian && beatTracker.isEnabled()) {
+        size_t pending = OUTPUT_BUFFER_SIZE;
+        while (pending > 0) {
+            size_t got = i2sOut.readBytes((uint8_t*)s_syncInput, min(pending, sizeof(s_syncInput)));
+            if (got == 0) break;
+            beatTracker.capture(s_syncInput, got / (2 * sizeof(int16_t)));
+            pending -= got;
+        }
+    }
+#endif
+}
+
+/// After each I2S write: moves the output clock on
+void AudioEngine::onOutputWritten() {
+    writtenFrames += OUTPUT_BUFFER_SIZE / (2 * sizeof(int16_t));
+    uint32_t now = micros();
+    clockSeq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    clockFrames = writtenFrames;
+    clockUs = now;
+    clockSeq.fetch_add(1, std::memory_order_release);
+#ifdef SYNTH_LATENCY
+    latency.onWrite(writtenFrames, now);
+#endif
+}
+
+uint32_t AudioEngine::getOutputFrame(uint32_t us) {
+    uint32_t frames, at;
+    // Retry while the audio core is updating
+    for (;;) {
+        uint32_t before = clockSeq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        frames = clockFrames;
+        at = clockUs;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (clockSeq.load(std::memory_order_relaxed) == before) break;
+    }
+    // A blocking write returns once the DMA queue has room, so the queue was
+    // full: the DAC played frame `frames - DMA_FRAMES` when the write returned
+    int32_t elapsed = (int32_t)(us - at);
+    return frames - DMA_FRAMES + (int32_t)(elapsed * (ENGINE_SAMPLE_RATE / 1.0e6f));
 }
 
 void AudioEngine::setVolume(int vol) {
     if (vol < 0) vol = 0;
     if (vol > 100) vol = 100;
-    masterVolume = vol / 100.0f;
-    if (s_maximilian)
-        s_maximilian->setVolume(masterVolume);
+    masterVolume.setTarget(vol / 100.0f);
 }
 
 int AudioEngine::getVolume() {
-    return (int)(masterVolume * 100);
+    return (int)(masterVolume.getTarget() * 100 + 0.5f);
 }
 
 void AudioEngine::setFilterCutoff(float cutoff) {
-    filterCutoff = constrain(cutoff, 0.0f, 1.0f);
+    filterCutoff.setTarget(constrain(cutoff, 0.0f, 1.0f));
 }
 
 float AudioEngine::getFilterCutoff() {
-    return filterCutoff;
+    return filterCutoff.getTarget();
+}
+
+void AudioEngine::setDrive(float amount) {
+    drive.setAmount(amount);
+}
+
+float AudioEngine::getDrive() {
+    return drive.getAmount();
+}
+
+void AudioEngine::setDriveQuality(DriveQuality q) {
+    drive.setQuality(q);
+}
+
+DriveQuality AudioEngine::getDriveQuality() {
+    return drive.getQuality();
+}
+
+/// Scale applied to every patch cutoff. 1.0 at the default 50% setting, and the
+/// same 200-2200 Hz sweep the old master filter had for 1.2 kHz patches.
+/// Kernel coefficients are per block, so the smoothed cutoff moves per block.
+float AudioEngine::cutoffScale() {
+    return (200.0f + filterCutoff.getValue() * 2000.0f) / 1200.0f;
 }
 
 float AudioEngine::getVisualizerLevel() {
@@ -117,96 +293,421 @@ float AudioEngine::getVisualizerLevel() {
 }
 
 void AudioEngine::playCallback(float* channels) {
-    // Always call all oscillators (keep them free-running even when silent)
-    // to avoid phase discontinuities - match reference implementation
-    
-    float sampleMix = 0.0f;
-    int activeCount = 0;
+    if (blockPos >= RENDER_BLOCK_SIZE) {
+        renderBlock(blockL, blockR, RENDER_BLOCK_SIZE);
+        blockPos = 0;
+    }
+    channels[0] = blockL[blockPos];
+    channels[1] = blockR[blockPos];
+    blockPos++;
+}
+
+/// True while no voice plays, no note is about to start and the master chain
+/// has settled to silence
+bool AudioEngine::isOutputIdle() {
+    NoteCommand next;
+    return silentBlocks >= SILENCE_HOLD_BLOCKS && getActiveVoiceCount() == 0 &&
+           !arp.isActive() && !commands.peek(next);
+}
+
+/// One block of idle output: no voice or master processing, only the LFOs and
+/// the free-running voice phases move on, and the spectrum sees silence
+void AudioEngine::idleBlock(int n) {
+    PROFILE_MARK(blockStart);
+    PROFILE_MARK(mark);
+    modMatrix.tick();
+    masterVolume.next(n);
+    filterCutoff.next(n);
+    for (int v = 0; v < POLYPHONY; v++)
+        if (!voices[v].active) advanceVoicePhase(voices[v].dsp, n);
+    spectrum.capture(s_zeroBlock, s_zeroBlock, n);
+    blockFrame += n;
+    PROFILE_STAGE(profiler, PROFILE_MASTER, mark);
+    PROFILE_END_BLOCK(profiler, blockStart);
+}
+
+void AudioEngine::renderBlock(float* outL, float* outR, int n) {
+    memset(outL, 0, n * sizeof(float));
+    memset(outR, 0, n * sizeof(float));
+
+    // Queued notes start with the block, the arpeggiator's on their sample
+    applyCommands();
+    int events = arp.process(n, arpEvents, ARP_MAX_EVENTS);
+    if (events == 0 && isOutputIdle()) {
+        idleBlock(n);
+        return;
+    }
+
+    PROFILE_MARK(blockStart);
+    PROFILE_MARK(mark);
+
+    // Control rate: LFOs and global destinations once per block
+    modMatrix.tick();
+    filterCutoff.next(n);
+    PROFILE_STAGE(profiler, PROFILE_MOD, mark);
 
+    // Each active voice runs its patch's specialized kernel over the whole block;
+    // the voice groups render in parallel and are summed at the block barrier.
+    // Arpeggiator events split the block: voices render up to the event's
+    // sample, the event starts or releases its voice, and rendering goes on.
+    int activeCount = 0;
+    int start = 0;
+    for (int e = 0; e <= events; e++) {
+        int end = e < events ? arpEvents[e].offset : n;
+        if (end > start) {
+            renderOffset = start;
+            activeCount = max(activeCount, renderPool.render(renderGroup, this, outL + start, outR + start, end - start));
+            start = end;
+        }
+        if (e < events) applyArpEvent(arpEvents[e]);
+    }
+#ifdef SYNTH_LATENCY
+    keyProbe.probed = false;
     for (int v = 0; v < POLYPHONY; v++) {
-        float freq = voices[v].frequency;
-        if (freq < 20.0f) freq = 220.0f;  // valid freq for free-running
-        
-        // Always call oscillator to keep phase continuous
-        float out = 0.0f;
-        switch (voices[v].instrument) {
-            case INST_SINE:
-                out = s_osc[v].sinewave(freq);
-                break;
-            case INST_SQUARE:
-                out = s_osc[v].square(freq);
-                break;
-            case INST_SAW:
-                out = s_osc[v].sawn(freq);
-                break;
-            case INST_TRIANGLE:
-                out = s_osc[v].triangle(freq);
-                break;
-            case INST_PLUCK:
-            case INST_BASS:
-                out = s_osc[v].sawn(freq);
-                break;
-            case INST_PAD:
-            case INST_LEAD:
-                out = s_osc[v].pulse(freq, 0.3f);
-                break;
-            default:
-                out = s_osc[v].sinewave(freq);
-                break;
+        if (voices[v].probe.state == PROBE_AUDIBLE) {
+            latency.audible(voices[v].probe);
+            voices[v].probe.state = PROBE_IDLE;
         }
-        
-        // Only output if voice is active (gate logic - no complex envelopes)
-        if (voices[v].active) {
-            sampleMix += out;
-            activeCount++;
+    }
+#endif
+    PROFILE_STAGE(profiler, PROFILE_VOICES, mark);
+
+    // Average voices, then scale (match reference output level)
+    float gain = 0.3f * max(0.0f, 1.0f + modMatrix.getGlobal(MOD_DST_MASTER_GAIN));
+    if (activeCount > 1)
+        gain /= (float)activeCount;
+
+    float volumeRamp[RENDER_BLOCK_SIZE];
+    if (masterVolume.ramp(volumeRamp, n)) {
+        // Volume change in progress: per-sample gain
+        for (int i = 0; i < n; i++) {
+            float g = gain * volumeRamp[i];
+            outL[i] *= g;
+            outR[i] *= g;
+        }
+    } else {
+        gain *= masterVolume.getValue();
+        for (int i = 0; i < n; i++) {
+            outL[i] *= gain;
+            outR[i] *= gain;
         }
     }
 
+    PROFILE_STAGE(profiler, PROFILE_MASTER, mark);
+
+    // Oversampled drive (bypassed at 0)
+    drive.process(outL, outR, n, modMatrix.getGlobal(MOD_DST_DRIVE));
+    PROFILE_STAGE(profiler, PROFILE_FX, mark);
+
+    float* outs[2] = {outL, outR};
+    for (int ch = 0; ch < 2; ch++) {
+        float* out = outs[ch];
+        float px = s_dcPrevX[ch];
+        float py = s_dcPrevY[ch];
+        for (int i = 0; i < n; i++) {
+            // DC blocker
+            float x = out[i];
+            float y = x - px + DC_COEFF * py;
+            px = x;
+            py = y;
+
+            // Soft clip
+            if (y > 0.9f) y = 0.9f;
+            if (y < -0.9f) y = -0.9f;
+            out[i] = y;
+        }
+        s_dcPrevX[ch] = px;
+        s_dcPrevY[ch] = py;
+    }
+
+    // Without voices the drive and DC blocker tails still decay through the
+    // chain; once they stay inaudible the state is cleared and output goes idle
     if (activeCount == 0) {
-        channels[0] = 0.0f;
-        channels[1] = 0.0f;
-        s_dcPrevX = 0.0f;
-        s_dcPrevY = 0.0f;
-        visualizerBuffer[visualizerIdx] = 0.0f;
+        float peak = 0.0f;
+        for (int i = 0; i < n; i++) {
+            peak = max(peak, fabsf(outL[i]));
+            peak = max(peak, fabsf(outR[i]));
+        }
+        if (peak >= SILENCE_THRESHOLD)
+            silentBlocks = 0;
+        else if (++silentBlocks >= SILENCE_HOLD_BLOCKS)
+            resetFilterState();
+    } else {
+        silentBlocks = 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        visualizerBuffer[visualizerIdx] = 0.5f * (outL[i] + outR[i]);
         visualizerIdx = (visualizerIdx + 1) % 128;
-        return;
     }
+    spectrum.capture(outL, outR, n);
+    blockFrame += n;
+    PROFILE_STAGE(profiler, PROFILE_MASTER, mark);
+    PROFILE_END_BLOCK(profiler, blockStart);
+}
 
-    // Average voices
-    if (activeCount > 1)
-        sampleMix /= (float)activeCount;
+int AudioEngine::renderGroup(void* engine, int group, float* outL, float* outR, int n) {
+    return static_cast<AudioEngine*>(engine)->renderVoices(group, outL, outR, n);
+}
 
-    // Filter (match reference: lores with low resonance)
-    float cutoffHz = 200.0f + filterCutoff * 2000.0f;
-    sampleMix = s_filter.lores(sampleMix, cutoffHz, 0.1);
+int AudioEngine::renderVoices(int group, float* outL, float* outR, int n) {
+    int activeCount = 0;
+    float dst[MOD_DST_COUNT];
+    VoiceMod mod;
+    mod.cutoffScale = cutoffScale();
+    for (int v = group; v < POLYPHONY; v += renderPool.getGroups()) {
+        Voice& voice = voices[v];
+        if (!voice.active) {
+            // Not rendered: keep the oscillator free-running for the next note
+            advanceVoicePhase(voice.dsp, n);
+            continue;
+        }
 
-    // Scale (match reference output level)
-    sampleMix *= 0.3f * masterVolume;
+        modMatrix.evaluateVoice(voice.patch->patch->mods, voice.dsp.env, voice.velocity, dst);
+        mod.pitch = dst[MOD_DST_PITCH];
+        mod.cutoff = dst[MOD_DST_CUTOFF];
+        mod.amp = dst[MOD_DST_AMP];
+        mod.pan = dst[MOD_DST_PAN];
+
+        bool alive;
+#ifdef SYNTH_LATENCY
+        if (voice.probe.state == PROBE_WAITING)
+            alive = renderProbed(voice, mod, outL, outR, n);
+        else
+#endif
+            alive = voice.patch->render(voice.dsp, *voice.patch, mod, outL, outR, n);
+        if (!alive)
+            voice.active = false;
+        voice.envelope = voice.dsp.env;
+        activeCount++;
+    }
+    return activeCount;
+}
+
+#ifdef SYNTH_LATENCY
+/// Renders a probed voice on its own to find its first audible sample, then
+/// mixes it in like any other voice
+bool AudioEngine::renderProbed(Voice& voice, const VoiceMod& mod, float* outL, float* outR, int n) {
+    float soloL[RENDER_BLOCK_SIZE] = {0.0f};
+    float soloR[RENDER_BLOCK_SIZE] = {0.0f};
+    bool alive = voice.patch->render(voice.dsp, *voice.patch, mod, soloL, soloR, n);
+    int first = LatencyProbe::firstAudible(soloL, soloR, n);
+    if (first >= 0) {
+        voice.probe.frame = blockFrame + renderOffset + first;
+        voice.probe.state = PROBE_AUDIBLE;
+    }
+    for (int i = 0; i < n; i++) {
+        outL[i] += soloL[i];
+        outR[i] += soloR[i];
+    }
+    return alive;
+}
 
-    // DC blocker
-    float x = sampleMix;
-    float y = x - s_dcPrevX + DC_COEFF * s_dcPrevY;
-    s_dcPrevX = x;
-    s_dcPrevY = y;
+void AudioEngine::markInput(uint32_t edgeUs) {
+    pendingInputUs = edgeUs;
+    inputPending = true;
+}
 
-    // Soft clip
-    if (y > 0.9f) y = 0.9f;
-    if (y < -0.9f) y = -0.9f;
+/// Hands a pad press stamp to the voice that plays the note; renderVoices()
+/// picks it up from the voice's next sample on
+void AudioEngine::startProbe(Voice& voice, const NoteCommand& cmd) {
+    voice.probe.inputUs = cmd.inputUs;
+    voice.probe.noteOnUs = cmd.noteOnUs;
+    voice.probe.state = PROBE_WAITING;
+}
+#endif
 
-    channels[0] = y;
-    channels[1] = y;
+bool AudioEngine::beginOffline() {
+    offlineAck = false;
+    offline = true;
+    // Wait for the audio task to leave the engine (if it runs at all). Without
+    // the ack it may be inside renderBlock(): give the engine back untouched.
+    if (s_maximilian) {
+        unsigned long start = millis();
+        while (!offlineAck) {
+            if (millis() - start >= OFFLINE_ACK_TIMEOUT_MS) {
+                offline = false;
+                Serial.println("[AudioEngine] Offline render FAILED: audio task did not stop");
+                return false;
+            }
+            delay(1);
+        }
+    }
 
-    visualizerBuffer[visualizerIdx] = y;
-    visualizerIdx = (visualizerIdx + 1) % 128;
+    applyCommands();
+    stopAllVoices();
+    for (int i = 0; i < POLYPHONY; i++)
+        voices[i].dsp.phase = 0.0f;
+    modMatrix.resetPhases();
+    masterVolume.snap();
+    filterCutoff.snap();
+    blockPos = RENDER_BLOCK_SIZE;
+    silentBlocks = 0;
+    return true;
 }
 
-void AudioEngine::noteOn(int note, Instrument inst) {
+void AudioEngine::renderOffline(int16_t* frames, int count) {
+    float channels[2];
+    for (int i = 0; i < count; i++) {
+        playCallback(channels);
+        // Same conversion as Maximilian::copy() at volume 1.0
+        frames[2 * i] = channels[0] * 32767.0f;
+        frames[2 * i + 1] = channels[1] * 32767.0f;
+    }
+}
+
+void AudioEngine::endOffline() {
+    applyCommands();
+    stopAllVoices();
+    blockPos = RENDER_BLOCK_SIZE;
+    offline = false;
+}
+
+uint32_t AudioEngine::benchmarkRender(Instrument inst, int notes, int blocks) {
+    Voice saved[POLYPHONY];
+    memcpy(saved, voices, sizeof(voices));
+
+    stopAllVoices();
+    for (int i = 0; i < notes && i < POLYPHONY; i++) {
+        NoteCommand cmd = {NOTE_CMD_ON, (uint8_t)(48 + i * 4), (uint8_t)inst, 1.0f};
+        startNote(cmd);
+    }
+
+    float l[RENDER_BLOCK_SIZE];
+    float r[RENDER_BLOCK_SIZE];
+    uint64_t start = renderClockUs();
+    for (int b = 0; b < blocks; b++)
+        renderBlock(l, r, RENDER_BLOCK_SIZE);
+    uint32_t elapsed = (uint32_t)(renderClockUs() - start);
+
+    memcpy(voices, saved, sizeof(voices));
+    resetFilterState();
+#ifdef SYNTH_PROFILE
+    profiler.requestReset();
+#endif
+    return blocks > 0 ? elapsed / blocks : 0;
+}
+
+bool AudioEngine::benchmark(Print& out) {
+    uint32_t budgetUs = (uint32_t)(1000000ULL * RENDER_BLOCK_SIZE / ENGINE_SAMPLE_RATE);
+    uint32_t padUs = 0;
+    for (int inst = 0; inst < INST_COUNT; inst++) {
+        uint32_t us = benchmarkRender((Instrument)inst, 4, 500);
+        if (inst == INST_PAD) padUs = us;
+        out.printf("[Bench] %-8s x4: %4u us/block (budget %u us, %u%%)\n",
+                   instrumentNames[inst], us, budgetUs, us * 100 / budgetUs);
+    }
+    bool fits = padUs <= budgetUs;
+    if (!fits) out.println("[Bench] FAILED: Pad x4 over the block budget");
+    return fits;
+}
+
+// -----------------------------------------------------------------------------
+// Note queue - the UI core sends, the audio core applies at its next block
+// -----------------------------------------------------------------------------
+void AudioEngine::noteOn(int note, Instrument inst, float velocity) {
+    NoteCommand cmd = {NOTE_CMD_ON, (uint8_t)note, (uint8_t)inst, velocity};
+    send(cmd);
+}
+
+void AudioEngine::noteOff(int note) {
+    NoteCommand cmd = {NOTE_CMD_OFF, (uint8_t)note};
+    send(cmd);
+}
+
+void AudioEngine::killAll() {
+    NoteCommand cmd = {NOTE_CMD_KILL_ALL};
+    send(cmd);
+}
+
+void AudioEngine::keyOn(int note, Instrument inst) {
+    NoteCommand cmd = {NOTE_CMD_KEY_ON, (uint8_t)note, (uint8_t)inst, 1.0f};
+    send(cmd);
+}
+
+void AudioEngine::keyOff(int note) {
+    NoteCommand cmd = {NOTE_CMD_KEY_OFF, (uint8_t)note};
+    send(cmd);
+}
+
+void AudioEngine::sendMarker(int id) {
+    NoteCommand cmd = {NOTE_CMD_MARKER, (uint8_t)id};
+    send(cmd);
+}
+
+void AudioEngine::send(NoteCommand& cmd) {
+#ifdef SYNTH_LATENCY
+    // Only notes that answer a markInput() are probed
+    cmd.probed = inputPending && (cmd.type == NOTE_CMD_ON || cmd.type == NOTE_CMD_KEY_ON);
+    if (cmd.probed) {
+        inputPending = false;
+        cmd.inputUs = pendingInputUs;
+        cmd.noteOnUs = micros();
+    }
+#endif
+    commands.write(cmd);
+}
+
+void AudioEngine::applyCommands() {
+    NoteCommand cmd;
+    while (commands.read(cmd)) {
+        switch (cmd.type) {
+        case NOTE_CMD_ON:
+            startNote(cmd);
+            break;
+        case NOTE_CMD_OFF:
+            releaseNote(cmd.note);
+            break;
+        case NOTE_CMD_KEY_ON:
+            arp.keyOn(cmd.note, (Instrument)cmd.inst);
+#ifdef SYNTH_LATENCY
+            // Measured on the first stage note of this block
+            if (cmd.probed) keyProbe = cmd;
+#endif
+            break;
+        case NOTE_CMD_KEY_OFF:
+            arp.keyOff(cmd.note);
+            break;
+        case NOTE_CMD_KILL_ALL:
+            stopAllVoices();
+            break;
+        case NOTE_CMD_MARKER:
+            // An offline render's frames are not output frames
+            if (cmd.note < ENGINE_MARKERS && !offline)
+                markerFrames[cmd.note].store(blockFrame, std::memory_order_relaxed);
+            break;
+        }
+    }
+}
+
+void AudioEngine::applyArpEvent(const ArpEvent& event) {
+    if (!event.on) {
+        releaseNote(event.note);
+        return;
+    }
+    NoteCommand cmd = {NOTE_CMD_ON, event.note, event.inst, 1.0f};
+#ifdef SYNTH_LATENCY
+    if (keyProbe.probed) {
+        cmd = keyProbe;
+        cmd.note = event.note;
+        cmd.inst = event.inst;
+        keyProbe.probed = false;
+    }
+#endif
+    startNote(cmd);
+}
+
+void AudioEngine::startNote(const NoteCommand& cmd) {
+    int note = cmd.note;
     for (int i = 0; i < POLYPHONY; i++) {
         if (voices[i].active && voices[i].note == note) {
+            // Retrigger from the current level (no click)
             voices[i].releasing = false;
-            voices[i].attacking = true;
-            voices[i].attackEnv = voices[i].envelope * voices[i].attackEnv;
-            if (voices[i].attackEnv < 0.01f) voices[i].attackEnv = 0.01f;
+            voices[i].velocity = cmd.velocity;
+            voices[i].dsp.envStage = ENV_STAGE_ATTACK;
+#ifdef SYNTH_LATENCY
+            if (cmd.probed) startProbe(voices[i], cmd);
+#endif
             return;
         }
     }
@@ -214,35 +715,57 @@ void AudioEngine::noteOn(int note, Instrument inst) {
     int v = findFreeVoice();
     if (v == -1) return;
 
-    voices[v].active = true;
-    voices[v].releasing = false;
-    voices[v].note = note;
-    voices[v].frequency = midiToFreq(note);
-    voices[v].instrument = inst;
-    voices[v].envelope = 1.0f;
-    
-    // Oscillators free-run (no phase reset) - smooth continuous phase like reference
+    Voice& voice = voices[v];
+    voice.releasing = false;
+    voice.note = note;
+    voice.frequency = midiToFreq(note);
+    voice.instrument = (Instrument)cmd.inst;
+    voice.velocity = cmd.velocity;
+    voice.patch = &instrumentPatches[cmd.inst];
+    voice.dsp.baseInc = voice.frequency / (float)ENGINE_SAMPLE_RATE;
+    voice.dsp.f1 = 0.0f;
+    voice.dsp.f2 = 0.0f;
+    voice.dsp.fR1 = 0.0f;
+    voice.dsp.fR2 = 0.0f;
+    resetVoicePhases(voice.dsp, *voice.patch);
+    voice.dsp.env = 0.0f;
+    voice.dsp.gainL = 0.0f;
+    voice.dsp.gainR = 0.0f;
+    voice.dsp.envStage = ENV_STAGE_ATTACK;
+    voice.envelope = 0.0f;
+#ifdef SYNTH_LATENCY
+    voice.probe.state = PROBE_IDLE;
+    if (cmd.probed) startProbe(voice, cmd);
+#endif
+    voice.active = true;
 }
 
-void AudioEngine::noteOff(int note) {
+void AudioEngine::releaseNote(int note) {
     for (int i = 0; i < POLYPHONY; i++) {
-        if (voices[i].active && voices[i].note == note)
-            voices[i].active = false;  // instant off (oscillator keeps running)
+        if (voices[i].active && voices[i].note == note && !voices[i].releasing) {
+            voices[i].releasing = true;
+            voices[i].dsp.envStage = ENV_STAGE_RELEASE;  // Voice frees itself when the envelope ends
+        }
     }
 }
 
-void AudioEngine::killAll() {
+void AudioEngine::stopAllVoices() {
     for (int i = 0; i < POLYPHONY; i++) {
         voices[i].active = false;
         voices[i].releasing = false;
+        voices[i].dsp.envStage = ENV_STAGE_IDLE;
+        voices[i].dsp.env = 0.0f;
     }
+    arp.reset();
     resetFilterState();
 }
 
 void AudioEngine::resetFilterState() {
-    lpf_state = 0.0f;
-    s_dcPrevX = 0.0f;
-    s_dcPrevY = 0.0f;
+    drive.reset();
+    for (int ch = 0; ch < 2; ch++) {
+        s_dcPrevX[ch] = 0.0f;
+        s_dcPrevY[ch] = 0.0f;
+    }
 }
 
 int AudioEngine::getActiveVoiceCount() {
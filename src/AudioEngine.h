@@ -2,18 +2,61 @@
 #define AUDIO_ENGINE_H
 
 #include <Arduino.h>
+#include <atomic>
 #include "Config.h"
+#include "Patch.h"
+#include "ModMatrix.h"
+#include "Drive.h"
+#include "Spectrum.h"
+#include "BeatTracker.h"
+#include "Profiler.h"
+#include "Latency.h"
+#include "RenderPool.h"
+#include "Arpeggiator.h"
+#include "AudioTools/Concurrency/LockFree/RingBufferLockFree.h"
+#include "SmoothedParam.h"
+
+// Note commands waiting for the audio core. Held launchpad pads
+// retrigger every loop(), up to ~10 per pad during one Maximilian buffer.
+#define NOTE_QUEUE_SIZE 256
+#define ENGINE_MARKERS 16           // Output-clock markers (one per sequencer step)
+#define OFFLINE_ACK_TIMEOUT_MS 100  // Wait for the audio task to leave the engine
 
 struct Voice {
     float frequency;
     int note;
-    float amplitude;
     bool active;
     bool releasing;
     Instrument instrument;
-    float envelope;
-    bool attacking;
-    float attackEnv;
+    float envelope;                 // Mirror of dsp.env, updated once per block
+    float velocity;                 // 0.0-1.0, modulation source
+    const CompiledPatch* patch;
+    VoiceDSP dsp;
+#ifdef SYNTH_LATENCY
+    VoiceProbe probe;
+#endif
+};
+
+enum NoteCommandType {
+    NOTE_CMD_ON,
+    NOTE_CMD_OFF,
+    NOTE_CMD_KEY_ON,                // Through the arpeggiator / chord stage
+    NOTE_CMD_KEY_OFF,
+    NOTE_CMD_KILL_ALL,
+    NOTE_CMD_MARKER                 // Stamps marker `note` with the block's output frame
+};
+
+/// A note change from the UI core, applied at the start of the next block
+struct NoteCommand {
+    uint8_t type;                   // NoteCommandType
+    uint8_t note;
+    uint8_t inst;                   // Instrument
+    float velocity;
+#ifdef SYNTH_LATENCY
+    bool probed;                    // Answers a markInput()
+    uint32_t inputUs;
+    uint32_t noteOnUs;
+#endif
 };
 
 class AudioEngine {
@@ -23,9 +66,22 @@ public:
     /// Called from loop() - fills buffer via play() and writes to I2S (AudioTools + Maximilian)
     void copy();
 
-    void noteOn(int note, Instrument inst);
+    // Notes: queued here, the audio core applies them at its next block and
+    // is the only one to touch the voices
+    void noteOn(int note, Instrument inst, float velocity = 1.0f);
     void noteOff(int note);
     void killAll();
+    /// Played keys: through the arpeggiator / chord stage
+    void keyOn(int note, Instrument inst);
+    void keyOff(int note);
+
+    // Output clock: frames count the audio written to I2S, so a frame number
+    // is a time on the same clock the music is played on
+    /// Marker `id` gets the output frame where the notes sent before it start
+    void sendMarker(int id);
+    uint32_t getMarkerFrame(int id) { return markerFrames[id].load(std::memory_order_relaxed); }
+    /// Output frame at the DAC at micros() time `us` (recent times only)
+    uint32_t getOutputFrame(uint32_t us);
     int getActiveVoiceCount();
 
     void setVolume(int vol); // 0-100
@@ -35,8 +91,53 @@ public:
     void setFilterCutoff(float cutoff); // 0.0-1.0
     float getFilterCutoff();
 
+    void setDrive(float amount); // 0.0-1.0, 0 = bypass
+    float getDrive();
+    void setDriveQuality(DriveQuality q); // Oversampling factor vs CPU
+    DriveQuality getDriveQuality();
+
+    /// LFOs and engine-wide routes; configure from the UI core, read once per block by the audio core
+    ModMatrix& getModMatrix() { return modMatrix; }
+    /// Arpeggiator / chord memory; configure from the UI core, read once per block by the audio core
+    Arpeggiator& getArpeggiator() { return arp; }
+
+    /// Output spectrum; enable it while a view needs it, update() and read from the UI core
+    SpectrumAnalyzer& getSpectrum() { return spectrum; }
+    /// Tempo/beat of the sync input (SYNC_AUDIO_INPUT); enable and update() from the UI core
+    BeatTracker& getBeatTracker() { return beatTracker; }
+#ifdef SYNTH_PROFILE
+    /// Render path timing; read reports from the UI core
+    RenderProfiler& getProfiler() { return profiler; }
+#endif
+#ifdef SYNTH_LATENCY
+    /// Pad-to-sound latency; read reports from the UI core
+    LatencyProbe& getLatencyProbe() { return latency; }
+    /// The next noteOn() / keyOn() answers a pad edge at edgeUs (micros); call right before it
+    void markInput(uint32_t edgeUs);
+#endif
+
     /// Called once per stereo sample by Maximilian (audio rate) - pure DSP, no I/O
     void playCallback(float* channels);
+    /// Render n stereo samples of the full voice + master chain (n <= RENDER_BLOCK_SIZE)
+    void renderBlock(float* outL, float* outR, int n);
+
+    // Offline rendering (bounce). While active, copy() only outputs silence, so
+    // the caller owns the engine. beginOffline() starts from a reset state
+    // (voices, filters, LFO and oscillator phases), which makes renders repeatable.
+    /// False when the audio task did not acknowledge within OFFLINE_ACK_TIMEOUT_MS;
+    /// the engine is then left live and untouched, and endOffline() is not needed.
+    bool beginOffline();
+    /// Render count frames as interleaved 16-bit stereo, as the live output would
+    void renderOffline(int16_t* frames, int count);
+    void endOffline();
+    bool isOffline() const { return offline; }
+
+    /// Time `blocks` render blocks with `notes` voices of one instrument held.
+    /// Returns average microseconds per block; call before the audio task starts.
+    uint32_t benchmarkRender(Instrument inst, int notes, int blocks);
+    /// Prints every instrument x4 against the block period. False when the
+    /// worst case, 4 Pad notes x 5 unison lanes, does not fit the period.
+    bool benchmark(Print& out);
 
     const float* getWaveform() { return visualizerBuffer; }
     /// Ring-buffer write head: UI should read (getWaveformRingIndex() + i) % 128 for time order
@@ -44,17 +145,72 @@ public:
 
 private:
     Voice voices[POLYPHONY];
+    CompiledPatch instrumentPatches[INST_COUNT];
+    ModMatrix modMatrix;
+    Drive drive;
+    SpectrumAnalyzer spectrum;
+    BeatTracker beatTracker;
+    RenderPool renderPool;
+    Arpeggiator arp;
+    audio_tools::RingBufferLockFree<NoteCommand> commands{NOTE_QUEUE_SIZE};
+    ArpEvent arpEvents[ARP_MAX_EVENTS];
+    int renderOffset;               // Start of the sub-block being rendered
+    uint32_t blockFrame;            // Output frame index of the block being rendered
+    uint32_t writtenFrames;         // Frames written to I2S
+    std::atomic<uint32_t> markerFrames[ENGINE_MARKERS];
+    // Last I2S write (frames written, micros() when it returned); odd while updating
+    std::atomic<uint32_t> clockSeq;
+    uint32_t clockFrames;
+    uint32_t clockUs;
+#ifdef SYNTH_PROFILE
+    RenderProfiler profiler;
+#endif
+#ifdef SYNTH_LATENCY
+    LatencyProbe latency;
+    uint32_t pendingInputUs;        // markInput() stamp for the next noteOn()
+    bool inputPending;
+    NoteCommand keyProbe;           // Stamps of a key, for the first stage note of its block
+    void startProbe(Voice& voice, const NoteCommand& cmd);
+    bool renderProbed(Voice& voice, const VoiceMod& mod, float* outL, float* outR, int n);
+#endif
     float midiToFreq(int note);
     int findFreeVoice();
 
-    float masterVolume;
-    float filterCutoff;
+    // Audio core (or the owner of an offline render)
+    void send(NoteCommand& cmd);
+    void applyCommands();
+    void applyArpEvent(const ArpEvent& event);
+    void startNote(const NoteCommand& cmd);
+    void releaseNote(int note);
+    void stopAllVoices();
+    void onOutputWritten();
+
+    // Set by the UI, ramped by the audio core (no zipper noise on 5% steps)
+    SmoothedParam masterVolume;
+    SmoothedParam filterCutoff;
 
     float visualizerBuffer[128];
     int visualizerIdx;
 
-    float lpf_state;
+    float blockL[RENDER_BLOCK_SIZE];
+    float blockR[RENDER_BLOCK_SIZE];
+    int blockPos;
+
+    // Silence detector: blocks in a row with no voices and a master peak below
+    // SILENCE_THRESHOLD. From SILENCE_HOLD_BLOCKS on the output is idle.
+    int silentBlocks;
+    int idleFrames;                 // Frames written by copy() while idle, not yet ticked
+
+    volatile bool offline;          // Set by beginOffline()
+    volatile bool offlineAck;       // copy() has seen it and stays out of the engine
+
+    /// Voices v with v % groups == group, rendered by the audio task or a helper
+    int renderVoices(int group, float* outL, float* outR, int n);
+    static int renderGroup(void* engine, int group, float* outL, float* outR, int n);
+    bool isOutputIdle();
+    void idleBlock(int n);
     void resetFilterState();
+    float cutoffScale();
 };
 
 #endif
@@ -0,0 +1,205 @@
+#include "BeatTracker.h"
+#include "AudioTools.h"
+#include "AudioTools/Concurrency/LockFree/RingBufferLockFree.h"
+#include <math.h>
+
+// Onset strength per frame, audio core -> UI core (~1 s of frames)
+static audio_tools::RingBufferLockFree<float> s_onsets(128);
+
+BeatTracker::BeatTracker() {
+    enabled = false;
+    hopMs = 1000.0f * BEAT_HOP / ENGINE_SAMPLE_RATE;
+    lowCoeff = 0.0f;
+    midCoeff = 0.0f;
+    lp1 = lp2 = 0.0f;
+    memset(energy, 0, sizeof(energy));
+    memset(prevLog, 0, sizeof(prevLog));
+    hopPos = 0;
+    dropped = 0;
+    memset(odf, 0, sizeof(odf));
+    odfPos = 0;
+    odfCount = 0;
+    sinceEstimate = 0;
+    locked = false;
+    bpm = 120.0f;
+    confidence = 0.0f;
+    pendingBpm = 0.0f;
+    nextBeatMs = 0;
+}
+
+bool BeatTracker::init(float sampleRate) {
+    const float twoPi = 6.28318530717958647692f;
+    lowCoeff = 1.0f - expf(-twoPi * 150.0f / sampleRate);
+    midCoeff = 1.0f - expf(-twoPi * 2000.0f / sampleRate);
+    hopMs = 1000.0f * BEAT_HOP / sampleRate;
+    return true;
+}
+
+void BeatTracker::setEnabled(bool on) {
+    if (on == enabled) return;
+    // History is only touched here while the audio core is not capturing
+    enabled = false;
+    s_onsets.clearArray(s_onsets.available());
+    odfPos = 0;
+    odfCount = 0;
+    sinceEstimate = 0;
+    locked = false;
+    pendingBpm = 0.0f;
+    enabled = on;
+}
+
+void BeatTracker::capture(const int16_t* frames, int count) {
+    if (!enabled) {
+        hopPos = 0;
+        return;
+    }
+    const float scale = 0.5f / 32768.0f;
+    for (int i = 0; i < count; i++) {
+        float x = (float)(frames[2 * i] + frames[2 * i + 1]) * scale;
+        lp1 += lowCoeff * (x - lp1);
+        lp2 += midCoeff * (x - lp2);
+        float mid = lp2 - lp1;
+        float high = x - lp2;
+        energy[0] += lp1 * lp1;
+        energy[1] += mid * mid;
+        energy[2] += high * high;
+
+        if (++hopPos >= BEAT_HOP) {
+            // Log compression makes the flux respond to relative, not absolute, level changes
+            float flux = 0.0f;
+            for (int b = 0; b < 3; b++) {
+                float l = logf(1.0f + 1000.0f * energy[b] / BEAT_HOP);
+                float d = l - prevLog[b];
+                if (d > 0.0f) flux += d;
+                prevLog[b] = l;
+                energy[b] = 0.0f;
+            }
+            if (!s_onsets.write(flux)) dropped++;
+            hopPos = 0;
+        }
+    }
+}
+
+bool BeatTracker::update() {
+    if (!enabled) return false;
+    bool estimated = false;
+    float v;
+    while (s_onsets.read(v)) {
+        odf[odfPos] = v;
+        odf[odfPos + BEAT_HISTORY] = v;
+        odfPos = (odfPos + 1) % BEAT_HISTORY;
+        odfCount++;
+        if (++sinceEstimate >= BEAT_ESTIMATE_HOPS && odfCount >= BEAT_MIN_HISTORY) {
+            sinceEstimate = 0;
+            estimated = true;
+        }
+    }
+    // One estimate per call, on the newest history
+    return estimated && estimate(millis());
+}
+
+/// False when the estimate left the prediction alone (no lock, or a tempo
+/// jump waiting for confirmation)
+bool BeatTracker::estimate(unsigned long now) {
+    int n = odfCount < BEAT_HISTORY ? (int)odfCount : BEAT_HISTORY;
+    const float* src = &odf[odfPos + BEAT_HISTORY - n];
+
+    float mean = 0.0f;
+    for (int i = 0; i < n; i++) mean += src[i];
+    mean /= n;
+    // [1 2 1] / 4 smoothing widens the peaks so a fractional beat period
+    // doesn't split its correlation across two lags
+    float r0 = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float prev = src[i > 0 ? i - 1 : i];
+        float next = src[i < n - 1 ? i + 1 : i];
+        work[i] = 0.25f * (prev + next) + 0.5f * src[i] - mean;
+        r0 += work[i] * work[i];
+    }
+    if (r0 < 1.0e-9f) {
+        locked = false;
+        return false;
+    }
+
+    // Autocorrelation, scaled for the shrinking overlap at longer lags
+    const float framesPerMin = 60000.0f / hopMs;
+    int minLag = (int)(framesPerMin / BEAT_MAX_BPM);
+    int maxLag = (int)(framesPerMin / BEAT_MIN_BPM + 1.0f);
+    int acLen = n / 2;
+    if (maxLag > acLen - 2) maxLag = acLen - 2;
+    float ac[BEAT_HISTORY / 2];
+    for (int lag = 0; lag < acLen; lag++) {
+        float sum = 0.0f;
+        for (int i = lag; i < n; i++) sum += work[i] * work[i - lag];
+        ac[lag] = sum * (float)n / (float)(n - lag);
+    }
+
+    // Log-Gaussian weight around 120 BPM, plus half the energy at twice the lag
+    float lag120 = framesPerMin / 120.0f;
+    float score[BEAT_HISTORY / 2];
+    int best = minLag;
+    for (int lag = minLag - 1; lag <= maxLag + 1; lag++) {
+        float o = log2f((float)lag / lag120);
+        float s = ac[lag];
+        if (2 * lag < acLen) s += 0.5f * ac[2 * lag];
+        score[lag] = s * expf(-0.5f * o * o);
+        if (lag >= minLag && lag <= maxLag && score[lag] > score[best]) best = lag;
+    }
+
+    confidence = ac[best] / r0;
+    if (confidence < BEAT_LOCK_CONFIDENCE) {
+        locked = false;
+        pendingBpm = 0.0f;
+        return false;
+    }
+
+    float a = score[best - 1];
+    float b = score[best];
+    float c = score[best + 1];
+    float denom = a - 2.0f * b + c;
+    float period = (float)best + (denom < 0.0f ? 0.5f * (a - c) / denom : 0.0f);
+    float newBpm = framesPerMin / period;
+
+    // Once locked, double/half-time readings of the same pulse keep the tempo
+    if (locked) {
+        if (fabsf(newBpm - 2.0f * bpm) < 0.08f * bpm) newBpm *= 0.5f;
+        else if (fabsf(newBpm - 0.5f * bpm) < 0.02f * bpm) newBpm *= 2.0f;
+    }
+
+    // Small changes are smoothed; a jump has to be confirmed by the next estimate
+    if (locked && fabsf(newBpm - bpm) < 0.04f * bpm) {
+        bpm += 0.25f * (newBpm - bpm);
+    } else if (pendingBpm > 0.0f && fabsf(newBpm - pendingBpm) < 0.04f * newBpm) {
+        bpm = newBpm;
+        locked = true;
+        pendingBpm = 0.0f;
+    } else {
+        pendingBpm = newBpm;
+        return false;
+    }
+
+    // Beat phase: comb over the last four beats, tolerant to one frame of jitter
+    period = framesPerMin / bpm;
+    int phases = (int)period;
+    int bestPhase = 0;
+    float bestSum = -1.0e30f;
+    for (int ph = 0; ph < phases; ph++) {
+        float sum = 0.0f;
+        for (int k = 0; k < 4; k++) {
+            int idx = n - 1 - ph - (int)(k * period + 0.5f);
+            if (idx < 1) break;
+            float m = work[idx];
+            if (work[idx - 1] > m) m = work[idx - 1];
+            if (idx + 1 < n && work[idx + 1] > m) m = work[idx + 1];
+            sum += m;
+        }
+        if (sum > bestSum) {
+            bestSum = sum;
+            bestPhase = ph;
+        }
+    }
+    // The newest frame ends about now; onsets sit mid-frame
+    float untilNext = (period - bestPhase) * hopMs - 0.5f * hopMs;
+    nextBeatMs = now + (unsigned long)(untilNext > 0.0f ? untilNext : 0.0f);
+    return true;
+}
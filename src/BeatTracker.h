@@ -0,0 +1,84 @@
+#ifndef BEAT_TRACKER_H
+#define BEAT_TRACKER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// =============================================================================
+// BEAT TRACKER
+// =============================================================================
+// Follows the tempo and beat phase of the sync input so the sequencer can lock
+// to an external drum machine, click or track.
+//
+// Audio core (capture): a block onset detector - the input is split into
+// three bands with two one-pole lowpasses, band energies are summed over a
+// BEAT_HOP frame, and the positive change of their log energy (energy flux) is
+// queued as one onset-strength value per frame. A few operations per sample.
+//
+// UI core (update): onset values go into a history ring. Every
+// BEAT_ESTIMATE_HOPS frames the mean-removed history is autocorrelated over
+// the 60-240 BPM lag range, weighted toward 120 BPM against octave errors,
+// and refined by parabolic interpolation. A comb over the last four beats
+// then finds the beat phase.
+// =============================================================================
+
+#define BEAT_HOP 256                // Onset frame: 8 ms at 32 kHz (125 frames/s)
+#define BEAT_HISTORY 512            // Onset frames analysed (~4 s)
+#define BEAT_MIN_HISTORY 256        // Frames needed before the first estimate (~2 s)
+#define BEAT_ESTIMATE_HOPS 32       // Re-estimate every ~0.25 s
+#define BEAT_MIN_BPM 60.0f
+#define BEAT_MAX_BPM 240.0f
+#define BEAT_LOCK_CONFIDENCE 0.15f  // Normalized autocorrelation needed for a lock
+
+class BeatTracker {
+public:
+    BeatTracker();
+    bool init(float sampleRate);
+
+    /// Capture runs only while enabled; disabling drops the lock
+    void setEnabled(bool on);
+    bool isEnabled() const { return enabled; }
+
+    /// Audio core: interleaved stereo input frames
+    void capture(const int16_t* frames, int count);
+
+    /// UI core: drain the onset queue. Returns true when the tempo and next beat were re-estimated.
+    bool update();
+
+    bool hasLock() const { return locked; }
+    float getBPM() const { return bpm; }
+    float getConfidence() const { return confidence; }
+    /// millis() time of the next predicted beat at the input
+    unsigned long getNextBeatMs() const { return nextBeatMs; }
+    /// Onset frames dropped because the UI core fell behind
+    uint32_t getDroppedFrames() const { return dropped; }
+
+private:
+    bool estimate(unsigned long now);
+
+    volatile bool enabled;
+    float hopMs;
+
+    // Audio core state
+    float lowCoeff;                 // One-pole at ~150 Hz
+    float midCoeff;                 // One-pole at ~2 kHz
+    float lp1, lp2;
+    float energy[3];
+    float prevLog[3];
+    int hopPos;
+    volatile uint32_t dropped;
+
+    // UI core state
+    float odf[2 * BEAT_HISTORY];    // Written twice so the last BEAT_HISTORY values are contiguous
+    int odfPos;
+    uint32_t odfCount;
+    int sinceEstimate;
+    float work[BEAT_HISTORY];
+    bool locked;
+    float bpm;
+    float confidence;
+    float pendingBpm;               // A tempo jump must be seen twice before it is taken
+    unsigned long nextBeatMs;
+};
+
+#endif
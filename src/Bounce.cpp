@@ -0,0 +1,85 @@
+#include "Bounce.h"
+#include "AudioTools.h"
+#include "AudioTools/AudioCodecs/CodecWAV.h"
+#include "Profiler.h"
+
+#define BOUNCE_WAV_HEADER_LEN 44    // RIFF + fmt + data chunk headers for PCM
+
+static int16_t s_chunk[2 * BOUNCE_CHUNK_FRAMES];
+
+static uint32_t bounceFrames(Sequencer& sequencer, int loops, unsigned long tailMs) {
+    uint64_t ms = (uint64_t)loops * sequencer.getLoopDuration() + tailMs;
+    return (uint32_t)(ms * ENGINE_SAMPLE_RATE / 1000);
+}
+
+uint32_t bounceSize(Sequencer& sequencer, int loops, unsigned long tailMs) {
+    return BOUNCE_WAV_HEADER_LEN + bounceFrames(sequencer, loops, tailMs) * 2 * sizeof(int16_t);
+}
+
+bool bouncePattern(AudioEngine& audio, Sequencer& sequencer, Print& out,
+                   int loops, unsigned long tailMs, BounceResult* result) {
+    if (result) memset(result, 0, sizeof(*result));
+    if (loops < 1) return false;
+    uint32_t total = bounceFrames(sequencer, loops, tailMs);
+    uint32_t loopEnd = bounceFrames(sequencer, loops, 0);
+
+    // The audio task has to be out of the engine before anything is written
+    if (!audio.beginOffline()) return false;
+
+    // Known length: a regular (not streamed) WAV header
+    audio_tools::WAVEncoder wav;
+    audio_tools::WAVAudioInfo info = wav.defaultConfig();
+    info.sample_rate = ENGINE_SAMPLE_RATE;
+    info.channels = 2;
+    info.bits_per_sample = 16;
+    info.is_streamed = false;
+    info.data_length = total * 2 * sizeof(int16_t);
+    info.file_size = info.data_length + 36;
+    wav.setOutput(out);
+    if (!wav.begin(info)) {
+        audio.endOffline();
+        return false;
+    }
+
+    bool wasPlaying = sequencer.isPlayingState();
+    uint64_t startUs = renderClockUs();
+
+    // Step 0 fires on the first update: the clock starts one step (15) after start()
+    unsigned long clockStart = sequencer.getStepDuration(15);
+    sequencer.start(0);
+
+    uint32_t bytes = 0;
+    uint32_t frame = 0;
+    bool ok = true;
+    while (frame < total && ok) {
+        int n = min((uint32_t)BOUNCE_CHUNK_FRAMES, total - frame);
+        for (int i = 0; i < n; i += RENDER_BLOCK_SIZE) {
+            uint32_t f = frame + i;
+            if (f < loopEnd) {
+                sequencer.update(clockStart + (unsigned long)((uint64_t)f * 1000 / ENGINE_SAMPLE_RATE));
+            } else if (f - loopEnd < RENDER_BLOCK_SIZE) {
+                sequencer.releaseNotes();   // Tail: the voices ring out
+            }
+            audio.renderOffline(&s_chunk[2 * i], min(RENDER_BLOCK_SIZE, n - i));
+        }
+        size_t len = n * 2 * sizeof(int16_t);
+        size_t written = wav.write((const uint8_t*)s_chunk, len);
+        ok = written == len;
+        bytes += written;
+        frame += n;
+    }
+
+    uint32_t elapsed = (uint32_t)(renderClockUs() - startUs);
+    wav.end();
+    sequencer.stop();
+    audio.endOffline();
+    if (wasPlaying) sequencer.start();
+
+    if (result) {
+        result->frames = frame;
+        result->bytes = bytes + BOUNCE_WAV_HEADER_LEN;
+        result->elapsedUs = elapsed;
+        result->speed = elapsed > 0 ? (1.0e6f * frame / ENGINE_SAMPLE_RATE) / elapsed : 0.0f;
+    }
+    return ok;
+}
@@ -0,0 +1,41 @@
+#ifndef BOUNCE_H
+#define BOUNCE_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "AudioEngine.h"
+#include "Sequencer.h"
+
+// =============================================================================
+// OFFLINE BOUNCE
+// =============================================================================
+// Renders the sequencer pattern faster than real time. The Sequencer runs on
+// a virtual clock derived from the number of rendered frames (one update per
+// render block, like its 1 ms tick in loop()) and the engine output goes
+// through the AudioTools WAVEncoder into any Print: a file in flash or on SD,
+// or a MemoryOutput in RAM. The engine starts from a reset state, so the same
+// pattern gives the same bytes - on the desktop a bounce doubles as throughput
+// benchmark and golden-output test.
+//
+// Runs on the calling task (the UI core on the device); the audio task only
+// writes silence meanwhile.
+// =============================================================================
+
+#define BOUNCE_CHUNK_FRAMES 256     // Frames rendered and encoded per write
+
+struct BounceResult {
+    uint32_t frames;                // Frames rendered
+    uint32_t bytes;                 // WAV bytes written, header included
+    uint32_t elapsedUs;
+    float speed;                    // Audio time / render time (x real time)
+};
+
+/// Bounce `loops` passes of the pattern plus tailMs of release to a WAV file on
+/// `out`. The sequencer continues live afterwards if it was playing.
+bool bouncePattern(AudioEngine& audio, Sequencer& sequencer, Print& out,
+                   int loops, unsigned long tailMs, BounceResult* result = nullptr);
+
+/// Size of the WAV data bouncePattern() writes (header included)
+uint32_t bounceSize(Sequencer& sequencer, int loops, unsigned long tailMs);
+
+#endif
@@ -0,0 +1,176 @@
+#include "Drive.h"
+#include <math.h>
+
+#define HB_LEN (2 * HALFBAND_TAPS)
+
+static const float DRIVE_PI = 3.14159265358979323846f;
+
+float HalfBand::coeffs[2 * HALFBAND_TAPS];
+bool HalfBand::coeffsReady = false;
+
+float Drive::tables[DRIVE_SHAPE_COUNT][DRIVE_TABLE_SIZE + 1];
+bool Drive::tablesReady = false;
+
+// -----------------------------------------------------------------------------
+// HalfBand
+// -----------------------------------------------------------------------------
+// Half-band lowpass h[k]: h[0] = 0.5, h[even k] = 0, so only the odd taps
+// (k = -(2M-1) .. 2M-1 in steps of 2) need multiplies. coeffs[j] = h[2(j-M)+1].
+// -----------------------------------------------------------------------------
+void HalfBand::initCoeffs() {
+    if (coeffsReady) return;
+    const int M = HALFBAND_TAPS;
+    float sum = 0.0f;
+    for (int j = 0; j < HB_LEN; j++) {
+        int k = 2 * (j - M) + 1;
+        float x = 0.5f * (float)k;
+        float sinc = sinf(DRIVE_PI * x) / (DRIVE_PI * x);
+        // Blackman window over the full 4M-1 tap span
+        float w = 0.42f + 0.5f * cosf(DRIVE_PI * k / (2.0f * M)) + 0.08f * cosf(2.0f * DRIVE_PI * k / (2.0f * M));
+        coeffs[j] = 0.5f * sinc * w;
+        sum += coeffs[j];
+    }
+    // Odd taps must sum to 0.5 for unity DC gain
+    for (int j = 0; j < HB_LEN; j++)
+        coeffs[j] *= 0.5f / sum;
+    coeffsReady = true;
+}
+
+HalfBand::HalfBand() {
+    initCoeffs();
+    reset();
+}
+
+void HalfBand::reset() {
+    memset(upHist, 0, sizeof(upHist));
+    memset(downOdd, 0, sizeof(downOdd));
+    memset(downEven, 0, sizeof(downEven));
+    upPos = 0;
+    downPos = 0;
+}
+
+void HalfBand::up(const float* in, float* out, int n) {
+    for (int i = 0; i < n; i++) {
+        upHist[upPos] = in[i];
+        upHist[upPos + HB_LEN] = in[i];
+
+        // x[n - j] = upHist[upPos + HB_LEN - j]
+        const float* x = &upHist[upPos + 1];
+        float odd = 0.0f;
+        for (int j = 0; j < HB_LEN; j++)
+            odd += coeffs[j] * x[HB_LEN - 1 - j];
+
+        out[2 * i] = upHist[upPos + HB_LEN - HALFBAND_TAPS];  // Even phase: pure delay
+        out[2 * i + 1] = 2.0f * odd;
+
+        if (++upPos >= HB_LEN) upPos = 0;
+    }
+}
+
+void HalfBand::down(const float* in, float* out, int n) {
+    for (int i = 0; i < n; i++) {
+        // Odd phase uses the previous HB_LEN odd samples (before this pair is pushed)
+        int prev = downPos == 0 ? HB_LEN - 1 : downPos - 1;
+        const float* o = &downOdd[prev + 1];
+        float acc = 0.0f;
+        for (int j = 0; j < HB_LEN; j++)
+            acc += coeffs[j] * o[HB_LEN - 1 - j];
+
+        downEven[downPos] = in[2 * i];
+        downEven[downPos + HB_LEN] = in[2 * i];
+        downOdd[downPos] = in[2 * i + 1];
+        downOdd[downPos + HB_LEN] = in[2 * i + 1];
+
+        out[i] = 0.5f * downEven[downPos + HB_LEN - HALFBAND_TAPS] + acc;
+
+        if (++downPos >= HB_LEN) downPos = 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Drive
+// -----------------------------------------------------------------------------
+void Drive::initTables() {
+    if (tablesReady) return;
+    for (int i = 0; i <= DRIVE_TABLE_SIZE; i++) {
+        float x = ((float)i / DRIVE_TABLE_SIZE * 2.0f - 1.0f) * DRIVE_TABLE_RANGE;
+        tables[DRIVE_SHAPE_TANH][i] = tanhf(x);
+        float c = x < -1.0f ? -1.0f : (x > 1.0f ? 1.0f : x);
+        tables[DRIVE_SHAPE_SOFTCLIP][i] = 1.5f * (c - c * c * c / 3.0f);
+    }
+    tablesReady = true;
+}
+
+Drive::Drive() {
+    initTables();
+    amount = 0.0f;
+    quality = DRIVE_QUALITY_2X;
+    shapeType = DRIVE_SHAPE_TANH;
+}
+
+void Drive::reset() {
+    for (int ch = 0; ch < 2; ch++) {
+        stage1[ch].reset();
+        stage2[ch].reset();
+    }
+}
+
+void Drive::setAmount(float a) {
+    amount = constrain(a, 0.0f, 1.0f);
+}
+
+void Drive::setQuality(DriveQuality q) {
+    if (q >= DRIVE_QUALITY_COUNT || q == quality) return;
+    quality = q;
+    reset();
+}
+
+void Drive::setShape(DriveShape s) {
+    if (s < DRIVE_SHAPE_COUNT) shapeType = s;
+}
+
+inline float Drive::shape(float x) const {
+    const float* t = tables[shapeType];
+    float pos = (x * (1.0f / DRIVE_TABLE_RANGE) + 1.0f) * (0.5f * DRIVE_TABLE_SIZE);
+    if (pos <= 0.0f) return t[0];
+    if (pos >= (float)DRIVE_TABLE_SIZE) return t[DRIVE_TABLE_SIZE];
+    int i = (int)pos;
+    float frac = pos - (float)i;
+    return t[i] + frac * (t[i + 1] - t[i]);
+}
+
+void Drive::processChannel(int ch, float* buf, int n, float preGain, float makeup) {
+    float* work = buf;
+    int len = n;
+    if (quality >= DRIVE_QUALITY_2X) {
+        stage1[ch].up(buf, os1, n);
+        work = os1;
+        len = 2 * n;
+    }
+    if (quality >= DRIVE_QUALITY_4X) {
+        stage2[ch].up(os1, os2, 2 * n);
+        work = os2;
+        len = 4 * n;
+    }
+
+    for (int i = 0; i < len; i++)
+        work[i] = shape(work[i] * preGain) * makeup;
+
+    if (quality >= DRIVE_QUALITY_4X)
+        stage2[ch].down(os2, os1, 2 * n);
+    if (quality >= DRIVE_QUALITY_2X)
+        stage1[ch].down(os1, buf, n);
+}
+
+void Drive::process(float* left, float* right, int n, float amountMod) {
+    float a = amount + amountMod;
+    if (a <= 0.0f) return;  // Bypassed: costs one compare
+    if (a > 1.0f) a = 1.0f;
+
+    // Up to ~28 dB of pre-gain, with rough loudness compensation
+    float preGain = 1.0f + a * 24.0f;
+    float makeup = 1.0f / sqrtf(preGain);
+
+    processChannel(0, left, n, preGain, makeup);
+    processChannel(1, right, n, preGain, makeup);
+}
@@ -0,0 +1,89 @@
+#ifndef DRIVE_H
+#define DRIVE_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// =============================================================================
+// OVERSAMPLED DRIVE
+// =============================================================================
+// Waveshaping creates harmonics far above 16 kHz that fold back at 32 kHz.
+// The shaper here runs at 2x or 4x through a pair of polyphase half-band FIRs
+// (only the odd-phase taps are computed, the even phase is a pure delay),
+// and the curve itself is a lookup table - no tanhf() per sample.
+// =============================================================================
+
+enum DriveQuality {
+    DRIVE_QUALITY_1X,   // Table shaper only (aliases, cheapest)
+    DRIVE_QUALITY_2X,
+    DRIVE_QUALITY_4X,
+    DRIVE_QUALITY_COUNT
+};
+
+enum DriveShape {
+    DRIVE_SHAPE_TANH,
+    DRIVE_SHAPE_SOFTCLIP,   // Cubic x - x^3/3, hard knee at +-1
+    DRIVE_SHAPE_COUNT
+};
+
+#define HALFBAND_TAPS 6         // Odd-phase taps per side -> 23-tap half-band
+#define DRIVE_TABLE_SIZE 1024
+#define DRIVE_TABLE_RANGE 4.0f  // Table covers -4..+4, saturated outside
+
+/// 2x polyphase half-band interpolator/decimator pair for one channel
+class HalfBand {
+public:
+    HalfBand();
+    void reset();
+    /// n input samples -> 2n output samples
+    void up(const float* in, float* out, int n);
+    /// 2n input samples -> n output samples
+    void down(const float* in, float* out, int n);
+
+private:
+    static float coeffs[2 * HALFBAND_TAPS];  // Odd-phase taps, shared by all instances
+    static bool coeffsReady;
+    static void initCoeffs();
+
+    // Delay lines hold 2 * HALFBAND_TAPS samples, written twice (at i and i + LEN)
+    // so the FIR always reads one contiguous span without wrapping
+    float upHist[4 * HALFBAND_TAPS];
+    float downOdd[4 * HALFBAND_TAPS];
+    float downEven[4 * HALFBAND_TAPS];
+    int upPos;
+    int downPos;
+};
+
+class Drive {
+public:
+    Drive();
+    void reset();
+
+    void setAmount(float amount);           // 0.0 (bypass) - 1.0
+    float getAmount() const { return amount; }
+    void setQuality(DriveQuality q);
+    DriveQuality getQuality() const { return quality; }
+    void setShape(DriveShape s);
+
+    /// Process one stereo block in place (n <= RENDER_BLOCK_SIZE). amountMod adds to the amount.
+    void process(float* left, float* right, int n, float amountMod = 0.0f);
+
+private:
+    void processChannel(int ch, float* buf, int n, float preGain, float makeup);
+    inline float shape(float x) const;
+
+    float amount;
+    DriveQuality quality;
+    DriveShape shapeType;
+
+    HalfBand stage1[2];     // 1x <-> 2x
+    HalfBand stage2[2];     // 2x <-> 4x
+    float os1[2 * RENDER_BLOCK_SIZE];
+    float os2[4 * RENDER_BLOCK_SIZE];
+
+    static float tables[DRIVE_SHAPE_COUNT][DRIVE_TABLE_SIZE + 1];
+    static bool tablesReady;
+    static void initTables();
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "Hardware.h"
+#include <soc/gpio_struct.h>
 
 // ============================================================================
 // HIGH-QUALITY I2S CONFIGURATION FOR ESP32-S3 + PCM5102A
@@ -9,6 +10,18 @@
 // - Optimized DMA buffer configuration
 // ============================================================================
 
+// Matrix scanner timer interrupt
+static Hardware* s_scanner = nullptr;
+
+static void IRAM_ATTR onScanTimer() {
+    s_scanner->scanTick();
+}
+
+/// Level of a pin in the input registers (bank 0: GPIO 0-31, bank 1: GPIO 32+)
+static inline bool pinLevel(uint32_t in0, uint32_t in1, int pin) {
+    return pin < 32 ? (in0 >> pin) & 1 : (in1 >> (pin - 32)) & 1;
+}
+
 Hardware::Hardware() {
     memset(padState, 0, sizeof(padState));
     memset(lastPadState, 0, sizeof(lastPadState));
@@ -17,7 +30,23 @@ Hardware::Hardware() {
     btnOctaveState = false;
     lastBtnOctaveState = false;
     ledBrightness = 127;
-    memset(debounceTime, 0, sizeof(debounceTime));
+    memset(edgeUs, 0, sizeof(edgeUs));
+    memset(padChanged, 0, sizeof(padChanged));
+
+    memset(rowMask, 0, sizeof(rowMask));
+    memset(colMask, 0, sizeof(colMask));
+    scanRow = 0;
+    rawKeys = 0;
+    keyState = 0;
+    droppedEvents = 0;
+    count0 = 0;
+    count1 = 0;
+    pendingKeys = 0;
+    memset(pendingUs, 0, sizeof(pendingUs));
+#ifdef DEBOUNCE_EDGE_TRIGGERED
+    lockedKeys = 0;
+    memset(holdoff, 0, sizeof(holdoff));
+#endif
 }
 
 void Hardware::init() {
@@ -29,11 +58,19 @@ void Hardware::init() {
     // GPIO SETUP
     // ========================================================================
     
+    uint32_t allRows = 0;
     for (int i = 0; i < 4; i++) {
-        // Set rows to INPUT (High-Z) to avoid shorts
-        pinMode(ROW_PINS[i], INPUT);
-        
+        if (ROW_PINS[i] >= 32 || COL_PINS[i] >= 32)
+            Serial.println("[Hardware] Matrix pins must be GPIO 0-31 (one input register)");
+
+        // Rows: output latch LOW, driver off (High-Z) until the scanner selects the row
+        pinMode(ROW_PINS[i], OUTPUT);
+        digitalWrite(ROW_PINS[i], LOW);
+        rowMask[i] = 1UL << ROW_PINS[i];
+        allRows |= rowMask[i];
+
         pinMode(COL_PINS[i], INPUT_PULLUP);
+        colMask[i] = 1UL << COL_PINS[i];
         
         // PWM Setup for LEDs (using LEDC)
         // Channels 0-3, 5000Hz, 8-bit resolution
@@ -41,12 +78,23 @@ void Hardware::init() {
         ledcAttachPin(LED_PINS[i], i);
         ledcWrite(i, 0); // Start Off
     }
+    GPIO.enable_w1tc = allRows;
     
     pinMode(BTN_MODE, INPUT_PULLUP);
     pinMode(BTN_OCTAVE, INPUT_PULLUP);
     pinMode(BTN_BOOT, INPUT_PULLUP);
     
     Serial.println("[Hardware] GPIO Initialized");
+
+    // Scanner: 1 MHz timer, one tick per row
+    scanRow = 0;
+    GPIO.enable_w1ts = rowMask[0];
+    s_scanner = this;
+    hw_timer_t* timer = timerBegin(SCAN_TIMER, 80, true);
+    timerAttachInterrupt(timer, onScanTimer, true);
+    timerAlarmWrite(timer, 1000000 / (SCAN_RATE_HZ * 4), true);
+    timerAlarmEnable(timer);
+    Serial.printf("[Hardware] Scanning at %d Hz\n", SCAN_RATE_HZ);
 }
 
 void Hardware::writeAudio(int32_t* buffer, size_t bytes) {
@@ -61,55 +109,101 @@ void Hardware::writeAudio16(int16_t* buffer, size_t bytes) {
     (void)bytes;
 }
 
-void Hardware::scanButtons() {
-    uint32_t now = millis();
-    
-    for (int row = 0; row < 4; row++) {
-        // Drive Row LOW
-        pinMode(ROW_PINS[row], OUTPUT);
-        digitalWrite(ROW_PINS[row], LOW);
-        delayMicroseconds(10);  // Small settling time
-        
-        for (int col = 0; col < 4; col++) {
-            bool rawState = !digitalRead(COL_PINS[col]);
-            
-            // Debounce: Only register change if stable for DEBOUNCE_MS
-            int padIndex = row * 4 + col;
-            
-            if (rawState != padState[row][col]) {
-                // State changed - check if enough time has passed
-                if (now - debounceTime[padIndex] >= DEBOUNCE_MS) {
-                    lastPadState[row][col] = padState[row][col];
-                    padState[row][col] = rawState;
-                    debounceTime[padIndex] = now;
-                }
-                // Otherwise, ignore the change (bounce)
-            } else {
-                // State is stable - update the timestamp for next change
-                debounceTime[padIndex] = now;
-            }
-        }
-        
-        // Return Row to High-Z
-        pinMode(ROW_PINS[row], INPUT);
+// ============================================================================
+// SCANNER (timer interrupt)
+// ============================================================================
+void IRAM_ATTR Hardware::scanTick() {
+    // Columns of the row driven since the last tick, pressed = LOW
+    uint32_t in0 = GPIO.in;
+    uint32_t cols = 0;
+    for (int col = 0; col < 4; col++)
+        if (!(in0 & colMask[col])) cols |= 1UL << col;
+    rawKeys |= cols << (scanRow * 4);
+
+    // Drive the next row; it settles until the next tick
+    GPIO.enable_w1tc = rowMask[scanRow];
+    scanRow = (scanRow + 1) & 3;
+    GPIO.enable_w1ts = rowMask[scanRow];
+
+    if (scanRow == 0) {
+        uint32_t in1 = GPIO.in1.val;
+        uint32_t raw = rawKeys;
+        if (!pinLevel(in0, in1, BTN_MODE)) raw |= 1UL << KEY_MODE;
+        if (!pinLevel(in0, in1, BTN_OCTAVE)) raw |= 1UL << KEY_OCTAVE;
+        debounce(raw, micros());
+        rawKeys = 0;
     }
-    
-    // Function buttons (with simple debounce)
-    static uint32_t modeDebounce = 0;
-    static uint32_t octaveDebounce = 0;
-    
-    bool modeRaw = !digitalRead(BTN_MODE);
-    if (modeRaw != btnModeState && (now - modeDebounce) >= DEBOUNCE_MS) {
-        lastBtnModeState = btnModeState;
-        btnModeState = modeRaw;
-        modeDebounce = now;
+}
+
+void IRAM_ATTR Hardware::debounce(uint32_t raw, uint32_t nowUs) {
+    uint32_t delta = raw ^ keyState;    // Keys that read differently from their state
+    uint32_t toggled;
+
+#ifdef DEBOUNCE_EDGE_TRIGGERED
+    // The first edge counts; the key then ignores its input for DEBOUNCE_MS
+    toggled = delta & ~lockedKeys;
+    for (uint32_t m = lockedKeys; m; m &= m - 1) {
+        int key = __builtin_ctz(m);
+        if (--holdoff[key] == 0) lockedKeys &= ~(1UL << key);
     }
-    
-    bool octaveRaw = !digitalRead(BTN_OCTAVE);
-    if (octaveRaw != btnOctaveState && (now - octaveDebounce) >= DEBOUNCE_MS) {
-        lastBtnOctaveState = btnOctaveState;
-        btnOctaveState = octaveRaw;
-        octaveDebounce = now;
+    for (uint32_t m = toggled; m; m &= m - 1) {
+        int key = __builtin_ctz(m);
+        holdoff[key] = DEBOUNCE_MS * SCAN_RATE_HZ / 1000;
+        pendingUs[key] = nowUs;
+    }
+    lockedKeys |= toggled;
+#else
+    // Vertical counter: count1:count0 counts the scans in a row that disagree
+    // with the state (any agreeing scan resets it); the 4th one toggles the key
+    toggled = delta & count0 & count1;
+    count1 = (count1 ^ count0) & delta;
+    count0 = ~count0 & delta;
+
+    // Stamp the first edge; bounce back to the old state keeps the stamp, a
+    // key that stays there for DEBOUNCE_MS had a glitch
+    for (uint32_t m = delta & ~pendingKeys; m; m &= m - 1)
+        pendingUs[__builtin_ctz(m)] = nowUs;
+    pendingKeys |= delta;
+    for (uint32_t m = pendingKeys & ~delta; m; m &= m - 1) {
+        int key = __builtin_ctz(m);
+        if (nowUs - pendingUs[key] >= DEBOUNCE_MS * 1000UL) pendingKeys &= ~(1UL << key);
+    }
+    pendingKeys &= ~toggled;
+#endif
+
+    keyState ^= toggled;
+    for (uint32_t m = toggled; m; m &= m - 1) {
+        int key = __builtin_ctz(m);
+        KeyEvent event = {pendingUs[key], (uint8_t)key, (keyState >> key) & 1 ? true : false};
+        if (!events.write(event)) droppedEvents++;
+    }
+}
+
+// ============================================================================
+// KEY STATE (loop())
+// ============================================================================
+void Hardware::scanButtons() {
+    memset(padChanged, 0, sizeof(padChanged));
+    uint32_t changed = 0;
+    KeyEvent event;
+    // One change per key and call: a key's next change waits for the next loop()
+    while (events.peek(event) && !(changed & (1UL << event.key))) {
+        events.read(event);
+        changed |= 1UL << event.key;
+        if (event.key < 16) {
+            int row = event.key / 4;
+            int col = event.key % 4;
+            lastPadState[row][col] = padState[row][col];
+            padState[row][col] = event.pressed;
+            edgeUs[event.key] = event.us;
+            padChanged[event.key] = true;
+        } else if (event.key == KEY_MODE) {
+            lastBtnModeState = btnModeState;
+            btnModeState = event.pressed;
+        } else if (event.key == KEY_OCTAVE) {
+            lastBtnOctaveState = btnOctaveState;
+            btnOctaveState = event.pressed;
+        }
     }
 }
 
@@ -125,6 +219,14 @@ bool Hardware::isPadJustReleased(int row, int col) {
     return !padState[row][col] && lastPadState[row][col];
 }
 
+bool Hardware::hasPadChanged(int row, int col) {
+    return padChanged[row * 4 + col];
+}
+
+uint32_t Hardware::getPadEdgeUs(int row, int col) {
+    return edgeUs[row * 4 + col];
+}
+
 bool Hardware::isModePressed() {
     return btnModeState;
 }
@@ -3,52 +3,123 @@
 
 #include <Arduino.h>
 #include "Config.h"
+#include "AudioTools/Concurrency/LockFree/RingBufferLockFree.h"
 
-// Debounce time in milliseconds
+// =============================================================================
+// INPUT SCANNER
+// =============================================================================
+// A hardware timer interrupt scans the matrix at SCAN_RATE_HZ, independent of
+// loop() and the display transfers. Each tick reads the four columns of the
+// row driven on the previous tick with one read of the GPIO input register,
+// then drives the next row (output enable on a pin held LOW), so the row has
+// settled by the time it is read and the interrupt never waits.
+//
+// After each full scan the 16 pads and the mode/octave buttons are debounced
+// together as bitmasks: a 2-bit vertical counter per key counts scans that
+// disagree with the debounced state, and a change counts once four scans in a
+// row agree on it. With DEBOUNCE_EDGE_TRIGGERED the first edge counts and the
+// key then ignores its input for DEBOUNCE_MS.
+//
+// Changes go into a lock-free queue as press/release events stamped with the
+// first scan that saw the edge. scanButtons() (loop()) applies them to the
+// isPad...() state below; a key that changes twice before loop() gets to it
+// keeps its second change queued, so short taps during a display flush are not
+// lost.
+// =============================================================================
+
+#define SCAN_RATE_HZ 1000           // Full matrix scans per second (the timer ticks once per row)
+#define SCAN_TIMER 0                // Hardware timer of the scanner
+#define SCAN_QUEUE_SIZE 64          // Pending key events
+
+// Edge-triggered debounce: how long a key ignores bounce after an edge.
+// Counter debounce: how long a pending edge keeps its stamp through bounce
 #define DEBOUNCE_MS 15
 
+// Key indices of the scanner: pads 0-15 (row * 4 + col), then the buttons
+enum ScanKey {
+    KEY_MODE = 16,
+    KEY_OCTAVE = 17,
+    KEY_COUNT
+};
+
+struct KeyEvent {
+    uint32_t us;                    // micros() of the first scan that saw the edge
+    uint8_t key;                    // ScanKey / pad index
+    bool pressed;
+};
+
 class Hardware {
 public:
     Hardware();
+    /// Sets up the pins and starts the scan timer
     void init();
-    
+
     // Audio Output (32-bit for high-quality PCM5102A output)
     void writeAudio(int32_t* buffer, size_t size);
-    
+
     // Legacy 16-bit audio output (if needed)
     void writeAudio16(int16_t* buffer, size_t size);
-    
-    // Input Scanning
+
+    // Input: applies the scanner's queued events (call once per loop())
     void scanButtons();
     bool isPadPressed(int row, int col);
     bool isPadJustPressed(int row, int col);
     bool isPadJustReleased(int row, int col);
-    
+    /// The pad changed state in the last scanButtons()
+    bool hasPadChanged(int row, int col);
+    /// micros() of the first scan that saw the edge behind the current pad state
+    uint32_t getPadEdgeUs(int row, int col);
+    /// Key events lost to a full queue since boot
+    uint32_t getDroppedEvents() { return droppedEvents; }
+
     bool isModePressed();
     bool isModeJustPressed();
-    
+
     bool isOctavePressed();
     bool isOctaveJustPressed();
-    
+
     // LEDs
     void setGroupLEDs(int activeIndex); // 0-3
     void setStepLEDs(int step); // 0-15
     void setBrightness(int b); // 0-255
     int getBrightness();
-    
+
+    /// Timer interrupt: one row of the matrix
+    void scanTick();
+
 private:
     int ledBrightness = 128; // Default 50%
-    
-    // Button Matrix State
+
+    // Button Matrix State (loop() side)
     bool padState[4][4];
     bool lastPadState[4][4];
-    uint32_t debounceTime[16];  // Debounce timestamps for each pad
-    
+    uint32_t edgeUs[16];        // Stamp of the event behind the current pad state
+    bool padChanged[16];
+
     bool btnModeState;
     bool lastBtnModeState;
-    
+
     bool btnOctaveState;
     bool lastBtnOctaveState;
+
+    // Scanner state (timer interrupt only)
+    audio_tools::RingBufferLockFree<KeyEvent> events{SCAN_QUEUE_SIZE};
+    volatile uint32_t droppedEvents;
+    uint32_t rowMask[4];        // GPIO bit of each row pin (bank 0)
+    uint32_t colMask[4];        // GPIO bit of each column pin (bank 0)
+    int scanRow;                // Row driven since the last tick
+    uint32_t rawKeys;           // Key bits of the scan in progress
+    uint32_t keyState;          // Debounced key bits
+    uint32_t count0;            // Vertical counter, low bits
+    uint32_t count1;            // Vertical counter, high bits
+    uint32_t pendingKeys;       // Keys with an edge not yet confirmed
+    uint32_t pendingUs[KEY_COUNT];  // First scan that saw the pending edge
+#ifdef DEBOUNCE_EDGE_TRIGGERED
+    uint32_t lockedKeys;            // Keys ignoring their input after an edge
+    uint16_t holdoff[KEY_COUNT];    // Scans left until the key is read again
+#endif
+
+    void debounce(uint32_t raw, uint32_t nowUs);
 };
 
 #endif
@@ -0,0 +1,167 @@
+#include "Latency.h"
+
+#ifdef SYNTH_LATENCY
+
+LatencyProbe::LatencyProbe() {
+    usPerFrame = 1.0e6f / ENGINE_SAMPLE_RATE;
+    dmaFrames = 0;
+    resetRequested = false;
+    pendingCount = 0;
+    seq.store(0);
+    reset();
+}
+
+void LatencyProbe::init(float sampleRate, int queueFrames) {
+    usPerFrame = 1.0e6f / sampleRate;
+    dmaFrames = queueFrames;
+    pendingCount = 0;
+    reset();
+}
+
+void LatencyProbe::reset() {
+    seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    count = 0;
+    dropped = 0;
+    totalUs = 0;
+    minUs = UINT32_MAX;
+    maxUs = 0;
+    inputTotalUs = 0;
+    inputMaxUs = 0;
+    outputTotalUs = 0;
+    outputMaxUs = 0;
+    memset(histogram, 0, sizeof(histogram));
+    seq.fetch_add(1, std::memory_order_release);
+}
+
+int LatencyProbe::firstAudible(const float* l, const float* r, int n) {
+    for (int i = 0; i < n; i++) {
+        if (fabsf(l[i]) > LATENCY_AUDIBLE_LEVEL || fabsf(r[i]) > LATENCY_AUDIBLE_LEVEL)
+            return i;
+    }
+    return -1;
+}
+
+void LatencyProbe::audible(const VoiceProbe& probe) {
+    if (pendingCount == LATENCY_PENDING) {
+        seq.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        dropped++;
+        seq.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    pending[pendingCount++] = probe;
+}
+
+void LatencyProbe::onWrite(uint32_t written, uint32_t nowUs) {
+    if (resetRequested) {
+        resetRequested = false;
+        pendingCount = 0;
+        reset();
+        return;
+    }
+    int kept = 0;
+    for (int i = 0; i < pendingCount; i++) {
+        const VoiceProbe& p = pending[i];
+        int32_t ahead = (int32_t)(p.frame - written);
+        if (ahead >= 0) {
+            pending[kept++] = p;    // Not written yet
+            continue;
+        }
+        // The frame is `ahead + dmaFrames` frames from the DAC
+        uint32_t dacUs = nowUs + (int32_t)((ahead + dmaFrames) * usPerFrame);
+        record(p.inputUs, p.noteOnUs, dacUs);
+    }
+    pendingCount = kept;
+}
+
+void LatencyProbe::record(uint32_t inputUs, uint32_t noteOnUs, uint32_t dacUs) {
+    uint32_t total = dacUs - inputUs;
+    uint32_t input = noteOnUs - inputUs;
+    uint32_t output = dacUs - noteOnUs;
+
+    seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    count++;
+    totalUs += total;
+    if (total < minUs) minUs = total;
+    if (total > maxUs) maxUs = total;
+    inputTotalUs += input;
+    if (input > inputMaxUs) inputMaxUs = input;
+    outputTotalUs += output;
+    if (output > outputMaxUs) outputMaxUs = output;
+    uint32_t bin = total / 1000;
+    histogram[bin < LATENCY_HIST_BINS ? bin : LATENCY_HIST_BINS - 1]++;
+    seq.fetch_add(1, std::memory_order_release);
+}
+
+void LatencyProbe::getReport(LatencyReport& r) {
+    uint32_t hist[LATENCY_HIST_BINS];
+    uint64_t total, inputTotal, outputTotal;
+    uint32_t lo, hi, inputMax, outputMax;
+    // Retry while the audio core is updating
+    for (;;) {
+        uint32_t before = seq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        r.count = count;
+        r.dropped = dropped;
+        total = totalUs;
+        lo = minUs;
+        hi = maxUs;
+        inputTotal = inputTotalUs;
+        inputMax = inputMaxUs;
+        outputTotal = outputTotalUs;
+        outputMax = outputMaxUs;
+        memcpy(hist, histogram, sizeof(hist));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == before) break;
+    }
+
+    float n = r.count > 0 ? (float)r.count : 1.0f;
+    r.avgMs = total / 1000.0f / n;
+    r.minMs = r.count > 0 ? lo / 1000.0f : 0.0f;
+    r.maxMs = hi / 1000.0f;
+    r.inputAvgMs = inputTotal / 1000.0f / n;
+    r.inputMaxMs = inputMax / 1000.0f;
+    r.outputAvgMs = outputTotal / 1000.0f / n;
+    r.outputMaxMs = outputMax / 1000.0f;
+
+    // Percentiles: upper edge of the bin that reaches the fraction of the presses
+    const float fractions[3] = {0.5f, 0.9f, 0.99f};
+    float* results[3] = {&r.p50Ms, &r.p90Ms, &r.p99Ms};
+    for (int k = 0; k < 3; k++) {
+        uint32_t limit = (uint32_t)ceilf(fractions[k] * r.count);
+        uint32_t seen = 0;
+        *results[k] = 0.0f;
+        for (int b = 0; b < LATENCY_HIST_BINS && r.count > 0; b++) {
+            seen += hist[b];
+            if (seen >= limit) {
+                *results[k] = b == LATENCY_HIST_BINS - 1 ? r.maxMs : min((float)(b + 1), r.maxMs);
+                break;
+            }
+        }
+    }
+}
+
+void LatencyProbe::printReport(Print& out) {
+    LatencyReport r;
+    getReport(r);
+    out.printf("[Latency] %u presses, pad edge to DAC: avg %.1f ms, min %.1f, p50 %.1f, p90 %.1f, p99 %.1f, max %.1f ms\n",
+               (unsigned)r.count, r.avgMs, r.minMs, r.p50Ms, r.p90Ms, r.p99Ms, r.maxMs);
+    out.printf("[Latency]   input  (scan, debounce, loop)   avg %5.1f ms, max %5.1f ms\n",
+               r.inputAvgMs, r.inputMaxMs);
+    out.printf("[Latency]   output (block, buffer, DMA)     avg %5.1f ms, max %5.1f ms\n",
+               r.outputAvgMs, r.outputMaxMs);
+    if (r.dropped > 0)
+        out.printf("[Latency]   %u presses dropped (pending list full)\n", (unsigned)r.dropped);
+    for (int b = 0; b < LATENCY_HIST_BINS; b++) {
+        uint32_t c = histogram[b];
+        if (c == 0) continue;
+        if (b == LATENCY_HIST_BINS - 1)
+            out.printf("[Latency]   >=%3d ms: %u\n", b, (unsigned)c);
+        else
+            out.printf("[Latency]   %3d-%3d ms: %u\n", b, b + 1, (unsigned)c);
+    }
+}
+
+#endif
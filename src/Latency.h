@@ -0,0 +1,103 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "Config.h"
+
+// =============================================================================
+// PAD-TO-SOUND LATENCY PROBE (SYNTH_LATENCY)
+// =============================================================================
+// Follows a pad press to the DAC. The UI core stamps the first edge the scan
+// saw (Hardware::getPadEdgeUs) and the noteOn() it led to; the voice carries
+// the stamps to the audio core, which renders it on its own until its first
+// sample above LATENCY_AUDIBLE_LEVEL and notes that sample's output frame.
+// After the next I2S write the frame becomes a time at the DAC: a blocking
+// write returns once the DMA queue has room, so the queue is full and
+//
+//   dacUs = write end + (frame - frames written + DMA frames) / sample rate
+//
+// Each press is split into an input stage (scan, debounce, loop() latency) and
+// an output stage (render block, Maximilian buffer, DMA queue) and goes into a
+// 1 ms histogram. Same threading as the render profiler: the audio core owns
+// the statistics, the UI core reads them and only requests a reset.
+// =============================================================================
+
+#define LATENCY_AUDIBLE_LEVEL 0.001f    // -60 dB of a full-scale voice
+#define LATENCY_HIST_BINS 128           // 1 ms bins, last bin is overflow
+#define LATENCY_PENDING 16              // Audible notes waiting for their I2S write
+
+enum VoiceProbeState {
+    PROBE_IDLE,
+    PROBE_WAITING,      // Stamped by noteOn(), not audible yet
+    PROBE_AUDIBLE       // frame is set, collected after the block barrier
+};
+
+/// Per-voice stamps of a probed note
+struct VoiceProbe {
+    uint32_t inputUs;               // First edge of the pad press
+    uint32_t noteOnUs;              // AudioEngine::noteOn()
+    uint32_t frame;                 // First audible output frame
+    volatile uint8_t state;         // VoiceProbeState
+};
+
+struct LatencyReport {
+    uint32_t count;                 // Presses measured
+    uint32_t dropped;               // Audible notes lost because the pending list was full
+    float avgMs, minMs, maxMs;      // Pad edge to DAC
+    float p50Ms, p90Ms, p99Ms;      // Upper edge of the percentile's bin
+    float inputAvgMs, inputMaxMs;   // Pad edge to noteOn()
+    float outputAvgMs, outputMaxMs; // noteOn() to DAC
+};
+
+#ifdef SYNTH_LATENCY
+
+class LatencyProbe {
+public:
+    LatencyProbe();
+    /// dmaFrames: frames the I2S DMA queue holds (buffer_count * buffer_size)
+    void init(float sampleRate, int dmaFrames);
+
+    // --- Audio core ---
+    /// First sample of a solo voice render above LATENCY_AUDIBLE_LEVEL, or -1
+    static int firstAudible(const float* l, const float* r, int n);
+    /// A probed voice became audible; resolved at the write that contains its frame
+    void audible(const VoiceProbe& probe);
+    /// After an I2S write: `written` frames written in total, write returned at nowUs
+    void onWrite(uint32_t written, uint32_t nowUs);
+
+    // --- UI core ---
+    void getReport(LatencyReport& report);
+    /// Cleared by the audio core at its next write
+    void requestReset() { resetRequested = true; }
+    void printReport(Print& out);
+
+private:
+    void reset();
+    void record(uint32_t inputUs, uint32_t noteOnUs, uint32_t dacUs);
+
+    float usPerFrame;
+    int32_t dmaFrames;
+    volatile bool resetRequested;
+
+    // Audio core only
+    VoiceProbe pending[LATENCY_PENDING];
+    int pendingCount;
+
+    // Written by the audio core only; odd while an update is in progress
+    std::atomic<uint32_t> seq;
+    uint32_t count;
+    uint32_t dropped;
+    uint64_t totalUs;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t inputTotalUs;
+    uint32_t inputMaxUs;
+    uint64_t outputTotalUs;
+    uint32_t outputMaxUs;
+    uint32_t histogram[LATENCY_HIST_BINS];
+};
+
+#endif
+
+#endif
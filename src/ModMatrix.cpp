@@ -0,0 +1,98 @@
+#include "ModMatrix.h"
+#include <math.h>
+
+static const float MOD_TWO_PI = 6.28318530717958647692f;
+
+ModMatrix::ModMatrix() {
+    memset(lfos, 0, sizeof(lfos));
+    memset(sources, 0, sizeof(sources));
+    memset(globals, 0, sizeof(globals));
+    blockRate = 1000.0f;
+    noiseState = 0x12345678u;
+    clearRoutes();
+}
+
+void ModMatrix::init(float sampleRate, int blockSize) {
+    blockRate = sampleRate / (float)blockSize;
+
+    // Defaults mirror the old firmware's LFO set: slow sweep, vibrato, plus two spares
+    setLfo(0, 0.3f, LFO_SINE);
+    setLfo(1, 5.0f, LFO_SINE);
+    setLfo(2, 2.0f, LFO_TRIANGLE);
+    setLfo(3, 8.0f, LFO_SAMPLE_HOLD);
+}
+
+void ModMatrix::setLfo(int index, float rateHz, LfoShape shape) {
+    if (index < 0 || index >= MOD_LFO_COUNT) return;
+    lfos[index].inc = rateHz / blockRate;
+    lfos[index].shape = shape;
+}
+
+bool ModMatrix::setRoute(int slot, ModSource source, ModDest dest, float amount) {
+    if (slot < 0 || slot >= MOD_MAX_ROUTES) return false;
+    if (source >= MOD_SRC_COUNT || dest >= MOD_DST_COUNT) return false;
+    routes[slot].source = source;
+    routes[slot].dest = dest;
+    routes[slot].amount = amount;
+    return true;
+}
+
+void ModMatrix::clearRoutes() {
+    for (int i = 0; i < MOD_MAX_ROUTES; i++) {
+        routes[i].source = MOD_SRC_LFO1;
+        routes[i].dest = MOD_DST_PITCH;
+        routes[i].amount = 0.0f;  // Inactive slots still run, contributing nothing
+    }
+}
+
+void ModMatrix::resetPhases() {
+    for (int i = 0; i < MOD_LFO_COUNT; i++) {
+        lfos[i].phase = 0.0f;
+        lfos[i].held = 0.0f;
+    }
+    noiseState = 0x12345678u;
+}
+
+void ModMatrix::tick() {
+    for (int i = 0; i < MOD_LFO_COUNT; i++) {
+        Lfo& l = lfos[i];
+        float p = l.phase;
+        float out;
+        switch (l.shape) {
+            case LFO_TRIANGLE:    out = 4.0f * fabsf(p - 0.5f) - 1.0f; break;
+            case LFO_SAW:         out = 2.0f * p - 1.0f; break;
+            case LFO_SQUARE:      out = p < 0.5f ? 1.0f : -1.0f; break;
+            case LFO_SAMPLE_HOLD: out = l.held; break;
+            default:              out = sinf(MOD_TWO_PI * p); break;
+        }
+        sources[MOD_SRC_LFO1 + i] = out;
+
+        l.phase += l.inc;
+        if (l.phase >= 1.0f) {
+            l.phase -= 1.0f;
+            noiseState ^= noiseState << 13;
+            noiseState ^= noiseState >> 17;
+            noiseState ^= noiseState << 5;
+            l.held = (float)(noiseState >> 8) * (2.0f / 16777216.0f) - 1.0f;
+        }
+    }
+
+    memset(globals, 0, sizeof(globals));
+    evaluate(routes, MOD_MAX_ROUTES, 0.0f, 0.0f, globals);
+}
+
+void ModMatrix::evaluate(const ModRoute* r, int count, float env, float velocity, float* dst) const {
+    float src[MOD_SRC_COUNT];
+    memcpy(src, sources, sizeof(src));
+    src[MOD_SRC_ENV] = env;
+    src[MOD_SRC_VELOCITY] = velocity;
+
+    for (int i = 0; i < count; i++)
+        dst[r[i].dest] += src[r[i].source] * r[i].amount;
+}
+
+void ModMatrix::evaluateVoice(const ModRoute* patchRoutes, float env, float velocity, float* dst) const {
+    memset(dst, 0, MOD_DST_COUNT * sizeof(float));
+    evaluate(patchRoutes, PATCH_MOD_ROUTES, env, velocity, dst);
+    evaluate(routes, MOD_MAX_ROUTES, env, velocity, dst);
+}
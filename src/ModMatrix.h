@@ -0,0 +1,96 @@
+#ifndef MOD_MATRIX_H
+#define MOD_MATRIX_H
+
+#include <Arduino.h>
+
+// =============================================================================
+// MODULATION MATRIX
+// =============================================================================
+// Sources are evaluated at control rate (once per render block). Routes are a
+// dense array of (source, dest, amount) - unused slots have amount 0 - so
+// evaluation is a fixed multiply-add loop with no branches. The kernels turn
+// the resulting destination values into per-block targets and ramp amp/pan
+// linearly across the block.
+// =============================================================================
+
+#define MOD_LFO_COUNT 4
+#define MOD_MAX_ROUTES 8     // Engine-wide routes (apply to every voice)
+#define PATCH_MOD_ROUTES 3   // Routes owned by each Patch
+
+enum ModSource {
+    MOD_SRC_LFO1,
+    MOD_SRC_LFO2,
+    MOD_SRC_LFO3,
+    MOD_SRC_LFO4,
+    MOD_SRC_ENV,        // Voice amp envelope, 0.0-1.0
+    MOD_SRC_VELOCITY,   // Note velocity, 0.0-1.0
+    MOD_SRC_COUNT
+};
+
+enum ModDest {
+    // Per-voice
+    MOD_DST_PITCH,      // Semitones
+    MOD_DST_CUTOFF,     // Octaves
+    MOD_DST_AMP,        // Gain offset (final gain = 1 + value, floored at 0)
+    MOD_DST_PAN,        // -1.0 (left) - 1.0 (right)
+    // Global (only LFO sources contribute)
+    MOD_DST_MASTER_GAIN,
+    MOD_DST_DRIVE,      // Added to the drive amount
+    MOD_DST_COUNT
+};
+
+#define MOD_DST_VOICE_COUNT MOD_DST_MASTER_GAIN
+
+enum LfoShape {
+    LFO_SINE,
+    LFO_TRIANGLE,
+    LFO_SAW,
+    LFO_SQUARE,
+    LFO_SAMPLE_HOLD
+};
+
+struct ModRoute {
+    uint8_t source;     // ModSource
+    uint8_t dest;       // ModDest
+    float amount;
+};
+
+struct Lfo {
+    float phase;
+    float inc;          // Phase increment per block
+    LfoShape shape;
+    float held;         // Sample & hold value
+};
+
+class ModMatrix {
+public:
+    ModMatrix();
+    void init(float sampleRate, int blockSize);
+
+    void setLfo(int index, float rateHz, LfoShape shape);
+    bool setRoute(int slot, ModSource source, ModDest dest, float amount);
+    void clearRoutes();
+
+    /// Advance all LFOs by one block and evaluate the global destinations
+    void tick();
+    /// Restart all LFOs (and the sample & hold sequence) from phase 0
+    void resetPhases();
+
+    /// Add the contribution of `routes` for one voice into dst[MOD_DST_COUNT]
+    void evaluate(const ModRoute* routes, int count, float env, float velocity, float* dst) const;
+    /// Patch routes plus the engine-wide routes, starting from zero
+    void evaluateVoice(const ModRoute* patchRoutes, float env, float velocity, float* dst) const;
+
+    float getGlobal(ModDest dest) const { return globals[dest]; }
+    float getLfo(int index) const { return sources[MOD_SRC_LFO1 + index]; }
+
+private:
+    float blockRate;                // Blocks per second
+    Lfo lfos[MOD_LFO_COUNT];
+    float sources[MOD_SRC_COUNT];   // LFO slots filled by tick()
+    ModRoute routes[MOD_MAX_ROUTES];
+    float globals[MOD_DST_COUNT];
+    uint32_t noiseState;            // xorshift state for sample & hold (deterministic)
+};
+
+#endif
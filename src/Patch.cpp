@@ -0,0 +1,109 @@
+#include "Patch.h"
+#include "PatchKernels.h"
+
+float g_sineTable[SINE_TABLE_SIZE + 1];
+
+// -----------------------------------------------------------------------------
+// Kernel table: one specialization per (voice mode, oscillator, filter, envelope)
+// -----------------------------------------------------------------------------
+#define KERNEL_ENVS(K, O, F) { K<O, F, EnvGate>, K<O, F, EnvADSR> }
+#define KERNEL_FILTERS(K, O) { KERNEL_ENVS(K, O, FilterNone), KERNEL_ENVS(K, O, FilterLores), KERNEL_ENVS(K, O, FilterSVF) }
+#define KERNEL_OSCS(K) { KERNEL_FILTERS(K, OscSine), KERNEL_FILTERS(K, OscSquare), KERNEL_FILTERS(K, OscSaw), \
+                         KERNEL_FILTERS(K, OscTriangle), KERNEL_FILTERS(K, OscPulse) }
+
+static const RenderFn s_kernels[2][OSC_TYPE_COUNT][FILTER_TYPE_COUNT][ENV_TYPE_COUNT] = {
+    KERNEL_OSCS(renderVoice),
+    KERNEL_OSCS(renderUnison)
+};
+
+// -----------------------------------------------------------------------------
+// Built-in patches (index = Instrument)
+// The basic waveforms use a 1.2 kHz lores filter, which matches the old
+// master filter at the default 50% "Filter" setting.
+// -----------------------------------------------------------------------------
+#define NO_MOD { MOD_SRC_LFO1, MOD_DST_PITCH, 0.0f }
+
+static const Patch s_instrumentPatches[INST_COUNT] = {
+    //  name        osc           pw     det    uni  cents  sprd   filter        cutoff   res   env       A       D      S      R      level
+    { "Sine",     OSC_SINE,     0.5f,  0.0f,  1,   0.0f, 0.0f,  FILTER_LORES, 1200.0f, 1.0f, ENV_GATE, 0.0f,   0.0f,  1.0f,  0.0f,  1.0f,
+      { NO_MOD, NO_MOD, NO_MOD } },
+    { "Square",   OSC_SQUARE,   0.5f,  0.0f,  1,   0.0f, 0.0f,  FILTER_LORES, 1200.0f, 1.0f, ENV_GATE, 0.0f,   0.0f,  1.0f,  0.0f,  1.0f,
+      { NO_MOD, NO_MOD, NO_MOD } },
+    { "Saw",      OSC_SAW,      0.5f,  0.0f,  1,   0.0f, 0.0f,  FILTER_LORES, 1200.0f, 1.0f, ENV_GATE, 0.0f,   0.0f,  1.0f,  0.0f,  1.0f,
+      { NO_MOD, NO_MOD, NO_MOD } },
+    { "Triangle", OSC_TRIANGLE, 0.5f,  0.0f,  1,   0.0f, 0.0f,  FILTER_LORES, 1200.0f, 1.0f, ENV_GATE, 0.0f,   0.0f,  1.0f,  0.0f,  1.0f,
+      { NO_MOD, NO_MOD, NO_MOD } },
+    // Envelope opens the filter: classic pluck
+    { "Pluck",    OSC_SAW,      0.5f,  0.0f,  1,   0.0f, 0.0f,  FILTER_SVF,   1200.0f, 0.9f, ENV_ADSR, 0.002f, 0.25f, 0.0f,  0.15f, 1.0f,
+      { { MOD_SRC_ENV, MOD_DST_CUTOFF, 1.5f }, { MOD_SRC_VELOCITY, MOD_DST_CUTOFF, 0.5f }, NO_MOD } },
+    { "Bass",     OSC_SAW,      0.5f, -12.0f, 1,   0.0f, 0.0f,  FILTER_SVF,    500.0f, 1.4f, ENV_ADSR, 0.004f, 0.30f, 0.6f,  0.08f, 1.0f,
+      { { MOD_SRC_ENV, MOD_DST_CUTOFF, 0.8f }, NO_MOD, NO_MOD } },
+    // Slow LFO sweeps the filter and drifts the stack across the stereo field
+    { "Pad",      OSC_SAW,      0.5f,  0.0f,  5,  22.0f, 0.8f,  FILTER_SVF,    900.0f, 0.7f, ENV_ADSR, 0.40f,  0.80f, 0.7f,  0.90f, 1.0f,
+      { { MOD_SRC_LFO1, MOD_DST_CUTOFF, 0.5f }, { MOD_SRC_LFO3, MOD_DST_PAN, 0.2f }, NO_MOD } },
+    // Vibrato from LFO2
+    { "Lead",     OSC_PULSE,    0.3f,  0.0f,  3,   9.0f, 0.5f,  FILTER_LORES, 2000.0f, 2.0f, ENV_ADSR, 0.005f, 0.20f, 0.8f,  0.20f, 1.0f,
+      { { MOD_SRC_LFO2, MOD_DST_PITCH, 0.15f }, NO_MOD, NO_MOD } }
+};
+
+static void initSineTable() {
+    static bool ready = false;
+    if (ready) return;
+    for (int i = 0; i <= SINE_TABLE_SIZE; i++)
+        g_sineTable[i] = sinf(KERNEL_TWO_PI * (float)i / (float)SINE_TABLE_SIZE);
+    ready = true;
+}
+
+/// Per-sample coefficient for an exponential segment that falls to ENV_SILENCE in `seconds`
+static float expCoeff(float seconds, float sampleRate) {
+    if (seconds <= 0.0f) return 0.0f;
+    return expf(logf(ENV_SILENCE) / (seconds * sampleRate));
+}
+
+bool compilePatch(const Patch& patch, float sampleRate, CompiledPatch& out) {
+    if (patch.osc >= OSC_TYPE_COUNT || patch.filter >= FILTER_TYPE_COUNT || patch.env >= ENV_TYPE_COUNT)
+        return false;
+
+    initSineTable();
+
+    int lanes = constrain((int)patch.unison, 1, UNISON_MAX);
+
+    out.patch = &patch;
+    out.render = s_kernels[lanes > 1 ? 1 : 0][patch.osc][patch.filter][patch.env];
+    out.sampleRate = sampleRate;
+    out.invSampleRate = 1.0f / sampleRate;
+    out.detuneRatio = powf(2.0f, patch.detune / 12.0f);
+
+    // Lanes spread evenly over -1..+1: detune in cents and pan position.
+    // Equal-power pan, normalized so the stack is about as loud as one oscillator.
+    out.unison = lanes;
+    float norm = 1.0f / sqrtf((float)lanes);
+    for (int k = 0; k < UNISON_MAX; k++) {
+        float pos = lanes > 1 ? (2.0f * k / (lanes - 1) - 1.0f) : 0.0f;
+        float pan = (pos * patch.stereoSpread + 1.0f) * (KERNEL_TWO_PI / 8.0f);  // 0..pi/2
+        bool used = k < lanes;
+        out.unisonRatio[k] = powf(2.0f, pos * patch.unisonDetune / 1200.0f);
+        out.unisonGainL[k] = used ? cosf(pan) * sqrtf(2.0f) * norm : 0.0f;
+        out.unisonGainR[k] = used ? sinf(pan) * sqrtf(2.0f) * norm : 0.0f;
+    }
+
+    // Gate envelopes use a fixed 2 ms declick ramp in both directions
+    float attack = patch.env == ENV_GATE ? 0.002f : patch.attack;
+    out.attackStep = attack > 0.0f ? 1.0f / (attack * sampleRate) : 1.0f;
+    out.decayCoeff = expCoeff(patch.decay, sampleRate);
+    out.releaseCoeff = expCoeff(patch.release, sampleRate);
+    return true;
+}
+
+void resetVoicePhases(VoiceDSP& v, const CompiledPatch& p) {
+    // Golden-ratio offsets so the lanes don't start phase-aligned (avoids a spike at note start)
+    for (int k = 0; k < p.unison; k++) {
+        float ph = v.phase + 0.618034f * k;
+        v.unisonPhase[k] = ph - floorf(ph);
+    }
+}
+
+const Patch& getInstrumentPatch(Instrument inst) {
+    if (inst < 0 || inst >= INST_COUNT) inst = INST_SINE;
+    return s_instrumentPatches[inst];
+}
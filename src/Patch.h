@@ -0,0 +1,141 @@
+#ifndef PATCH_H
+#define PATCH_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "ModMatrix.h"
+
+// =============================================================================
+// PATCH DEFINITIONS
+// =============================================================================
+// A Patch describes a sound (oscillator, filter, envelope, modulation routes).
+// compilePatch() turns it into a CompiledPatch: precomputed coefficients plus
+// a pointer to one template-specialized render kernel (see PatchKernels.h).
+// The audio loop only ever calls that pointer - no per-sample instrument switch.
+// =============================================================================
+
+enum OscType {
+    OSC_SINE,
+    OSC_SQUARE,
+    OSC_SAW,
+    OSC_TRIANGLE,
+    OSC_PULSE,
+    OSC_TYPE_COUNT
+};
+
+enum FilterType {
+    FILTER_NONE,
+    FILTER_LORES,   // Maximilian-style resonant lowpass
+    FILTER_SVF,     // TPT state-variable lowpass
+    FILTER_TYPE_COUNT
+};
+
+enum EnvType {
+    ENV_GATE,       // On/off with a short declick ramp
+    ENV_ADSR,
+    ENV_TYPE_COUNT
+};
+
+#define UNISON_MAX 7
+
+struct Patch {
+    const char* name;
+
+    // Oscillator
+    OscType osc;
+    float pulseWidth;   // OSC_PULSE duty 0.05-0.95
+    float detune;       // Semitones added to the played note
+
+    // Unison: 1 = single oscillator, 2-UNISON_MAX = detuned stack spread across the stereo field
+    uint8_t unison;
+    float unisonDetune; // Cents between the outermost sub-oscillators and the centre
+    float stereoSpread; // 0.0 (mono) - 1.0 (outermost sub-oscillators hard left/right)
+
+    // Filter
+    FilterType filter;
+    float cutoff;       // Hz at the default "Filter" setting (50%)
+    float resonance;    // Q, >= 0.5
+
+    // Envelope (seconds, sustain 0.0-1.0)
+    EnvType env;
+    float attack;
+    float decay;
+    float sustain;
+    float release;
+
+    float level;        // Output gain
+
+    // Modulation routes added to the engine's ModMatrix routes for this patch's voices
+    ModRoute mods[PATCH_MOD_ROUTES];
+};
+
+/// Per-voice DSP state touched by the render kernels
+struct VoiceDSP {
+    float phase;        // Oscillator phase 0.0-1.0
+    float baseInc;      // Phase increment for the played note (freq / sampleRate)
+    float f1, f2;       // Filter state (left / mono)
+    float fR1, fR2;     // Filter state (right, unison voices only)
+    float unisonPhase[UNISON_MAX];
+    float env;          // Current envelope level
+    uint8_t envStage;   // EnvStage
+    float gainL, gainR; // Output gains reached at the end of the last block (ramp start)
+};
+
+/// Per-block modulation for one voice (ModMatrix destinations plus the global Filter setting)
+struct VoiceMod {
+    float pitch;        // Semitones
+    float cutoff;       // Octaves
+    float amp;          // Gain offset
+    float pan;          // -1.0 - 1.0
+    float cutoffScale;
+};
+
+enum EnvStage {
+    ENV_STAGE_IDLE,
+    ENV_STAGE_ATTACK,
+    ENV_STAGE_DECAY,
+    ENV_STAGE_SUSTAIN,
+    ENV_STAGE_RELEASE
+};
+
+struct CompiledPatch;
+
+/// Render n samples of one voice, adding into outL/outR. Returns false once the voice is silent.
+typedef bool (*RenderFn)(VoiceDSP& v, const CompiledPatch& p, const VoiceMod& mod, float* outL, float* outR, int n);
+
+struct CompiledPatch {
+    const Patch* patch;
+    RenderFn render;
+
+    float sampleRate;
+    float invSampleRate;
+    float detuneRatio;
+
+    // Unison sub-oscillators: increment ratio and equal-power stereo gains per lane
+    int unison;
+    float unisonRatio[UNISON_MAX];
+    float unisonGainL[UNISON_MAX];
+    float unisonGainR[UNISON_MAX];
+
+    // Envelope per-sample rates / coefficients
+    float attackStep;
+    float decayCoeff;
+    float releaseCoeff;
+};
+
+/// Compile a patch for the given sample rate. Returns false if no kernel matches.
+bool compilePatch(const Patch& patch, float sampleRate, CompiledPatch& out);
+
+/// Reset a voice's oscillator phases for a new note (spreads unison lanes)
+void resetVoicePhases(VoiceDSP& v, const CompiledPatch& p);
+
+/// Advance an idle voice's carrier phase over n samples without rendering it
+inline void advanceVoicePhase(VoiceDSP& v, int n) {
+    float ph = v.phase + v.baseInc * (float)n;
+    v.phase = ph - floorf(ph);
+}
+
+/// Built-in patch for each Instrument (see config.h)
+const Patch& getInstrumentPatch(Instrument inst);
+
+#endif
@@ -0,0 +1,316 @@
+#ifndef PATCH_KERNELS_H
+#define PATCH_KERNELS_H
+
+#include <math.h>
+#include "Patch.h"
+
+// =============================================================================
+// RENDER KERNEL BUILDING BLOCKS
+// =============================================================================
+// Each Osc/Filter/Env policy is a struct with static inline functions so that
+// renderVoice<Osc, Filter, Env> collapses into one straight-line loop.
+// Control-rate work (modulation, filter coefficients) is done once per block;
+// amp/pan gains ramp linearly from the previous block's values.
+// Only Patch.cpp should include this file - it instantiates the kernel table.
+// =============================================================================
+
+#define SINE_TABLE_BITS 9
+#define SINE_TABLE_SIZE (1 << SINE_TABLE_BITS)
+
+extern float g_sineTable[SINE_TABLE_SIZE + 1];  // Guard point for interpolation
+
+static const float KERNEL_TWO_PI = 6.28318530717958647692f;
+
+/// Per-block oscillator parameters
+struct OscCtx {
+    float inc;
+    float invInc;
+    float pulseWidth;
+};
+
+/// PolyBLEP residual for a discontinuity at phase 0 (t in 0..1, dt = increment)
+static inline float polyBlep(float t, float dt, float invDt) {
+    if (t < dt) {
+        t *= invDt;
+        return t + t - t * t - 1.0f;
+    }
+    if (t > 1.0f - dt) {
+        t = (t - 1.0f) * invDt;
+        return t * t + t + t + 1.0f;
+    }
+    return 0.0f;
+}
+
+static inline float advancePhase(float& phase, float inc) {
+    float p = phase;
+    phase += inc;
+    if (phase >= 1.0f) phase -= 1.0f;
+    return p;
+}
+
+// --- Oscillators ---
+
+struct OscSine {
+    static inline float tick(float& phase, const OscCtx& c) {
+        float p = advancePhase(phase, c.inc) * SINE_TABLE_SIZE;
+        int i = (int)p;
+        float frac = p - (float)i;
+        return g_sineTable[i] + frac * (g_sineTable[i + 1] - g_sineTable[i]);
+    }
+};
+
+struct OscSaw {
+    static inline float tick(float& phase, const OscCtx& c) {
+        float p = advancePhase(phase, c.inc);
+        return (2.0f * p - 1.0f) - polyBlep(p, c.inc, c.invInc);
+    }
+};
+
+struct OscSquare {
+    static inline float tick(float& phase, const OscCtx& c) {
+        float p = advancePhase(phase, c.inc);
+        float p2 = p + 0.5f;
+        if (p2 >= 1.0f) p2 -= 1.0f;
+        float out = p < 0.5f ? 1.0f : -1.0f;
+        return out + polyBlep(p, c.inc, c.invInc) - polyBlep(p2, c.inc, c.invInc);
+    }
+};
+
+struct OscPulse {
+    static inline float tick(float& phase, const OscCtx& c) {
+        float p = advancePhase(phase, c.inc);
+        float p2 = p + (1.0f - c.pulseWidth);
+        if (p2 >= 1.0f) p2 -= 1.0f;
+        float out = p < c.pulseWidth ? 1.0f : -1.0f;
+        return out + polyBlep(p, c.inc, c.invInc) - polyBlep(p2, c.inc, c.invInc);
+    }
+};
+
+struct OscTriangle {
+    static inline float tick(float& phase, const OscCtx& c) {
+        float p = advancePhase(phase, c.inc);
+        return 4.0f * fabsf(p - 0.5f) - 1.0f;
+    }
+};
+
+// --- Filters (state is passed in: VoiceDSP::f1/f2, or fR1/fR2 for the right channel) ---
+
+struct FilterNone {
+    struct Coeffs {};
+    static inline void prepare(Coeffs&, float, float, float) {}
+    static inline float tick(float&, float&, const Coeffs&, float in) { return in; }
+};
+
+/// Same topology as maxiFilter::lores, but coefficients are computed per block
+struct FilterLores {
+    struct Coeffs { float c; float r; };
+    static inline void prepare(Coeffs& k, float cutoffHz, float resonance, float invSampleRate) {
+        float maxHz = 0.45f / invSampleRate;
+        if (cutoffHz < 10.0f) cutoffHz = 10.0f;
+        if (cutoffHz > maxHz) cutoffHz = maxHz;
+        if (resonance < 1.0f) resonance = 1.0f;
+        float z = cosf(KERNEL_TWO_PI * cutoffHz * invSampleRate);
+        float zm1 = z - 1.0f;
+        k.c = 2.0f - 2.0f * z;
+        k.r = (sqrtf(2.0f) * sqrtf(-zm1 * zm1 * zm1) + resonance * zm1) / (resonance * zm1);
+    }
+    static inline float tick(float& x, float& y, const Coeffs& k, float in) {
+        x += (in - y) * k.c;
+        y += x;
+        x *= k.r;
+        return y;
+    }
+};
+
+/// Topology-preserving-transform state-variable filter (lowpass output)
+struct FilterSVF {
+    struct Coeffs { float a1; float a2; float a3; };
+    static inline void prepare(Coeffs& k, float cutoffHz, float resonance, float invSampleRate) {
+        float maxHz = 0.45f / invSampleRate;
+        if (cutoffHz < 20.0f) cutoffHz = 20.0f;
+        if (cutoffHz > maxHz) cutoffHz = maxHz;
+        if (resonance < 0.5f) resonance = 0.5f;
+        float g = tanf(0.5f * KERNEL_TWO_PI * cutoffHz * invSampleRate);
+        float kq = 1.0f / resonance;
+        k.a1 = 1.0f / (1.0f + g * (g + kq));
+        k.a2 = g * k.a1;
+        k.a3 = g * k.a2;
+    }
+    static inline float tick(float& ic1, float& ic2, const Coeffs& k, float in) {
+        float v3 = in - ic2;
+        float v1 = k.a1 * ic1 + k.a2 * v3;
+        float v2 = ic2 + k.a2 * ic1 + k.a3 * v3;
+        ic1 = 2.0f * v1 - ic1;
+        ic2 = 2.0f * v2 - ic2;
+        return v2;
+    }
+};
+
+// --- Envelopes ---
+
+#define ENV_SILENCE 0.0001f
+
+struct EnvGate {
+    static inline float tick(VoiceDSP& v, const CompiledPatch& cp) {
+        if (v.envStage == ENV_STAGE_ATTACK) {
+            v.env += cp.attackStep;
+            if (v.env >= 1.0f) { v.env = 1.0f; v.envStage = ENV_STAGE_SUSTAIN; }
+        } else if (v.envStage == ENV_STAGE_RELEASE) {
+            v.env -= cp.attackStep;
+            if (v.env <= 0.0f) { v.env = 0.0f; v.envStage = ENV_STAGE_IDLE; }
+        }
+        return v.env;
+    }
+};
+
+struct EnvADSR {
+    static inline float tick(VoiceDSP& v, const CompiledPatch& cp) {
+        switch (v.envStage) {
+            case ENV_STAGE_ATTACK:
+                v.env += cp.attackStep;
+                if (v.env >= 1.0f) { v.env = 1.0f; v.envStage = ENV_STAGE_DECAY; }
+                break;
+            case ENV_STAGE_DECAY: {
+                float s = cp.patch->sustain;
+                v.env = s + (v.env - s) * cp.decayCoeff;
+                if (v.env - s < ENV_SILENCE) { v.env = s; v.envStage = ENV_STAGE_SUSTAIN; }
+                break;
+            }
+            case ENV_STAGE_RELEASE:
+                v.env *= cp.releaseCoeff;
+                if (v.env < ENV_SILENCE) { v.env = 0.0f; v.envStage = ENV_STAGE_IDLE; }
+                break;
+            default:
+                break;
+        }
+        return v.env;
+    }
+};
+
+// --- Kernels ---
+
+/// Control-rate parameters shared by every sample (and every unison lane) of a block
+struct BlockParams {
+    float inc;          // Phase increment after detune and pitch modulation
+    float cutoffHz;
+    float gainL, gainR; // Ramp start
+    float stepL, stepR; // Per-sample ramp increment
+};
+
+static inline BlockParams beginBlock(VoiceDSP& v, const CompiledPatch& cp, const VoiceMod& mod, int n) {
+    const Patch& p = *cp.patch;
+
+    BlockParams bp;
+    bp.inc = v.baseInc * cp.detuneRatio * exp2f(mod.pitch * (1.0f / 12.0f));
+    bp.cutoffHz = p.cutoff * mod.cutoffScale * exp2f(mod.cutoff);
+
+    // Equal-power pan, unity per channel at centre
+    float amp = p.level * (1.0f + mod.amp);
+    if (amp < 0.0f) amp = 0.0f;
+    float pan = mod.pan < -1.0f ? -1.0f : (mod.pan > 1.0f ? 1.0f : mod.pan);
+    float angle = (pan + 1.0f) * (KERNEL_TWO_PI / 8.0f);
+    float targetL = cosf(angle) * 1.41421356f * amp;
+    float targetR = sinf(angle) * 1.41421356f * amp;
+
+    float invN = 1.0f / (float)n;
+    bp.gainL = v.gainL;
+    bp.gainR = v.gainR;
+    bp.stepL = (targetL - v.gainL) * invN;
+    bp.stepR = (targetR - v.gainR) * invN;
+    v.gainL = targetL;
+    v.gainR = targetR;
+    return bp;
+}
+
+static inline void setOscInc(OscCtx& oc, float inc) {
+    if (inc > 0.49f) inc = 0.49f;
+    oc.inc = inc;
+    oc.invInc = 1.0f / inc;
+}
+
+/// Single oscillator
+template <class Osc, class Filt, class Env>
+bool renderVoice(VoiceDSP& v, const CompiledPatch& cp, const VoiceMod& mod, float* outL, float* outR, int n) {
+    BlockParams bp = beginBlock(v, cp, mod, n);
+
+    OscCtx oc;
+    setOscInc(oc, bp.inc);
+    oc.pulseWidth = cp.patch->pulseWidth;
+
+    typename Filt::Coeffs fc;
+    Filt::prepare(fc, bp.cutoffHz, cp.patch->resonance, cp.invSampleRate);
+
+    float gL = bp.gainL;
+    float gR = bp.gainR;
+    for (int i = 0; i < n; i++) {
+        float s = Osc::tick(v.phase, oc);
+        s = Filt::tick(v.f1, v.f2, fc, s) * Env::tick(v, cp);
+        outL[i] += s * gL;
+        outR[i] += s * gR;
+        gL += bp.stepL;
+        gR += bp.stepR;
+    }
+    return v.envStage != ENV_STAGE_IDLE;
+}
+
+/// Detuned stack: lane increments all derive from the one block increment.
+/// Lane-major: each sub-oscillator runs over the block on its own, with its phase
+/// in a register and no lane loop inside, and is multiply-added into the L/R sums
+/// with its pan gains (contiguous arrays, a loop the compiler vectorizes). The
+/// sums are then filtered per channel.
+template <class Osc, class Filt, class Env>
+bool renderUnison(VoiceDSP& v, const CompiledPatch& cp, const VoiceMod& mod, float* outL, float* outR, int n) {
+    BlockParams bp = beginBlock(v, cp, mod, n);
+    const int lanes = cp.unison;
+
+    OscCtx oc[UNISON_MAX];
+    for (int k = 0; k < lanes; k++) {
+        setOscInc(oc[k], bp.inc * cp.unisonRatio[k]);
+        oc[k].pulseWidth = cp.patch->pulseWidth;
+    }
+
+    typename Filt::Coeffs fc;
+    Filt::prepare(fc, bp.cutoffHz, cp.patch->resonance, cp.invSampleRate);
+
+    float lane[RENDER_BLOCK_SIZE];
+    float sumL[RENDER_BLOCK_SIZE];
+    float sumR[RENDER_BLOCK_SIZE];
+    float gL = bp.gainL;
+    float gR = bp.gainR;
+    for (int start = 0; start < n; start += RENDER_BLOCK_SIZE) {
+        const int m = n - start < RENDER_BLOCK_SIZE ? n - start : RENDER_BLOCK_SIZE;
+
+        for (int k = 0; k < lanes; k++) {
+            float phase = v.unisonPhase[k];
+            for (int i = 0; i < m; i++) lane[i] = Osc::tick(phase, oc[k]);
+            v.unisonPhase[k] = phase;
+
+            const float laneL = cp.unisonGainL[k];
+            const float laneR = cp.unisonGainR[k];
+            if (k == 0) {
+                for (int i = 0; i < m; i++) {
+                    sumL[i] = lane[i] * laneL;
+                    sumR[i] = lane[i] * laneR;
+                }
+            } else {
+                for (int i = 0; i < m; i++) {
+                    sumL[i] += lane[i] * laneL;
+                    sumR[i] += lane[i] * laneR;
+                }
+            }
+        }
+
+        float* l = outL + start;
+        float* r = outR + start;
+        for (int i = 0; i < m; i++) {
+            float e = Env::tick(v, cp);
+            l[i] += Filt::tick(v.f1, v.f2, fc, sumL[i]) * e * gL;
+            r[i] += Filt::tick(v.fR1, v.fR2, fc, sumR[i]) * e * gR;
+            gL += bp.stepL;
+            gR += bp.stepR;
+        }
+    }
+    return v.envStage != ENV_STAGE_IDLE;
+}
+
+#endif
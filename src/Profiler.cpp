@@ -0,0 +1,193 @@
+#include "Profiler.h"
+
+#ifdef SYNTH_PROFILE
+
+RenderProfiler::RenderProfiler() {
+    ticksPerUs = 1.0f;
+    blockPeriodTicks = 1;
+    binTicks = 1;
+    sampleRate = ENGINE_SAMPLE_RATE;
+    dmaTicks = 0;
+    resetRequested = false;
+    seq.store(0);
+    reset();
+}
+
+#ifndef ESP32
+uint32_t RenderProfiler::nowTicks() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+void RenderProfiler::init(float rate, int blockSize, int dmaFrames) {
+#ifdef ESP32
+    ticksPerUs = (float)ESP.getCpuFreqMHz();
+#else
+    ticksPerUs = 1000.0f;
+#endif
+    sampleRate = rate;
+    blockPeriodTicks = (uint32_t)(ticksPerUs * 1.0e6f * blockSize / rate);
+    binTicks = blockPeriodTicks / 16;
+    if (binTicks == 0) binTicks = 1;
+    dmaTicks = (int32_t)(ticksPerUs * 1.0e6f * dmaFrames / rate);
+    reset();
+}
+
+void RenderProfiler::reset() {
+    seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memset(blockStage, 0, sizeof(blockStage));
+    blocks = 0;
+    overruns = 0;
+    underruns = 0;
+    maxBlockTicks = 0;
+    totalBlockTicks = 0;
+    memset(stageTicks, 0, sizeof(stageTicks));
+    memset(histogram, 0, sizeof(histogram));
+    copyRenderTicks = 0;
+    copyWriteTicks = 0;
+    dmaLevel = 0;
+    lastWriteEnd = 0;
+    started = false;
+    seq.fetch_add(1, std::memory_order_release);
+}
+
+void RenderProfiler::endBlock(uint32_t start) {
+    if (resetRequested) {
+        resetRequested = false;
+        reset();
+        return;
+    }
+    uint32_t t = ticks() - start;
+    copyRenderTicks += t;
+
+    seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    blocks++;
+    totalBlockTicks += t;
+    if (t > maxBlockTicks) maxBlockTicks = t;
+    if (t > blockPeriodTicks) overruns++;
+    uint32_t bin = t / binTicks;
+    histogram[bin < PROFILE_HIST_BINS ? bin : PROFILE_HIST_BINS - 1]++;
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++) {
+        stageTicks[s] += blockStage[s];
+        blockStage[s] = 0;
+    }
+    seq.fetch_add(1, std::memory_order_release);
+}
+
+void RenderProfiler::onWrite(uint32_t start, uint32_t end, int frames) {
+    uint32_t waited = end - start;
+    copyWriteTicks += waited;
+    int32_t added = (int32_t)(ticksPerUs * 1.0e6f * frames / sampleRate);
+    if (!started) {
+        started = true;
+        dmaLevel = added;
+    } else {
+        // The DMA played on since the last write: below zero it ran dry
+        int32_t level = dmaLevel - (int32_t)(start - lastWriteEnd);
+        if (level < 0) {
+            seq.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            underruns++;
+            seq.fetch_add(1, std::memory_order_release);
+            level = 0;
+        }
+        // A write that had to wait returns as soon as the queue has room, so it is full
+        level += added - (int32_t)waited;
+        if (waited > (uint32_t)(ticksPerUs * 20.0f) || level > dmaTicks) level = dmaTicks;
+        dmaLevel = level < 0 ? 0 : level;
+    }
+    lastWriteEnd = end;
+}
+
+void RenderProfiler::endCopy(uint32_t start) {
+    uint32_t total = ticks() - start;
+    uint32_t busy = copyRenderTicks + copyWriteTicks;
+    copyRenderTicks = 0;
+    copyWriteTicks = 0;
+    if (total <= busy) return;
+    seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    stageTicks[PROFILE_OUTPUT] += total - busy;
+    seq.fetch_add(1, std::memory_order_release);
+}
+
+void RenderProfiler::getReport(ProfileReport& r) {
+    uint32_t hist[PROFILE_HIST_BINS];
+    uint64_t stages[PROFILE_STAGE_COUNT];
+    uint64_t total;
+    uint32_t maxTicks;
+    // Retry while the audio core is updating (an update takes well under a microsecond)
+    for (;;) {
+        uint32_t before = seq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        r.blocks = blocks;
+        r.overruns = overruns;
+        r.underruns = underruns;
+        total = totalBlockTicks;
+        maxTicks = maxBlockTicks;
+        memcpy(stages, stageTicks, sizeof(stages));
+        memcpy(hist, histogram, sizeof(hist));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == before) break;
+    }
+
+    r.blockPeriodUs = blockPeriodTicks / ticksPerUs;
+    r.maxBlockUs = maxTicks / ticksPerUs;
+    float n = r.blocks > 0 ? (float)r.blocks : 1.0f;
+    r.avgBlockUs = total / ticksPerUs / n;
+    float all = 0.0f;
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++) {
+        r.stageUs[s] = stages[s] / ticksPerUs / n;
+        all += r.stageUs[s];
+    }
+    r.loadPercent = 100.0f * all / r.blockPeriodUs;
+
+    // 99th percentile: upper edge of the bin that reaches 99% of the blocks
+    uint32_t limit = r.blocks - r.blocks / 100;
+    uint32_t count = 0;
+    r.p99BlockUs = 0.0f;
+    for (int b = 0; b < PROFILE_HIST_BINS && r.blocks > 0; b++) {
+        count += hist[b];
+        if (count >= limit) {
+            r.p99BlockUs = b == PROFILE_HIST_BINS - 1 ? r.maxBlockUs : (b + 1) * getBinUs();
+            break;
+        }
+    }
+}
+
+uint32_t RenderProfiler::getHistogram(int bin) const {
+    if (bin < 0 || bin >= PROFILE_HIST_BINS) return 0;
+    return histogram[bin];
+}
+
+float RenderProfiler::getBinUs() const {
+    return binTicks / ticksPerUs;
+}
+
+void RenderProfiler::printReport(Print& out) {
+    static const char* stageNames[PROFILE_STAGE_COUNT] = {
+        "mod", "voices", "fx", "master", "output"
+    };
+    ProfileReport r;
+    getReport(r);
+    out.printf("[Profile] %u blocks, load %.1f%% of %.0f us\n",
+               (unsigned)r.blocks, r.loadPercent, r.blockPeriodUs);
+    out.printf("[Profile] block avg %.1f us, p99 %.1f us, max %.1f us, overruns %u, I2S underruns %u\n",
+               r.avgBlockUs, r.p99BlockUs, r.maxBlockUs, (unsigned)r.overruns, (unsigned)r.underruns);
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++)
+        out.printf("[Profile]   %-7s %6.1f us\n", stageNames[s], r.stageUs[s]);
+    float binUs = getBinUs();
+    for (int b = 0; b < PROFILE_HIST_BINS; b++) {
+        uint32_t c = getHistogram(b);
+        if (c == 0) continue;
+        if (b == PROFILE_HIST_BINS - 1)
+            out.printf("[Profile]   >=%5.0f us: %u\n", b * binUs, (unsigned)c);
+        else
+            out.printf("[Profile]   %5.0f-%5.0f us: %u\n", b * binUs, (b + 1) * binUs, (unsigned)c);
+    }
+}
+
+#endif
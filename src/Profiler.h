@@ -0,0 +1,148 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "Config.h"
+#ifdef ESP32
+#include "esp_timer.h"
+#else
+#include <chrono>
+#endif
+
+// =============================================================================
+// RENDER PROFILER (SYNTH_PROFILE)
+// =============================================================================
+// Times the audio core: each render block is split into stages with the CPU
+// cycle counter (std::chrono off target), and block times go into a fixed
+// histogram for max / p99. The I2S writes are timed as well, which gives the
+// output conversion cost and feeds a model of the DMA queue: when the queue
+// would have run dry before the next write, that is counted as an underrun.
+//
+// The audio core only adds ticks and increments counters (a few dozen cycles
+// per 1 ms block) and publishes them under a sequence counter, so the UI core
+// can read a consistent report at any time. A reset is only requested and
+// carried out by the audio core.
+//
+// Without SYNTH_PROFILE the PROFILE_* macros are empty and no profiler exists.
+// =============================================================================
+
+enum ProfileStage {
+    PROFILE_MOD,        // Mod matrix: LFOs + global routes
+    PROFILE_VOICES,     // Per-voice routes + kernels, all groups up to the block barrier
+    PROFILE_FX,         // Oversampled drive
+    PROFILE_MASTER,     // Gain, DC blocker, clip, visualizer/spectrum taps
+    PROFILE_OUTPUT,     // Float -> int16 conversion for the I2S buffer
+    PROFILE_STAGE_COUNT
+};
+
+#define PROFILE_HIST_BINS 32        // Bin width 1/16 block period: 0-200% load, last bin is overflow
+
+struct ProfileReport {
+    uint32_t blocks;                // Render blocks measured
+    float loadPercent;              // All stages / audio time rendered
+    float avgBlockUs;
+    float p99BlockUs;               // Upper edge of the 99th percentile bin
+    float maxBlockUs;
+    float blockPeriodUs;            // Deadline of one render block
+    uint32_t overruns;              // Blocks which took longer than their period
+    uint32_t underruns;             // Estimated I2S DMA underruns
+    float stageUs[PROFILE_STAGE_COUNT];  // Average per render block
+};
+
+/// Wall-clock microseconds for timing renders that run outside the audio task
+/// (bounce, benchmark). Not micros(): the desktop simulation's clock follows
+/// the audio written, which stands still meanwhile.
+static inline uint64_t renderClockUs() {
+#ifdef ESP32
+    return esp_timer_get_time();
+#else
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+#ifdef SYNTH_PROFILE
+
+class RenderProfiler {
+public:
+    RenderProfiler();
+    /// dmaFrames: frames the I2S DMA queue holds at least (buffer_count * buffer_size)
+    void init(float sampleRate, int blockSize, int dmaFrames);
+
+    static inline uint32_t ticks() {
+#ifdef ESP32
+        return ESP.getCycleCount();
+#else
+        return nowTicks();
+#endif
+    }
+
+    // --- Audio core ---
+    /// Adds the time since `since` to a stage, returns the new mark
+    inline uint32_t stage(ProfileStage s, uint32_t since) {
+        uint32_t t = ticks();
+        blockStage[s] += t - since;
+        return t;
+    }
+    /// End of a render block that started at `start`
+    void endBlock(uint32_t start);
+    /// An I2S write of `frames` frames from `start` to `end`
+    void onWrite(uint32_t start, uint32_t end, int frames);
+    /// End of AudioEngine::copy() that started at `start`: the remainder is output conversion
+    void endCopy(uint32_t start);
+
+    // --- UI core ---
+    void getReport(ProfileReport& report);
+    /// Block time histogram: count of bin (width getBinUs())
+    uint32_t getHistogram(int bin) const;
+    float getBinUs() const;
+    /// Cleared by the audio core at its next block
+    void requestReset() { resetRequested = true; }
+    void printReport(Print& out);
+
+private:
+#ifndef ESP32
+    static uint32_t nowTicks();
+#endif
+    void reset();
+
+    float ticksPerUs;
+    uint32_t blockPeriodTicks;
+    uint32_t binTicks;
+    float sampleRate;
+    int32_t dmaTicks;               // Audio time the DMA queue holds, in ticks
+    volatile bool resetRequested;
+
+    // Written by the audio core only; odd while an update is in progress
+    std::atomic<uint32_t> seq;
+    uint32_t blockStage[PROFILE_STAGE_COUNT];   // Current block
+    uint32_t blocks;
+    uint32_t overruns;
+    uint32_t underruns;
+    uint32_t maxBlockTicks;
+    uint64_t totalBlockTicks;
+    uint64_t stageTicks[PROFILE_STAGE_COUNT];
+    uint32_t histogram[PROFILE_HIST_BINS];
+    uint32_t copyRenderTicks;       // Render and write time inside the current copy()
+    uint32_t copyWriteTicks;
+    int32_t dmaLevel;               // Estimated audio time queued in the DMA
+    uint32_t lastWriteEnd;
+    bool started;                   // First write seen (the DMA starts empty)
+};
+
+#define PROFILE_MARK(var)               uint32_t var = RenderProfiler::ticks()
+#define PROFILE_STAGE(prof, s, mark)    mark = (prof).stage(s, mark)
+#define PROFILE_END_BLOCK(prof, start)  (prof).endBlock(start)
+#define PROFILE_END_COPY(prof, start)   (prof).endCopy(start)
+
+#else
+
+#define PROFILE_MARK(var)
+#define PROFILE_STAGE(prof, s, mark)
+#define PROFILE_END_BLOCK(prof, start)
+#define PROFILE_END_COPY(prof, start)
+
+#endif
+
+#endif
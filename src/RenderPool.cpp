@@ -0,0 +1,124 @@
+#include "RenderPool.h"
+#include "AudioTools.h"
+#include "AudioTools/Concurrency/TaskNotifier.h"
+#ifdef USE_CPP_TASK
+#include "AudioTools/Concurrency/Desktop.h"
+#else
+#include "AudioTools/Concurrency/RTOS/Task.h"
+#endif
+#include <atomic>
+
+// -----------------------------------------------------------------------------
+// Static helper state - AudioTools objects live in .cpp to keep them out of the header
+// A job is published by bumping s_generation; each helper renders when it sees
+// a new generation and the last one to finish wakes the audio task.
+// -----------------------------------------------------------------------------
+struct RenderHelper {
+    audio_tools::TaskNotifier start;
+    bool created = false;
+    uint32_t seen = 0;              // Last generation rendered
+    int result = 0;
+    float bufL[RENDER_BLOCK_SIZE];
+    float bufR[RENDER_BLOCK_SIZE];
+    audio_tools::Task task;         // Last: off target it is joined before the rest is destroyed
+};
+
+static audio_tools::TaskNotifier s_done;
+static RenderHelper s_helpers[RENDER_MAX_GROUPS - 1];
+static std::atomic<uint32_t> s_generation{0};
+static std::atomic<int> s_pending{0};
+static std::atomic<bool> s_running{false};
+static RenderGroupFn s_fn = nullptr;
+static void* s_ctx = nullptr;
+static int s_n = 0;
+
+static void helperLoop(int h) {
+    RenderHelper& helper = s_helpers[h];
+    uint32_t gen = s_generation.load(std::memory_order_acquire);
+    if (gen == helper.seen) {
+        if (!s_running.load(std::memory_order_relaxed)) {
+            delay(RENDER_WAIT_MS);
+            return;
+        }
+        helper.start.wait(RENDER_WAIT_MS);
+        return;
+    }
+    helper.seen = gen;
+    memset(helper.bufL, 0, s_n * sizeof(float));
+    memset(helper.bufR, 0, s_n * sizeof(float));
+    helper.result = s_fn(s_ctx, h + 1, helper.bufL, helper.bufR, s_n);
+    if (s_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        s_done.notify();
+}
+
+RenderPool::RenderPool() {
+    groups = 1;
+}
+
+bool RenderPool::begin(int groupCount, int core, int priority) {
+    end();
+    if (groupCount < 1) groupCount = 1;
+    if (groupCount > RENDER_MAX_GROUPS) groupCount = RENDER_MAX_GROUPS;
+
+    // The groups whose helper started run; the first failure ends the list
+    s_running = true;
+    int started = 1;
+    for (int h = 0; h < groupCount - 1; h++) {
+        RenderHelper& helper = s_helpers[h];
+        helper.seen = s_generation.load();
+        if (!helper.created) {
+            if (!helper.task.create("RenderHelper", RENDER_HELPER_STACK, priority, core)) {
+                Serial.println("[RenderPool] Helper task creation FAILED");
+                break;
+            }
+            helper.created = true;
+        }
+        if (!helper.task.begin([h]() { helperLoop(h); })) {
+            Serial.println("[RenderPool] Helper task start FAILED");
+            break;
+        }
+        started++;
+    }
+    groups = started;
+    return started == groupCount;
+}
+
+void RenderPool::end() {
+    if (groups <= 1) return;
+    s_running = false;
+    for (int h = 0; h < groups - 1; h++) {
+        s_helpers[h].start.notify();
+        s_helpers[h].task.end();
+    }
+    groups = 1;
+}
+
+int RenderPool::render(RenderGroupFn fn, void* ctx, float* outL, float* outR, int n) {
+    if (groups <= 1)
+        return fn(ctx, 0, outL, outR, n);
+
+    s_fn = fn;
+    s_ctx = ctx;
+    s_n = n;
+    s_pending.store(groups - 1, std::memory_order_relaxed);
+    s_generation.fetch_add(1, std::memory_order_release);
+    for (int h = 0; h < groups - 1; h++)
+        s_helpers[h].start.notify();
+
+    int result = fn(ctx, 0, outL, outR, n);
+
+    // Block barrier: a notification left over from the previous block only
+    // causes one extra check
+    while (s_pending.load(std::memory_order_acquire) > 0)
+        s_done.wait(RENDER_WAIT_MS);
+
+    for (int h = 0; h < groups - 1; h++) {
+        const RenderHelper& helper = s_helpers[h];
+        for (int i = 0; i < n; i++) {
+            outL[i] += helper.bufL[i];
+            outR[i] += helper.bufR[i];
+        }
+        result += helper.result;
+    }
+    return result;
+}
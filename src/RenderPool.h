@@ -0,0 +1,48 @@
+#ifndef RENDER_POOL_H
+#define RENDER_POOL_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// =============================================================================
+// PARALLEL VOICE RENDERING
+// =============================================================================
+// Fork/join once per render block: the audio task wakes the helpers, renders
+// voice group 0 itself and then waits at the block barrier until every helper
+// has rendered its group into a private block buffer. The groups are summed
+// into the output, so parallel rendering adds no block of latency.
+//
+// On the ESP32-S3 a single helper runs on the UI core (RENDER_HELPER_CORE),
+// at a priority above loop(). Off target the helpers are std::threads (the
+// AudioTools Task), so any number of groups up to RENDER_MAX_GROUPS works.
+// The wake-up uses task notifications and the barrier a lock-free counter.
+// =============================================================================
+
+#define RENDER_MAX_GROUPS 4
+#define RENDER_HELPER_STACK 4096
+#define RENDER_WAIT_MS 5            // Helpers re-check for end() at least this often
+
+/// Renders voice group `group` of `ctx`, adding n samples into outL/outR.
+/// Returns the number of voices that were active in the group.
+typedef int (*RenderGroupFn)(void* ctx, int group, float* outL, float* outR, int n);
+
+class RenderPool {
+public:
+    RenderPool();
+    /// Starts groups - 1 helper tasks (1 = render on the calling task only).
+    /// False when a helper could not be started: getGroups() then tells how
+    /// many groups run, down to 1.
+    bool begin(int groups, int core = RENDER_HELPER_CORE, int priority = RENDER_HELPER_PRIORITY);
+    /// Stops the helpers; not while a render() is in progress
+    void end();
+    int getGroups() const { return groups; }
+
+    /// Audio task: renders every group and sums them into outL/outR (not
+    /// cleared here). Returns the sum of the groups' results.
+    int render(RenderGroupFn fn, void* ctx, float* outL, float* outR, int n);
+
+private:
+    int groups;
+};
+
+#endif
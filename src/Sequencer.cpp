@@ -10,22 +10,35 @@ Sequencer::Sequencer(AudioEngine& audio) : audioEngine(audio) {
     currentTrack = 0;
     currentOctave = 4;
     lastStepTime = 0;
+    stepCount = 0;
+    recordMode = RECORD_OFF;
+    staleFirstMarker = 0;
+    runStartFrame = 0;
+    runStarted = false;
     
     // Default Settings
     swingAmount = 0; // 0%
     gateLength = 0.8f; // 80% duration
+
+    lastTapTime = 0;
+    tapCount = 0;
+    memset(tapIntervals, 0, sizeof(tapIntervals));
 }
 
 void Sequencer::init() {
     memset(sequence, 0, sizeof(sequence));
     memset(stepNotes, 0, sizeof(stepNotes));
+    memset(stepOffsets, 0, sizeof(stepOffsets));
     
     trackInstruments[0] = INST_SINE;
     trackInstruments[1] = INST_SQUARE;
     trackInstruments[2] = INST_SAW;
     trackInstruments[3] = INST_TRIANGLE;
 
-    for(int i=0; i<4; i++) activeStepNotes[i] = -1;
+    for(int i=0; i<4; i++) {
+        activeStepNotes[i] = -1;
+        firedStep[i] = 0;
+    }
 
     // Load last pattern on startup?
     // loadPattern(0);
@@ -42,6 +55,10 @@ void Sequencer::savePattern(int patternNum) {
         // Save Notes
         sprintf(key, "n%d_t%d", patternNum, t);
         prefs.putBytes(key, stepNotes[t], 16);
+
+        // Save Micro-timing
+        sprintf(key, "o%d_t%d", patternNum, t);
+        prefs.putBytes(key, stepOffsets[t], 16);
     }
     prefs.end();
 }
@@ -55,15 +72,21 @@ void Sequencer::loadPattern(int patternNum) {
         
         sprintf(key, "n%d_t%d", patternNum, t);
         prefs.getBytes(key, stepNotes[t], 16);
+
+        // Patterns saved before micro-timing play on the grid
+        memset(stepOffsets[t], 0, 16);
+        sprintf(key, "o%d_t%d", patternNum, t);
+        prefs.getBytes(key, stepOffsets[t], 16);
     }
     prefs.end();
 }
 
 void Sequencer::update() {
-    if (!isPlaying) return;
-    
+    update(millis());
+}
+
+unsigned long Sequencer::getStepDuration(int step) {
     unsigned long baseStepDuration = (60000 / bpm) / 4;
-    unsigned long currentDuration = baseStepDuration;
 
     // Swing Logic
     // Even steps (0, 2...) are longer, Odd steps are shorter?
@@ -78,56 +101,94 @@ void Sequencer::update() {
     
     // If Step is Even (0, 2...), duration = base + offset
     // If Step is Odd (1, 3...), duration = base - offset
-    if (currentStep % 2 == 0) currentDuration = baseStepDuration + swingOffset;
-    else currentDuration = baseStepDuration - swingOffset;
+    if (step % 2 == 0) return baseStepDuration + swingOffset;
+    return baseStepDuration - swingOffset;
+}
 
-    unsigned long now = millis();
-    
-    // Gate/Note Off Check
-    // We need to turn off notes from the *current* step if they exceeded gate length
-    // This is tricky without per-step note tracking. 
-    // Simplified: Turn off *all* active notes if we are at gate% of duration?
-    // Better: Just use `noteOff` for the notes played at `lastStepTime`.
-    static bool gateOpen = false;
+unsigned long Sequencer::getLoopDuration() {
+    unsigned long total = 0;
+    for (int step = 0; step < 16; step++) total += getStepDuration(step);
+    return total;
+}
+
+void Sequencer::update(unsigned long now) {
+    if (!isPlaying) return;
+
+    unsigned long currentDuration = getStepDuration(currentStep);
     
-    if (gateOpen && (now - lastStepTime >= (currentDuration * gateLength))) {
-        // Close Gate
-         for (int track = 0; track < 4; track++) {
-             // We don't track exactly which note was played easily without extra state.
-             // But we can guess or tracking it.
-             // Let's just turn off the note associated with the current step's settings?
-             // Or rely on AudioEngine taking care of it?
-             // Issue: If we changed pitch, `stepNotes` might be different?
-             // Let's track `activeStepNotes[4]`
-             if (activeStepNotes[track] != -1) {
-                 audioEngine.noteOff(activeStepNotes[track]);
-                 activeStepNotes[track] = -1;
-             }
-         }
-         gateOpen = false;
+    // Gate: each track's note is released gate length after it started
+    for (int track = 0; track < 4; track++) {
+        if (activeStepNotes[track] != -1 && now - noteStartMs[track] >= noteGateMs[track]) {
+            audioEngine.noteOff(activeStepNotes[track]);
+            activeStepNotes[track] = -1;
+        }
     }
 
     if (now - lastStepTime >= currentDuration) {
-        // Next Step
+        // Next Step, on the grid (micro-timing is relative to it); after a
+        // stall of more than a step the grid restarts from now
         currentStep = (currentStep + 1) % 16;
-        lastStepTime = now;
-        gateOpen = true; 
-        
-        for (int track = 0; track < 4; track++) {
-            activeStepNotes[track] = -1; // Reset
-            if (sequence[track][currentStep]) {
-                int note = stepNotes[track][currentStep];
-                audioEngine.noteOn(note, trackInstruments[track]);
-                activeStepNotes[track] = note;
-            }
-        }
+        lastStepTime += currentDuration;
+        stepCount++;
+        currentDuration = getStepDuration(currentStep);
+        if (now - lastStepTime >= currentDuration) lastStepTime = now;
+        // Output frame of the step, for recording (notes on the grid start with it)
+        audioEngine.sendMarker(currentStep);
     }
+
+    // Notes on the grid play with their step. Micro-timed notes play up to
+    // half a step late, or early in the step before theirs.
+    int nextStep = (currentStep + 1) % 16;
+    long sinceStep = (long)(now - lastStepTime);
+    for (int track = 0; track < 4; track++) {
+        playDue(track, currentStep, stepCount, sinceStep, now);
+        playDue(track, nextStep, stepCount + 1, sinceStep - (long)currentDuration, now);
+    }
+}
+
+/// Plays the note of `step` (the step counted `count`) once its offset is reached
+void Sequencer::playDue(int track, int step, uint32_t count, long sinceStepMs, unsigned long now) {
+    if (!sequence[track][step] || firedStep[track] == count) return;
+    if (sinceStepMs < stepOffsets[track][step]) return;
+
+    if (activeStepNotes[track] != -1)
+        audioEngine.noteOff(activeStepNotes[track]);
+    int note = stepNotes[track][step];
+    audioEngine.noteOn(note, trackInstruments[track]);
+    activeStepNotes[track] = note;
+    noteStartMs[track] = now;
+    noteGateMs[track] = (unsigned long)(getStepDuration(step) * gateLength);
+    firedStep[track] = count;
 }
 
 void Sequencer::start() {
+    start(millis());
+}
+
+void Sequencer::start(unsigned long nowMs) {
     isPlaying = true;
     currentStep = 15; 
-    lastStepTime = millis(); 
+    lastStepTime = nowMs; 
+    // The count-in step (15) plays nothing
+    stepCount = 0;
+    staleFirstMarker = audioEngine.getMarkerFrame(0);
+    runStarted = false;
+    for (int track = 0; track < 4; track++) {
+        activeStepNotes[track] = -1;
+        firedStep[track] = 0;
+    }
+}
+
+void Sequencer::releaseNotes() {
+    // We don't track exactly which note was played easily without extra state.
+    // Issue: If we changed pitch, `stepNotes` might be different?
+    // So track `activeStepNotes[4]`
+    for (int track = 0; track < 4; track++) {
+        if (activeStepNotes[track] != -1) {
+            audioEngine.noteOff(activeStepNotes[track]);
+            activeStepNotes[track] = -1;
+        }
+    }
 }
 
 void Sequencer::stop() {
@@ -143,6 +204,7 @@ void Sequencer::togglePlay() {
 
 void Sequencer::setBPM(int newBpm) {
     bpm = constrain(newBpm, 60, 240);
+    audioEngine.getArpeggiator().setTempo(bpm);  // The arpeggiator runs at the sequencer tempo
 }
 
 int Sequencer::getBPM() {
@@ -162,7 +224,10 @@ Instrument Sequencer::getInstrument(int track) {
 
 void Sequencer::clearTrack(int track) {
     if (track >= 0 && track < 4) {
-        for (int i=0; i<16; i++) sequence[track][i] = false;
+        for (int i=0; i<16; i++) {
+            sequence[track][i] = false;
+            stepOffsets[track][i] = 0;
+        }
     }
 }
 
@@ -171,6 +236,7 @@ void Sequencer::toggleStep(int track, int step) {
         sequence[track][step] = !sequence[track][step];
         if (sequence[track][step]) {
             stepNotes[track][step] = 36 + step + (currentOctave * 12);
+            stepOffsets[track][step] = 0;
         }
     }
 }
@@ -182,6 +248,64 @@ bool Sequencer::getStep(int track, int step) {
     return false;
 }
 
+bool Sequencer::recordNote(int note, uint32_t edgeUs) {
+    if (!isPlaying || recordMode == RECORD_OFF) return false;
+
+    // Count-in: no step of this run has been rendered yet
+    if (!runStarted) {
+        uint32_t first = audioEngine.getMarkerFrame(0);
+        if (first == staleFirstMarker) return false;
+        runStartFrame = first;
+        runStarted = true;
+    }
+
+    // The step heard last at the press: the latest marker of this run at or before it
+    uint32_t press = audioEngine.getOutputFrame(edgeUs);
+    int heard = -1;
+    uint32_t age = 0;
+    for (int step = 0; step < 16; step++) {
+        uint32_t marker = audioEngine.getMarkerFrame(step);
+        if ((int32_t)(marker - runStartFrame) < 0) continue;
+        int32_t since = (int32_t)(press - marker);
+        if (since >= 0 && (heard < 0 || (uint32_t)since < age)) {
+            heard = step;
+            age = since;
+        }
+    }
+    if (heard < 0) return false;
+
+    // Nearest step: the heard one, or the next one from half a step on
+    const float framesPerMs = ENGINE_SAMPLE_RATE / 1000.0f;
+    int step = heard;
+    float offsetMs = age / framesPerMs;
+    float durationMs = getStepDuration(heard);
+    if (offsetMs > durationMs / 2) {
+        step = (heard + 1) % 16;
+        offsetMs -= durationMs;
+    }
+    float limit = min(127.0f, getStepDuration(step) / 2.0f);
+    offsetMs = constrain(offsetMs, -limit, limit);
+
+    int track = currentTrack;
+    sequence[track][step] = true;
+    stepNotes[track][step] = note;
+    stepOffsets[track][step] = recordMode == RECORD_MICRO ? (int8_t)lroundf(offsetMs) : 0;
+
+    // The press already played the note: the step does not repeat it in this pass
+    if (step == currentStep)
+        firedStep[track] = stepCount;
+    else if (step == (currentStep + 1) % 16)
+        firedStep[track] = stepCount + 1;
+    return true;
+}
+
+int Sequencer::getStepOffset(int track, int step) {
+    if (track >= 0 && track < 4 && step >= 0 && step < 16) {
+        return stepOffsets[track][step];
+    }
+    return 0;
+}
+
 int Sequencer::getCurrentStep() { return currentStep; }
 int Sequencer::getCurrentTrack() { return currentTrack; }
 void Sequencer::setCurrentTrack(int track) { currentTrack = track % 4; }
@@ -205,3 +329,41 @@ float Sequencer::getGate() {
     return gateLength;
 }
 
+
+void Sequencer::syncToBeat(float beatBpm, unsigned long beatMs, float phaseGain) {
+    setBPM((int)(beatBpm + 0.5f));
+    if (!isPlaying) return;
+
+    // Beat start: the step start minus the steps of the beat before it. Swing
+    // lengthens even and shortens odd steps, so a beat (4 steps) keeps its length.
+    int beatStep = currentStep - currentStep % 4;
+    long seqBeat = (long)lastStepTime;
+    for (int step = beatStep; step < currentStep; step++)
+        seqBeat -= (long)getStepDuration(step);
+    long period = 0;
+    for (int step = beatStep; step < beatStep + 4; step++)
+        period += (long)getStepDuration(step);
+    long err = ((long)(seqBeat - (long)beatMs)) % period;
+    if (err > period / 2) err -= period;
+    if (err < -period / 2) err += period;
+
+    // Never move the step start past now, or the next step would fire at once
+    unsigned long now = millis();
+    unsigned long adjusted = (unsigned long)((long)lastStepTime - (long)(err * phaseGain));
+    if ((long)(now - adjusted) < 0) adjusted = now;
+    lastStepTime = adjusted;
+}
+
+void Sequencer::tapTempo() {
+    unsigned long now = millis();
+    if (tapCount > 0 && now - lastTapTime > 2000) tapCount = 0;  // Start over after a pause
+    if (tapCount > 0) tapIntervals[(tapCount - 1) % 4] = now - lastTapTime;
+    tapCount++;
+    lastTapTime = now;
+    if (tapCount < 2) return;
+
+    int n = min(tapCount - 1, 4);
+    unsigned long sum = 0;
+    for (int i = 0; i < n; i++) sum += tapIntervals[i];
+    syncToBeat(60000.0f * n / (float)sum, now, 1.0f);
+}
@@ -5,13 +5,28 @@
 #include "Config.h"
 #include "AudioEngine.h"
 
+// Live recording: pad presses while the pattern plays go into the current track
+enum RecordMode {
+    RECORD_OFF,
+    RECORD_QUANTIZED,   // On the nearest step
+    RECORD_MICRO,       // Nearest step plus the press's offset from it
+    RECORD_MODE_COUNT
+};
+
+static const char* recordModeNames[] = {"Off", "Quant", "Micro"};
+
 class Sequencer {
 public:
     Sequencer(AudioEngine& audio);
     void init();
     void update();
+    /// Same as update() on a given clock (ms), e.g. the virtual clock of an offline bounce
+    void update(unsigned long nowMs);
     void start();
+    void start(unsigned long nowMs);
     void stop();
+    /// Note-off for the notes of the current step (the voices release)
+    void releaseNotes();
     void togglePlay();
     void setBPM(int newBpm);
     int getBPM();
@@ -45,6 +60,30 @@ public:
     int getSwing();
     void setGate(float length); // 0.0-1.0
     float getGate();
+    /// Duration of a step in ms, with swing
+    unsigned long getStepDuration(int step);
+    /// Duration of all 16 steps in ms
+    unsigned long getLoopDuration();
+
+    // Live Recording
+    // Presses are placed on the output clock (AudioEngine::getOutputFrame),
+    // against the frames the steps were actually played at: a press right on
+    // a note heard from the speaker lands on that note's step.
+    void setRecordMode(RecordMode mode) { recordMode = mode; }
+    RecordMode getRecordMode() { return recordMode; }
+    /// Merge a pad press (edgeUs: micros() of its first edge) into the current
+    /// track. False while stopped or not recording.
+    bool recordNote(int note, uint32_t edgeUs);
+    /// Micro-timing of a step in ms (negative: before the step)
+    int getStepOffset(int track, int step);
+
+    // External Clock
+    /// Follow an external beat: takes its tempo and pulls the sequencer's beat
+    /// (every 4th step) toward beatMs, the millis() time of any input beat.
+    /// phaseGain 1.0 snaps; smaller values glide over several calls.
+    void syncToBeat(float beatBpm, unsigned long beatMs, float phaseGain = 0.25f);
+    /// Tap tempo: averages the last taps and puts a beat on the tap
+    void tapTempo();
     
     int swingAmount; // 0-100
     float gateLength; // 0.0 - 1.0
@@ -57,11 +96,31 @@ private:
     int currentTrack;
     int currentOctave;
     unsigned long lastStepTime;
+    uint32_t stepCount;             // Steps since start(), the current one included
     
     uint8_t stepNotes[4][16];
+    int8_t stepOffsets[4][16];      // Micro-timing, ms from the step (within half a step)
 
     // Track active notes for gate control
     int activeStepNotes[4];
+    unsigned long noteStartMs[4];
+    unsigned long noteGateMs[4];
+    uint32_t firedStep[4];          // stepCount of the step each track last played
+
+    RecordMode recordMode;
+    // Step markers still hold the frames of the previous run until this run
+    // stamps them. Step 0's is the run's first: once it differs from the value
+    // start() saw, it is the frame the run started at, and older markers are stale.
+    uint32_t staleFirstMarker;      // Step 0's marker frame at start()
+    uint32_t runStartFrame;
+    bool runStarted;                // runStartFrame is known
+
+    void playDue(int track, int step, uint32_t count, long sinceStepMs, unsigned long now);
+
+    // Tap tempo
+    unsigned long lastTapTime;
+    unsigned long tapIntervals[4];
+    int tapCount;
 };
 
 #endif
@@ -0,0 +1,90 @@
+#ifndef SMOOTHED_PARAM_H
+#define SMOOTHED_PARAM_H
+
+#include <Arduino.h>
+
+// =============================================================================
+// SMOOTHED PARAMETER
+// =============================================================================
+// A value set from the UI that the audio core glides to instead of jumping
+// (zipper noise from 5% menu steps). A new target starts a linear ramp of
+// SMOOTH_RAMP_MS from the current value. Per-sample consumers get the ramp as
+// a gain array for their block loop; control-rate consumers take one value
+// per block. Once the ramp is done the parameter is settled: ramp() returns
+// false without touching the array and the caller keeps its constant-gain
+// loop, so a parameter nobody moves costs a compare and a flag check.
+//
+// Threading: setTarget() from the UI core, the rest belongs to the audio core.
+// =============================================================================
+
+#define SMOOTH_RAMP_MS 20.0f
+
+class SmoothedParam {
+public:
+    explicit SmoothedParam(float initial = 0.0f)
+        : target(initial), value(initial), rampTarget(initial), inc(0.0f), remaining(0), rampSamples(1) {}
+    /// Ramp length; call before the audio core runs
+    void init(float sampleRate, float rampMs = SMOOTH_RAMP_MS) {
+        rampSamples = max(1, (int)(sampleRate * rampMs / 1000.0f));
+    }
+
+    // --- UI core ---
+    void setTarget(float v) { target = v; }
+    float getTarget() const { return target; }
+
+    // --- Audio core ---
+    /// Jump to the target (reset state, e.g. for a repeatable offline render)
+    void snap() {
+        value = rampTarget = target;
+        remaining = 0;
+    }
+
+    /// Moves n samples on. False when settled: getValue() holds for the whole
+    /// block. True while ramping, with the block's values in out[0..n-1].
+    bool ramp(float* out, int n) {
+        if (!update()) return false;
+        int k = min(n, remaining);
+        float v = value;
+        for (int i = 0; i < k; i++) {
+            v += inc;
+            out[i] = v;
+        }
+        remaining -= k;
+        value = remaining == 0 ? rampTarget : v;
+        for (int i = k; i < n; i++) out[i] = value;
+        return true;
+    }
+
+    /// Control rate: moves n samples on and returns the value at the block end
+    float next(int n) {
+        if (update()) {
+            int k = min(n, remaining);
+            remaining -= k;
+            value = remaining == 0 ? rampTarget : value + inc * k;
+        }
+        return value;
+    }
+
+    float getValue() const { return value; }
+
+private:
+    /// Starts a ramp if the target moved; false when settled
+    bool update() {
+        float t = target;
+        if (t != rampTarget) {
+            rampTarget = t;
+            remaining = rampSamples;
+            inc = (t - value) / rampSamples;
+        }
+        return remaining > 0;
+    }
+
+    volatile float target;
+    float value;
+    float rampTarget;       // Target of the ramp in progress
+    float inc;              // Per sample
+    int remaining;          // Samples left in the ramp (0 = settled)
+    int rampSamples;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "Spectrum.h"
+#include "AudioTools.h"
+#include "AudioTools/AudioLibs/AudioRealFFT.h"
+#include "AudioTools/Concurrency/LockFree/DoubleBufferLockFree.h"
+#include <math.h>
+
+// -----------------------------------------------------------------------------
+// Static AudioTools objects - live in .cpp to keep the headers out of Spectrum.h
+// s_frames: audio core -> UI core, s_bands: UI core -> any reader
+// -----------------------------------------------------------------------------
+static audio_tools::FFTDriverRealFFT s_fft;
+static audio_tools::DoubleBufferLockFree<float> s_frames;
+static audio_tools::DoubleBufferLockFree<float> s_bands;
+
+SpectrumAnalyzer::SpectrumAnalyzer() {
+    enabled = false;
+    framePos = 0;
+    lastFrame = 0;
+    binHz = ENGINE_SAMPLE_RATE / (float)SPECTRUM_FFT_SIZE;
+    memset(bandStart, 0, sizeof(bandStart));
+    memset(window, 0, sizeof(window));
+    memset(bands, 0, sizeof(bands));
+}
+
+bool SpectrumAnalyzer::init(float sampleRate) {
+    if (!s_fft.begin(SPECTRUM_FFT_SIZE)) return false;
+    s_frames.resize(SPECTRUM_FFT_SIZE);
+    s_bands.resize(SPECTRUM_BANDS);
+    framePos = 0;
+    lastFrame = 0;
+
+    // Periodic Hann; a sine of amplitude A peaks at A * sum(w) / 2, so scale by 2 / sum(w)
+    const float twoPi = 6.28318530717958647692f;
+    float sum = 0.0f;
+    for (int i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+        window[i] = 0.5f - 0.5f * cosf(twoPi * i / SPECTRUM_FFT_SIZE);
+        sum += window[i];
+    }
+    for (int i = 0; i < SPECTRUM_FFT_SIZE; i++)
+        window[i] *= 2.0f / sum;
+
+    // Log-spaced band edges from SPECTRUM_MIN_HZ to Nyquist, at least one bin wide
+    const int lastBin = SPECTRUM_FFT_SIZE / 2;
+    binHz = sampleRate / (float)SPECTRUM_FFT_SIZE;
+    float ratio = (0.5f * sampleRate) / SPECTRUM_MIN_HZ;
+    for (int b = 0; b <= SPECTRUM_BANDS; b++) {
+        float hz = SPECTRUM_MIN_HZ * powf(ratio, (float)b / SPECTRUM_BANDS);
+        int bin = (int)(hz / binHz + 0.5f);
+        if (bin < 1) bin = 1;
+        if (b > 0 && bin <= bandStart[b - 1]) bin = bandStart[b - 1] + 1;
+        if (bin > lastBin - (SPECTRUM_BANDS - b)) bin = lastBin - (SPECTRUM_BANDS - b);
+        bandStart[b] = bin;
+    }
+    return true;
+}
+
+void SpectrumAnalyzer::setEnabled(bool on) {
+    enabled = on;
+}
+
+void SpectrumAnalyzer::capture(const float* left, const float* right, int n) {
+    if (!enabled) {
+        framePos = 0;
+        return;
+    }
+    float* dst = s_frames.writeBuffer();
+    for (int i = 0; i < n; i++) {
+        dst[framePos++] = 0.5f * (left[i] + right[i]);
+        if (framePos >= SPECTRUM_FFT_SIZE) {
+            s_frames.publish();
+            dst = s_frames.writeBuffer();
+            framePos = 0;
+        }
+    }
+}
+
+bool SpectrumAnalyzer::update() {
+    uint32_t seq;
+    if (!s_frames.read(frame, SPECTRUM_FFT_SIZE, &seq) || seq == lastFrame)
+        return false;
+    lastFrame = seq;
+
+    s_fft.setValues(frame, SPECTRUM_FFT_SIZE, window);
+    s_fft.fft();
+    s_fft.magnitudes(mags, SPECTRUM_FFT_SIZE / 2);
+
+    // Peak bin per band -> dB -> 0..1, bars fall at a fixed rate
+    float* out = s_bands.writeBuffer();
+    for (int b = 0; b < SPECTRUM_BANDS; b++) {
+        float peak = 0.0f;
+        for (int k = bandStart[b]; k < bandStart[b + 1]; k++)
+            if (mags[k] > peak) peak = mags[k];
+        float db = 20.0f * log10f(peak + 1.0e-9f);
+        float v = (db - SPECTRUM_FLOOR_DB) / -SPECTRUM_FLOOR_DB;
+        v = constrain(v, 0.0f, 1.0f);
+        float fall = bands[b] - SPECTRUM_FALL_PER_FRAME;
+        bands[b] = v > fall ? v : fall;
+        out[b] = bands[b];
+    }
+    s_bands.publish();
+    return true;
+}
+
+bool SpectrumAnalyzer::readBands(float* dst) {
+    return s_bands.read(dst, SPECTRUM_BANDS);
+}
+
+uint32_t SpectrumAnalyzer::getSequence() {
+    return s_bands.sequence();
+}
+
+float SpectrumAnalyzer::getBandFrequency(int band) const {
+    if (band < 0) band = 0;
+    if (band > SPECTRUM_BANDS) band = SPECTRUM_BANDS;
+    return bandStart[band] * binHz;
+}
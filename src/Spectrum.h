@@ -0,0 +1,59 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// =============================================================================
+// SPECTRUM ANALYZER
+// =============================================================================
+// The audio core only copies the mid signal into a lock-free double-buffered
+// frame (one publish every SPECTRUM_FFT_SIZE samples, and only while a view is
+// enabled). update() runs on the UI core: it takes the newest frame, loads it
+// windowed into the FFT in one call, computes all magnitudes in one pass and
+// publishes log-spaced bands to a second lock-free double buffer that the
+// display (and any other analysis) reads.
+// =============================================================================
+
+#define SPECTRUM_FFT_SIZE 512       // 16 ms at 32 kHz, 62.5 Hz bins
+#define SPECTRUM_BANDS 32           // Log-spaced bars, 4 px each on the OLED
+#define SPECTRUM_MIN_HZ 60.0f
+#define SPECTRUM_FLOOR_DB -60.0f    // Band value 0.0; 0 dBFS is 1.0
+#define SPECTRUM_FALL_PER_FRAME 0.04f  // Bar fall-off (peak ballistics)
+
+class SpectrumAnalyzer {
+public:
+    SpectrumAnalyzer();
+    /// Allocates the FFT and tables - call before the audio task starts
+    bool init(float sampleRate);
+
+    /// Capture only runs while enabled (e.g. while the spectrum view is shown)
+    void setEnabled(bool on);
+    bool isEnabled() const { return enabled; }
+
+    /// Audio core: append n samples of the output block. No FFT here.
+    void capture(const float* left, const float* right, int n);
+
+    /// UI core: run the FFT if a new frame was captured. Returns true if new bands were published.
+    bool update();
+
+    /// Any core: copy the latest SPECTRUM_BANDS values (0.0-1.0). False until the first update.
+    bool readBands(float* bands);
+    /// Number of published spectra; poll to detect new data
+    uint32_t getSequence();
+    /// Lower edge of a band in Hz (band == SPECTRUM_BANDS gives the top edge)
+    float getBandFrequency(int band) const;
+
+private:
+    volatile bool enabled;
+    int framePos;
+    uint32_t lastFrame;
+    float binHz;
+    uint16_t bandStart[SPECTRUM_BANDS + 1];     // First FFT bin of each band
+    float window[SPECTRUM_FFT_SIZE];            // Hann, scaled so a full-scale sine reads 1.0
+    float frame[SPECTRUM_FFT_SIZE];             // UI-side copy of the captured frame
+    float mags[SPECTRUM_FFT_SIZE / 2];
+    float bands[SPECTRUM_BANDS];                // Ballistics state
+};
+
+#endif
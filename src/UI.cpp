@@ -28,6 +28,8 @@ void SynthUI::draw(Mode currentMode) {
         case MODE_SEQUENCER: drawSequencerMode(); break;
         case MODE_SETTINGS:  drawSettingsMode(); break;
         case MODE_NOTE_EDITOR: drawNoteEditorMode(); break;
+        case MODE_SPECTRUM: drawSpectrumMode(); break;
+        default: break;
     }
     
     u8g2.sendBuffer();
@@ -118,6 +120,9 @@ void SynthUI::drawSequencerMode() {
     // Header
     u8g2.setFont(FONT_BODY);
     u8g2.drawStr(0, 10, "Sequencer");
+    if (sequencer.getRecordMode() != RECORD_OFF) {
+        u8g2.drawStr(60, 10, "REC");
+    }
     
     // BPM (Right Aligned)
     char buf[16];
@@ -204,8 +209,19 @@ void SynthUI::drawSettingsMode() {
             sprintf(val, "%s", instrumentNames[sequencer.getInstrument(sequencer.getCurrentTrack())]);
         } else if (itemIndex == MENU_BPM) {
             sprintf(val, "%d", sequencer.getBPM());
+        } else if (itemIndex == MENU_TAP_TEMPO) {
+            sprintf(val, "%d", sequencer.getBPM());
+        } else if (itemIndex == MENU_SYNC) {
+#ifdef SYNC_AUDIO_INPUT
+            BeatTracker& beat = audioEngine.getBeatTracker();
+            sprintf(val, "%s", !beat.isEnabled() ? "Off" : (beat.hasLock() ? "Lock" : "Wait"));
+#else
+            sprintf(val, "N/A");
+#endif
         } else if (itemIndex == MENU_PLAY_PAUSE) {
             sprintf(val, "%s", sequencer.isPlayingState() ? "Play" : "Stop");
+        } else if (itemIndex == MENU_RECORD) {
+            sprintf(val, "%s", recordModeNames[sequencer.getRecordMode()]);
         } else if (itemIndex == MENU_CLEAR_TRACK) {
             sprintf(val, "Trk%d", sequencer.getCurrentTrack()+1);
         } else if (itemIndex == MENU_VOLUME) {
@@ -258,6 +274,21 @@ void SynthUI::drawNoteEditorMode() {
         } else if (itemIndex == NOTE_MENU_FILTER) {
             int filterPct = (int)(audioEngine.getFilterCutoff() * 100.0f);
             sprintf(val, "%d%%", filterPct);
+        } else if (itemIndex == NOTE_MENU_DRIVE) {
+            int drivePct = (int)(audioEngine.getDrive() * 100.0f + 0.5f);
+            sprintf(val, "%d%%", drivePct);
+        } else if (itemIndex == NOTE_MENU_DRIVE_QUALITY) {
+            static const int factors[DRIVE_QUALITY_COUNT] = {1, 2, 4};
+            sprintf(val, "%dx", factors[audioEngine.getDriveQuality()]);
+        } else if (itemIndex == NOTE_MENU_ARP) {
+            sprintf(val, "%s", arpModeNames[audioEngine.getArpeggiator().getMode()]);
+        } else if (itemIndex == NOTE_MENU_ARP_RATE) {
+            sprintf(val, "%s", arpRateNames[audioEngine.getArpeggiator().getRate()]);
+        } else if (itemIndex == NOTE_MENU_ARP_GATE) {
+            int gatePct = (int)(audioEngine.getArpeggiator().getGate() * 100.0f + 0.5f);
+            sprintf(val, "%d%%", gatePct);
+        } else if (itemIndex == NOTE_MENU_CHORD) {
+            sprintf(val, "%s", chordTypeNames[audioEngine.getArpeggiator().getChord()]);
         }
         
         int w = u8g2.getStrWidth(val);
@@ -269,6 +300,35 @@ void SynthUI::drawNoteEditorMode() {
     }
 }
 
+void SynthUI::drawSpectrumMode() {
+    u8g2.setFont(FONT_BODY);
+    u8g2.drawStr(0, 10, "Spectrum");
+
+    // Instrument (Right Aligned)
+    u8g2.setFont(FONT_SMALL);
+    Instrument inst = sequencer.getInstrument(sequencer.getCurrentTrack());
+    int w = u8g2.getStrWidth(instrumentNames[inst]);
+    u8g2.drawStr(128 - w - 2, 10, instrumentNames[inst]);
+    u8g2.drawLine(0, 12, 128, 12);
+
+    // FFT runs here on the UI core; the audio core only hands over frames
+    SpectrumAnalyzer& spectrum = audioEngine.getSpectrum();
+    spectrum.update();
+
+    float bands[SPECTRUM_BANDS];
+    if (!spectrum.readBands(bands)) return;
+
+    // Bars: 32 x 3 px with 1 px gap, y = 15 (full) to 63 (floor)
+    int barW = 128 / SPECTRUM_BANDS;
+    int baseY = 63;
+    int maxH = baseY - 15;
+    for (int b = 0; b < SPECTRUM_BANDS; b++) {
+        int h = (int)(bands[b] * maxH + 0.5f);
+        if (h > 0)
+            u8g2.drawBox(b * barW, baseY - h + 1, barW - 1, h);
+    }
+}
+
 void SynthUI::drawPlayIndicator(bool playing) {
     if (playing) {
         // Triangle
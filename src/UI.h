@@ -39,6 +39,7 @@ private:
     void drawLaunchpadMode();
     void drawSettingsMode();
     void drawNoteEditorMode();
+    void drawSpectrumMode();
     void drawPlayIndicator(bool playing); // Issue #19
 };
 
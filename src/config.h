@@ -9,8 +9,11 @@
 #define I2S_DOUT       5
 #define I2S_NUM        I2S_NUM_0
 #define AUDIO_RATE     44100
-#define I2S_BUFFER_COUNT 8
-#define I2S_BUFFER_SIZE 256
+
+// --- Sync Input (optional I2S ADC, e.g. PCM1808, sharing BCLK/LRC) ---
+// #define SYNC_AUDIO_INPUT       // Beat tracker follows the line input
+#define I2S_DIN        14
+#define SYNC_LATENCY_MS 70        // Input + output buffering: sequencer fires this early
 
 // --- I2C Display ---
 #define I2C_SDA        48
@@ -34,14 +37,47 @@ const int LED_PINS[4] = {9, 10, 11, 12};
 
 // --- Audio Constants ---
 #define SAMPLE_RATE 44100
+#define ENGINE_SAMPLE_RATE 32000  // Rate the engine actually renders/outputs at
 #define POLYPHONY 8  // Configurable dynamic voice allocation could go here (Issue #40)
+#define SILENCE_THRESHOLD 1.0e-5f // Master peak below this counts as silent (under 1 LSB of 16-bit)
+#define SILENCE_HOLD_BLOCKS 4     // Silent blocks with no voices before the output goes idle
+#define RENDER_GROUPS 2           // Voice groups rendered in parallel (1 = audio core only)
+#define RENDER_HELPER_CORE 1      // Helper task shares the UI core...
+#define RENDER_HELPER_PRIORITY 20 // ...but preempts loop() (priority 1)
+// #define SYNTH_BENCHMARK        // Print render timings over Serial at boot
+// #define SYNTH_PROFILE          // Time the render path; Serial 'p' prints a report, 'r' resets it
+// #define SYNTH_BOUNCE           // Serial 'b' bounces the pattern to /bounce.wav in flash (LittleFS)
+#define BOUNCE_LOOPS 1            // Pattern passes per bounce
+#define BOUNCE_TAIL_MS 1000       // Release tail after the last pass
+// #define SYNTH_LATENCY          // Measure pad-to-sound latency; Serial 'l' prints a report, 'r' resets it
+
+// --- Output buffering ---
+// Pad-to-sound latency is mostly the output chain: the I2S DMA queue
+// (I2S_BUFFER_COUNT * I2S_BUFFER_SIZE frames), one Maximilian buffer and one
+// render block. The low-latency profile shortens all three (at more interrupts
+// and copy() calls per second) and fires pads on their first edge.
+// #define SYNTH_LOW_LATENCY      // ~10 ms instead of ~75 ms from the pad edge to the DAC
+#ifdef SYNTH_LOW_LATENCY
+#define I2S_BUFFER_COUNT 4
+#define I2S_BUFFER_SIZE 64        // Frames per DMA buffer (legacy driver)
+#define OUTPUT_BUFFER_SIZE 256    // Bytes per Maximilian copy(): 64 stereo 16-bit frames
+#define RENDER_BLOCK_SIZE 16      // Samples per render block (control-rate period)
+#define DEBOUNCE_EDGE_TRIGGERED   // Pads fire on the first edge, bounce after it is ignored
+#else
+#define I2S_BUFFER_COUNT 8
+#define I2S_BUFFER_SIZE 256       // Frames per DMA buffer (legacy driver)
+#define OUTPUT_BUFFER_SIZE 1024   // Bytes per Maximilian copy(): 256 stereo 16-bit frames
+#define RENDER_BLOCK_SIZE 32      // Samples per render block (control-rate period)
+#endif
 
 // --- Mode Definitions ---
 enum Mode {
   MODE_LAUNCHPAD,
   MODE_SEQUENCER,
   MODE_SETTINGS,
-  MODE_NOTE_EDITOR
+  MODE_NOTE_EDITOR,
+  MODE_SPECTRUM,      // Pads play like the launchpad, display shows the output spectrum
+  MODE_COUNT
 };
 
 // --- Instrument Types ---
@@ -66,7 +102,10 @@ static const char* instrumentNames[] = {
 enum SettingsMenuItem {
   MENU_INSTRUMENT,
   MENU_BPM,
+  MENU_TAP_TEMPO,
+  MENU_SYNC,
   MENU_PLAY_PAUSE,
+  MENU_RECORD,        // Live recording of sequencer-mode pads
   MENU_CLEAR_TRACK,
   MENU_VOLUME,
   MENU_BRIGHTNESS,
@@ -76,7 +115,10 @@ enum SettingsMenuItem {
 static const char* menuItemNames[] = {
   "Instrument",
   "BPM",
+  "Tap Tempo",
+  "Sync In",
   "Play/Pause",
+  "Record",
   "Clear Track",
   "Volume",
   "Brightness"
@@ -87,13 +129,25 @@ enum NoteEditorMenuItem {
   NOTE_MENU_SWING,
   NOTE_MENU_GATE,
   NOTE_MENU_FILTER,
+  NOTE_MENU_DRIVE,
+  NOTE_MENU_DRIVE_QUALITY,
+  NOTE_MENU_ARP,          // Launchpad pads through the arpeggiator...
+  NOTE_MENU_ARP_RATE,
+  NOTE_MENU_ARP_GATE,
+  NOTE_MENU_CHORD,        // ...and the chord stage
   NOTE_MENU_ITEM_COUNT
 };
 
 static const char* noteMenuItemNames[] = {
   "Swing",
   "Gate",
-  "Filter"
+  "Filter",
+  "Drive",
+  "Drive OS",
+  "Arp",
+  "Arp Rate",
+  "Arp Gate",
+  "Chord"
 };
 
 #endif
@@ -4,6 +4,10 @@
 #include "AudioEngine.h"
 #include "Sequencer.h"
 #include "UI.h"
+#ifdef SYNTH_BOUNCE
+#include <LittleFS.h>
+#include "Bounce.h"
+#endif
 
 // =============================================================================
 // AUDIO AT AUDIO RATE (AudioTools + Maximilian)
@@ -36,8 +40,9 @@ void handleInput() {
     
     // Mode Switching with cooldown
     if (hardware.isModeJustPressed() && (now - lastModePress >= FUNCTION_KEY_COOLDOWN_MS)) {
-        currentMode = (Mode)((currentMode + 1) % 4); // 4 modes now
+        currentMode = (Mode)((currentMode + 1) % MODE_COUNT);
         audioEngine.killAll();
+        audioEngine.getSpectrum().setEnabled(currentMode == MODE_SPECTRUM);
         // Force Display Update
         ui.draw(currentMode); // Immediate feedback (Issue #21/23)
         lastModePress = now;
@@ -46,7 +51,7 @@ void handleInput() {
     
     // Octave / Function with cooldown
     if (hardware.isOctaveJustPressed() && (now - lastOctavePress >= FUNCTION_KEY_COOLDOWN_MS)) {
-        if (currentMode == MODE_LAUNCHPAD) {
+        if (currentMode == MODE_LAUNCHPAD || currentMode == MODE_SPECTRUM) {
             int oct = sequencer.getCurrentOctave();
             oct = (oct + 1) % 7;
             if (oct == 0) oct = 2;
@@ -65,12 +70,28 @@ void handleInput() {
             if (hardware.isPadJustPressed(r, c)) {
                 int padIndex = r * 4 + c;
                 
-                if (currentMode == MODE_LAUNCHPAD) {
+                if (currentMode == MODE_LAUNCHPAD || currentMode == MODE_SPECTRUM) {
                     // Play Note
                     int note = 36 + padIndex + (sequencer.getCurrentOctave() * 12);
                     Instrument inst = sequencer.getInstrument(sequencer.getCurrentTrack());
-                    audioEngine.noteOn(note, inst);
+#ifdef SYNTH_LATENCY
+                    // Held pads retrigger every loop(); only the press is measured
+                    if (hardware.hasPadChanged(r, c))
+                        audioEngine.markInput(hardware.getPadEdgeUs(r, c));
+#endif
+                    if (!audioEngine.getArpeggiator().isEnabled())
+                        audioEngine.noteOn(note, inst);
+                    else if (hardware.hasPadChanged(r, c))
+                        audioEngine.keyOn(note, inst);  // Arpeggiator / chord stage: press only
                     
+                } else if (currentMode == MODE_SEQUENCER && sequencer.getRecordMode() != RECORD_OFF) {
+                    // Record: pads play the track's instrument, presses go into the pattern
+                    if (hardware.hasPadChanged(r, c)) {
+                        int note = 36 + padIndex + (sequencer.getCurrentOctave() * 12);
+                        audioEngine.noteOn(note, sequencer.getInstrument(sequencer.getCurrentTrack()));
+                        sequencer.recordNote(note, hardware.getPadEdgeUs(r, c));
+                    }
+
                 } else if (currentMode == MODE_SEQUENCER) {
                     // Toggle Step with debouncing
                     static uint32_t lastSequencerAction = 0;
@@ -119,8 +140,17 @@ void handleInput() {
                              int b = sequencer.getBPM();
                              b += 20; if (b > 180) b = 60;
                              sequencer.setBPM(b);
+                        } else if (item == MENU_TAP_TEMPO) {
+                             sequencer.tapTempo();
+                        } else if (item == MENU_SYNC) {
+#ifdef SYNC_AUDIO_INPUT
+                             BeatTracker& beat = audioEngine.getBeatTracker();
+                             beat.setEnabled(!beat.isEnabled());
+#endif
                         } else if (item == MENU_PLAY_PAUSE) {
                              sequencer.togglePlay();
+                        } else if (item == MENU_RECORD) {
+                             sequencer.setRecordMode((RecordMode)((sequencer.getRecordMode() + 1) % RECORD_MODE_COUNT));
                         } else if (item == MENU_CLEAR_TRACK) {
                              sequencer.clearTrack(sequencer.getCurrentTrack());
                              ui.menuCursor = 0;
@@ -207,6 +237,37 @@ void handleInput() {
                             else if (f < 0.9f) f = 1.0f;
                             else f = 0.25f;
                             audioEngine.setFilterCutoff(f);
+                        } else if (item == NOTE_MENU_DRIVE) {
+                            // Cycle through preset values: 0, 0.25, 0.5, 0.75, 1.0
+                            float d = audioEngine.getDrive();
+                            if (d < 0.1f) d = 0.25f;
+                            else if (d < 0.3f) d = 0.5f;
+                            else if (d < 0.6f) d = 0.75f;
+                            else if (d < 0.9f) d = 1.0f;
+                            else d = 0.0f;
+                            audioEngine.setDrive(d);
+                        } else if (item == NOTE_MENU_DRIVE_QUALITY) {
+                            // Cycle oversampling 1x -> 2x -> 4x
+                            DriveQuality q = audioEngine.getDriveQuality();
+                            audioEngine.setDriveQuality((DriveQuality)((q + 1) % DRIVE_QUALITY_COUNT));
+                        } else if (item == NOTE_MENU_ARP) {
+                            Arpeggiator& arp = audioEngine.getArpeggiator();
+                            arp.setMode((ArpMode)((arp.getMode() + 1) % ARP_MODE_COUNT));
+                        } else if (item == NOTE_MENU_ARP_RATE) {
+                            Arpeggiator& arp = audioEngine.getArpeggiator();
+                            arp.setRate((ArpRate)((arp.getRate() + 1) % ARP_RATE_COUNT));
+                        } else if (item == NOTE_MENU_ARP_GATE) {
+                            // Cycle through preset values: 0.25, 0.5, 0.75, 1.0
+                            Arpeggiator& arp = audioEngine.getArpeggiator();
+                            float g = arp.getGate();
+                            if (g < 0.3f) g = 0.5f;
+                            else if (g < 0.6f) g = 0.75f;
+                            else if (g < 0.9f) g = 1.0f;
+                            else g = 0.25f;
+                            arp.setGate(g);
+                        } else if (item == NOTE_MENU_CHORD) {
+                            Arpeggiator& arp = audioEngine.getArpeggiator();
+                            arp.setChord((ChordType)((arp.getChord() + 1) % CHORD_TYPE_COUNT));
                         }
                         lastNoteMenuAction = now;
                     }
@@ -217,11 +278,15 @@ void handleInput() {
                         if (ui.noteMenuCursor == NOTE_MENU_SWING) sequencer.setSwing(max(0, sequencer.getSwing() - 5));
                         else if (ui.noteMenuCursor == NOTE_MENU_GATE) sequencer.setGate(max(0.0f, sequencer.getGate() - 0.05f));
                         else if (ui.noteMenuCursor == NOTE_MENU_FILTER) audioEngine.setFilterCutoff(max(0.0f, audioEngine.getFilterCutoff() - 0.05f));
+                        else if (ui.noteMenuCursor == NOTE_MENU_DRIVE) audioEngine.setDrive(max(0.0f, audioEngine.getDrive() - 0.05f));
+                        else if (ui.noteMenuCursor == NOTE_MENU_ARP_GATE) audioEngine.getArpeggiator().setGate(audioEngine.getArpeggiator().getGate() - 0.05f);
                         lastNoteMenuAction = now;
                     } else if (padIndex == 4 && (now - lastNoteMenuAction >= NOTE_FINE_ADJUST_COOLDOWN_MS)) { // Increase
                         if (ui.noteMenuCursor == NOTE_MENU_SWING) sequencer.setSwing(min(100, sequencer.getSwing() + 5));
                         else if (ui.noteMenuCursor == NOTE_MENU_GATE) sequencer.setGate(min(1.0f, sequencer.getGate() + 0.05f));
                         else if (ui.noteMenuCursor == NOTE_MENU_FILTER) audioEngine.setFilterCutoff(min(1.0f, audioEngine.getFilterCutoff() + 0.05f));
+                        else if (ui.noteMenuCursor == NOTE_MENU_DRIVE) audioEngine.setDrive(min(1.0f, audioEngine.getDrive() + 0.05f));
+                        else if (ui.noteMenuCursor == NOTE_MENU_ARP_GATE) audioEngine.getArpeggiator().setGate(audioEngine.getArpeggiator().getGate() + 0.05f);
                         lastNoteMenuAction = now;
                     }
                 }
@@ -229,16 +294,45 @@ void handleInput() {
 
             // Check for Release
             if (hardware.isPadJustReleased(r, c)) {
-                if (currentMode == MODE_LAUNCHPAD) {
+                if (currentMode == MODE_SEQUENCER && sequencer.getRecordMode() != RECORD_OFF &&
+                    hardware.hasPadChanged(r, c)) {
+                    audioEngine.noteOff(36 + r * 4 + c + (sequencer.getCurrentOctave() * 12));
+                } else if (currentMode == MODE_LAUNCHPAD || currentMode == MODE_SPECTRUM) {
                     int padIndex = r * 4 + c;
                     int note = 36 + padIndex + (sequencer.getCurrentOctave() * 12);
-                    audioEngine.noteOff(note); // Stop note
+                    if (audioEngine.getArpeggiator().isEnabled())
+                        audioEngine.keyOff(note);
+                    else
+                        audioEngine.noteOff(note); // Stop note
                 }
             }
         }
     }
 }
 
+#ifdef SYNTH_BOUNCE
+// =============================================================================
+// OFFLINE BOUNCE - Runs on Core 1, the audio task outputs silence meanwhile
+// =============================================================================
+void bounceToFlash() {
+    if (!LittleFS.begin(true)) {
+        Serial.println("[Bounce] LittleFS mount FAILED");
+        return;
+    }
+    File file = LittleFS.open("/bounce.wav", "w");
+    if (!file) {
+        Serial.println("[Bounce] Cannot create /bounce.wav");
+        return;
+    }
+    BounceResult result;
+    bool ok = bouncePattern(audioEngine, sequencer, file, BOUNCE_LOOPS, BOUNCE_TAIL_MS, &result);
+    file.close();
+    Serial.printf("[Bounce] %s: %u frames, %u bytes in %u ms (%.1fx real time)\n",
+                  ok ? "OK" : "FAILED", result.frames, result.bytes,
+                  result.elapsedUs / 1000, result.speed);
+}
+#endif
+
 // =============================================================================
 // AUDIO TASK - Runs on Core 0 (dedicated audio core)
 // =============================================================================
@@ -269,6 +363,11 @@ void setup() {
     ui.init();
     audioEngine.init();
     sequencer.init();
+
+#ifdef SYNTH_BENCHMARK
+    // Worst-case patch: 4 Pad notes x 5 unison lanes must fit one block period
+    audioEngine.benchmark(Serial);
+#endif
     
     ui.draw(currentMode);
     
@@ -292,11 +391,17 @@ void setup() {
 void loop() {
     // Core 1: All UI, input, sequencer, LEDs
     handleInput();
+
+    // Every loop(): steps and micro-timed notes play on time
+    sequencer.update();
     
     static uint32_t lastBgTask = 0;
     uint32_t now = millis();
     if (now - lastBgTask >= 20) {  // 50 Hz
-        sequencer.update();
+        // Follow the sync input: new tempo/phase estimates arrive ~4x per second
+        BeatTracker& beat = audioEngine.getBeatTracker();
+        if (beat.update())
+            sequencer.syncToBeat(beat.getBPM(), beat.getNextBeatMs() - SYNC_LATENCY_MS);
         
         if (currentMode == MODE_SEQUENCER && sequencer.isPlayingState()) {
             hardware.setStepLEDs(sequencer.getCurrentStep());
@@ -307,6 +412,23 @@ void loop() {
         lastBgTask = now;
     }
     
+#if defined(SYNTH_PROFILE) || defined(SYNTH_BOUNCE) || defined(SYNTH_LATENCY)
+    while (Serial.available()) {
+        int c = Serial.read();
+#ifdef SYNTH_PROFILE
+        if (c == 'p') audioEngine.getProfiler().printReport(Serial);
+        else if (c == 'r') audioEngine.getProfiler().requestReset();
+#endif
+#ifdef SYNTH_LATENCY
+        if (c == 'l') audioEngine.getLatencyProbe().printReport(Serial);
+        else if (c == 'r') audioEngine.getLatencyProbe().requestReset();
+#endif
+#ifdef SYNTH_BOUNCE
+        if (c == 'b') bounceToFlash();
+#endif
+    }
+#endif
+
     // Display updates at 60 Hz (faster refresh)
     static uint32_t lastDisplay = 0;
     if (now - lastDisplay >= 16) {